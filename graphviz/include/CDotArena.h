@@ -0,0 +1,163 @@
+#ifndef CDotArena_H
+#define CDotArena_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace CDotParse {
+
+/*!
+ * Monotonic arena for parse objects (graphs, nodes, edges).
+ *
+ * Objects are placement constructed in large blocks and are never freed individually.
+ * Objects with non-trivial destructors are linked (newest first) so they are destroyed
+ * in reverse creation order when the arena is cleared, then all blocks are freed at once.
+ *
+ * A mark records the current position so objects created after it can be released
+ * together (stack order) while older objects stay valid.
+ */
+class Arena {
+ private:
+  struct Header;
+
+ public:
+  //! arena position (see mark() and release())
+  struct Mark {
+    size_t  numBlocks   { 0 };
+    char*   pos         { nullptr };
+    char*   end         { nullptr };
+    Header* destroyList { nullptr };
+  };
+
+ public:
+  Arena(size_t blockSize=64*1024) :
+   blockSize_(blockSize) {
+  }
+
+ ~Arena() { clear(); }
+
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  //! construct object in arena
+  template<typename T, typename... Args>
+  T *create(Args&&... args) {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "over aligned type");
+
+    if constexpr (std::is_trivially_destructible_v<T>) {
+      void *mem = allocate(sizeof(T));
+
+      return new (mem) T(std::forward<Args>(args)...);
+    }
+    else {
+      void *mem = allocate(headerSize() + sizeof(T));
+
+      auto *header = static_cast<Header *>(mem);
+      auto *obj    = new (static_cast<char *>(mem) + headerSize()) T(std::forward<Args>(args)...);
+
+      // only link once constructed (constructor may throw)
+      header->destroy = [](void *p) { static_cast<T *>(p)->~T(); };
+      header->obj     = obj;
+      header->next    = destroyList_;
+
+      destroyList_ = header;
+
+      return obj;
+    }
+  }
+
+  //! destroy all objects and free all blocks
+  void clear() {
+    for (auto *header = destroyList_; header; header = header->next)
+      header->destroy(header->obj);
+
+    destroyList_ = nullptr;
+
+    blocks_.clear();
+
+    pos_ = end_ = nullptr;
+  }
+
+  //! current position
+  Mark mark() const {
+    Mark mark;
+
+    mark.numBlocks   = blocks_.size();
+    mark.pos         = pos_;
+    mark.end         = end_;
+    mark.destroyList = destroyList_;
+
+    return mark;
+  }
+
+  //! destroy objects created since mark (newest first) and free blocks added since mark.
+  //! Marks taken after this mark are invalidated
+  void release(const Mark &mark) {
+    for (auto *header = destroyList_; header != mark.destroyList; header = header->next)
+      header->destroy(header->obj);
+
+    destroyList_ = mark.destroyList;
+
+    blocks_.resize(mark.numBlocks);
+
+    pos_ = mark.pos;
+    end_ = mark.end;
+  }
+
+  //! number of allocated blocks
+  size_t numBlocks() const { return blocks_.size(); }
+
+ private:
+  struct Header {
+    Header* next    { nullptr };
+    void  (*destroy)(void *) { nullptr };
+    void*   obj     { nullptr };
+  };
+
+  static constexpr size_t align(size_t n) {
+    constexpr size_t a = alignof(std::max_align_t);
+
+    return (n + a - 1) & ~(a - 1);
+  }
+
+  static constexpr size_t headerSize() { return align(sizeof(Header)); }
+
+  void *allocate(size_t n) {
+    n = align(n);
+
+    if (size_t(end_ - pos_) < n) {
+      // oversized objects get their own block
+      size_t size = std::max(n, blockSize_);
+
+      blocks_.emplace_back(new char [size]);
+
+      pos_ = blocks_.back().get();
+      end_ = pos_ + size;
+    }
+
+    void *mem = pos_;
+
+    pos_ += n;
+
+    return mem;
+  }
+
+ private:
+  using Block  = std::unique_ptr<char []>;
+  using Blocks = std::vector<Block>;
+
+  size_t  blockSize_   { 0 };
+  Blocks  blocks_;
+  char*   pos_         { nullptr };
+  char*   end_         { nullptr };
+  Header* destroyList_ { nullptr };
+};
+
+}
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef CDotCSRGraph_H
+#define CDotCSRGraph_H
+
+#include <CDotParse.h>
+
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+namespace CDotParse {
+
+/*!
+ * Immutable compressed sparse row (CSR) snapshot of a graph's adjacency (see Graph::freeze).
+ *
+ * Nodes are given dense indices: the graph's own nodes (in name order) followed by any
+ * nodes in other graphs reachable through out edges. Edges are numbered grouped by from
+ * node (in node edge order) so the out edges of node n are the edge index range
+ * [outBegin(n), outEnd(n)). In edges are stored as edge indices grouped by to node.
+ *
+ * The snapshot does not track later changes to the graph.
+ */
+class CSRGraph {
+ public:
+  using Index   = uint32_t;
+  using Id      = StringTable::Id;
+  using Indices = std::vector<Index>;
+  using Ids     = std::vector<Id>;
+
+  static constexpr Index NO_INDEX = Index(-1);
+
+ public:
+  CSRGraph() { }
+
+  explicit CSRGraph(const Graph *graph);
+
+  const Graph *graph() const { return graph_; }
+
+  //! number of nodes (own and reachable)
+  Index numNodes() const { return Index(nodes_.size()); }
+
+  //! number of nodes owned by graph (first indices)
+  Index numGraphNodes() const { return numGraphNodes_; }
+
+  Index numEdges() const { return Index(edges_.size()); }
+
+  //! number of out edges of graph's own nodes (first edge indices)
+  Index numGraphEdges() const { return (! outOffsets_.empty() ? outOffsets_[numGraphNodes_] : 0); }
+
+  Node *node(Index n) const { return nodes_[n]; }
+  Edge *edge(Index e) const { return edges_[e]; }
+
+  //! get index of node (NO_INDEX if not in snapshot)
+  Index nodeIndex(const Node *node) const;
+
+  //--- edge columns
+
+  Index edgeFrom(Index e) const { return edgeFrom_[e]; }
+  Index edgeTo  (Index e) const { return edgeTo_  [e]; }
+
+  double edgeCost(Index e) const { return edgeCost_[e]; }
+
+  //--- adjacency
+
+  Index outBegin (Index n) const { return outOffsets_[n]; }
+  Index outEnd   (Index n) const { return outOffsets_[n + 1]; }
+  Index outDegree(Index n) const { return outEnd(n) - outBegin(n); }
+
+  const Index *inBegin (Index n) const { return inEdges_.data() + inOffsets_[n]; }
+  const Index *inEnd   (Index n) const { return inEdges_.data() + inOffsets_[n + 1]; }
+  Index        inDegree(Index n) const { return inOffsets_[n + 1] - inOffsets_[n]; }
+
+  //--- algorithms
+
+  //! connected component (edge direction ignored) of each node, components are numbered
+  //! in order of their first node
+  Indices connectedComponents(Index &numComponents) const;
+
+  //--- attribute columns
+
+  //! get value id of named attribute for each node/edge (0 if not set)
+  Ids nodeAttributeIds(std::string_view name) const;
+  Ids edgeAttributeIds(std::string_view name) const;
+
+ private:
+  using Nodes     = std::vector<Node *>;
+  using Edges     = std::vector<Edge *>;
+  using Costs     = std::vector<double>;
+  using NodeIndex = std::unordered_map<const Node *, Index>;
+
+  const Graph* graph_         { nullptr };
+  Index        numGraphNodes_ { 0 };
+  Nodes        nodes_;
+  NodeIndex    nodeIndex_;
+  Edges        edges_;
+  Indices      edgeFrom_;
+  Indices      edgeTo_;
+  Costs        edgeCost_;
+  Indices      outOffsets_;
+  Indices      inOffsets_;
+  Indices      inEdges_;
+};
+
+}
+
+#endif
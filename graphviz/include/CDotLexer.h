@@ -0,0 +1,109 @@
+#ifndef CDotLexer_H
+#define CDotLexer_H
+
+#include <string>
+#include <string_view>
+
+namespace CDotParse {
+
+/*!
+ * Tokenizer for dot files.
+ *
+ * The file is memory mapped (or read into a single buffer if it can't be mapped)
+ * and tokens are returned as views into that data so no per token copies are made.
+ * Views remain valid for the lifetime of the lexer.
+ */
+class Lexer {
+ public:
+  enum class TokenType {
+    NONE,
+    IDENTIFIER,      // alpha/underscore + alnum/underscore
+    NUMBER,          // [-][digits][.digits]
+    STRING,          // "..." or '...' (view excludes quotes)
+    HTML,            // <...> (view includes angle brackets)
+    OPEN_BRACE,      // {
+    CLOSE_BRACE,     // }
+    OPEN_BRACKET,    // [
+    CLOSE_BRACKET,   // ]
+    EQUALS,          // =
+    SEMI_COLON,      // ;
+    COMMA,           // ,
+    COLON,           // :
+    DIRECTED_EDGE,   // ->
+    UNDIRECTED_EDGE, // --
+    INVALID,         // unexpected character
+    END              // end of file
+  };
+
+  struct Token {
+    TokenType        type { TokenType::NONE };
+    std::string_view str;
+    size_t           pos  { 0 };
+
+    bool isType(TokenType t) const { return type == t; }
+
+    bool isEdgeOp() const {
+      return (type == TokenType::DIRECTED_EDGE || type == TokenType::UNDIRECTED_EDGE);
+    }
+
+    bool isID() const {
+      return (type == TokenType::IDENTIFIER || type == TokenType::NUMBER ||
+              type == TokenType::STRING     || type == TokenType::HTML);
+    }
+  };
+
+ public:
+  Lexer(const std::string &filename);
+
+ ~Lexer();
+
+  Lexer(const Lexer &) = delete;
+  Lexer &operator=(const Lexer &) = delete;
+
+  //! get filename
+  const std::string &fileName() const { return fileName_; }
+
+  //! is file data loaded
+  bool isValid() const { return data_ != nullptr; }
+
+  //! is file data memory mapped (not copied into buffer)
+  bool isMapped() const { return mapped_; }
+
+  //! current (look ahead) token
+  const Token &token() const { return token_; }
+
+  bool isToken(TokenType type) const { return token_.type == type; }
+
+  bool isEOF() const { return token_.type == TokenType::END; }
+
+  //! advance to next token
+  void nextToken();
+
+  //! get line/char number of data offset (for error messages)
+  void position(size_t pos, int &lineNum, int &charNum) const;
+
+ private:
+  void load();
+
+  void skipSpace();
+
+  void readToken(Token &token);
+
+  bool isIdentifierStart(char c) const;
+  bool isIdentifierChar (char c) const;
+
+  bool isDigit(size_t pos) const;
+
+ private:
+  std::string fileName_;
+  const char* data_   { nullptr };
+  size_t      len_    { 0 };
+  size_t      pos_    { 0 };
+  bool        mapped_ { false };
+  std::string buffer_;
+  Token       token_;
+};
+
+}
+
+#endif
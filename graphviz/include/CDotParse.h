@@ -1,23 +1,165 @@
 #ifndef CDotParse_H
 #define CDotParse_H
 
-#include <CFileParse.h>
+#include <CDotArena.h>
+#include <CDotLexer.h>
 
 #include <map>
 #include <set>
+#include <deque>
+#include <unordered_map>
 #include <vector>
 #include <iostream>
 #include <memory>
+#include <string_view>
+#include <cstdint>
 
 namespace CDotParse {
 
 class Graph;
 class Node;
 class Edge;
+class CSRGraph;
 
-using GraphP = std::shared_ptr<Graph>;
-using NodeP  = std::shared_ptr<Node>;
-using EdgeP  = std::shared_ptr<Edge>;
+// graphs, nodes and edges are owned by the parse arena (valid for lifetime of parse)
+using GraphP = Graph *;
+using NodeP  = Node *;
+using EdgeP  = Edge *;
+
+//---
+
+// interned strings (node names, attribute names/values) shared by all objects of a parse
+class StringTable {
+ public:
+  using Id = uint32_t;
+
+ public:
+  StringTable() { (void) intern(""); }
+
+  StringTable(const StringTable &) = delete;
+  StringTable &operator=(const StringTable &) = delete;
+
+  //! get id of string (added if new)
+  Id intern(std::string_view str);
+
+  //! get pooled copy of string (added if new)
+  const std::string &internStr(std::string_view str) { return this->str(intern(str)); }
+
+  //! get id of existing string
+  bool find(std::string_view str, Id &id) const;
+
+  //! get string for id
+  const std::string &str(Id id) const { return strings_[id]; }
+
+  size_t size() const { return strings_.size(); }
+
+ private:
+  using Strings = std::deque<std::string>;                 // stable element addresses
+  using Ids     = std::unordered_map<std::string_view, Id>; // keys view strings_
+
+  Strings strings_;
+  Ids     ids_;
+};
+
+//---
+
+namespace Util {
+  double stringToReal(const std::string &s, bool &ok);
+
+  std::vector<double> stringToReals(const std::string &s, bool &ok);
+}
+
+//---
+
+// attribute name/values stored as interned ids in a small array sorted by name id.
+// Values not set locally are looked up in the (optional) parent attributes (defaults)
+class Attributes {
+ public:
+  using Id             = StringTable::Id;
+  using NameValue      = std::pair<std::string_view, std::string_view>;
+  using NameValueArray = std::vector<NameValue>;
+
+ public:
+  Attributes(StringTable *strings, const Attributes *parent=nullptr) :
+   strings_(strings), parent_(parent) {
+  }
+
+  const Attributes *parent() const { return parent_; }
+  void setParent(const Attributes *parent) { parent_ = parent; }
+
+  //! no local or inherited values
+  bool empty() const { return nameValues_.empty() && (! parent_ || parent_->empty()); }
+
+  //! local and inherited values sorted by name
+  NameValueArray nameValues() const;
+
+  void setNameValue(std::string_view name, std::string_view value);
+
+  double getReal(std::string_view name, bool &ok) const {
+    auto s = getString(name, ok);
+    if (! ok) return 0.0;
+
+    return Util::stringToReal(s, ok);
+  }
+
+  std::vector<double> getReals(std::string_view name, bool &ok) const {
+    auto s = getString(name, ok);
+    if (! ok) return std::vector<double>();
+
+    return Util::stringToReals(stripQuotes(s), ok);
+  }
+
+  std::string getString(std::string_view name, bool &ok) const {
+    Id id;
+    ok = getValueId(name, id);
+    return (ok ? strings_->str(id) : std::string());
+  }
+
+  //! get pooled value string (empty if not set)
+  const std::string &getStringRef(std::string_view name) const {
+    Id id;
+    return strings_->str(getValueId(name, id) ? id : 0);
+  }
+
+  bool getValueId(std::string_view name, Id &id) const {
+    Id nameId;
+    if (! strings_->find(name, nameId)) return false;
+    return findValue(nameId, id);
+  }
+
+  //! get value id for interned name id
+  bool getValueId(Id nameId, Id &id) const { return findValue(nameId, id); }
+
+  std::string stripQuotes(const std::string &s) const {
+    int len = s.size();
+    if (len > 1 && s[0] == '"' && s[len - 1] == '"')
+      return s.substr(1, len - 2);
+    return s;
+  }
+
+  void print(std::ostream &os) const {
+    for (const auto &nv: nameValues()) {
+      os << nv.first << "=" << nv.second << "\n";
+    }
+  }
+
+ private:
+  bool findValue(Id name, Id &value) const;
+
+ private:
+  struct IdValue {
+    Id name  { 0 };
+    Id value { 0 };
+  };
+
+  using IdValues = std::vector<IdValue>;
+
+  StringTable*      strings_ { nullptr };
+  const Attributes* parent_  { nullptr };
+  IdValues          nameValues_;
+};
+
+//---
 
 class Parse {
  public:
@@ -40,144 +182,123 @@ class Parse {
   bool parseGraph();
   bool parseStatementList();
   bool parseStatement();
-  bool parseAttrList(const std::string &id);
-  bool parseAList(const std::string &id);
-  bool parseID(std::string &id);
-  bool parseIdentifier(std::string &id);
+  bool parseAttrList(std::string_view id);
+  bool parseAList(std::string_view id);
+  bool parseID(std::string_view &id);
+  bool parseIdentifier(std::string_view &id);
 
-  void skipSpace();
+  bool isToken(Lexer::TokenType type) const { return lexer_->isToken(type); }
+  void skipToken() { lexer_->nextToken(); }
 
-  void enter(const std::string &proc) const;
-  void leave(const std::string &proc) const;
+  void enter(const char *proc, std::string_view arg) const;
+  void leave(const char *proc, std::string_view arg) const;
 
   void depthSpaces() const;
 
   bool errorMsg(const std::string &msg) const;
 
  public:
-  using GraphMap = std::map<std::string, GraphP>;
+  using GraphMap = std::map<std::string, GraphP, std::less<>>;
 
  public:
   const GraphMap &graphs() const { return graphs_; }
 
-  Graph *getGraph(const std::string &name);
+  Graph *getGraph(std::string_view name);
 
-  NodeP getNode(const std::string &name);
+  NodeP getNode(std::string_view name);
 
   Graph *currentGraph() const;
 
+  StringTable &strings() { return strings_; }
+  const StringTable &strings() const { return strings_; }
+
+  //! position in parse arena. Graphs derived after a mark (e.g. from minimumSpaningTree
+  //! or subGraphs) can be released with releaseArena() when they are no longer used
+  Arena::Mark arenaMark() const { return arena_.mark(); }
+
+  //! destroy graphs, nodes and edges created since mark (must not be referenced by
+  //! parsed graphs, so don't parse between arenaMark() and releaseArena())
+  void releaseArena(const Arena::Mark &mark) const { arena_.release(mark); }
+
+  //! builtin node/edge attributes (parent of top level graph defaults)
+  const Attributes &nodeDefaults() const { return nodeDefaults_; }
+  const Attributes &edgeDefaults() const { return edgeDefaults_; }
+
  protected:
   friend class Graph;
   friend class Node;
 
   Node *makeCurrentNode(const std::string &name) const;
 
+  void addNodeIndex(NodeP node);
+
+  // factories must allocate objects using create() (owned by parse arena)
   virtual Graph *makeGraph(const std::string &name) const;
   virtual Node  *makeNode (Graph *graph, const std::string &name) const;
   virtual Edge  *makeEdge (Node *node1, Node *node2) const;
 
+  //! construct object in parse arena
+  template<typename T, typename... Args>
+  T *create(Args&&... args) const { return arena_.create<T>(std::forward<Args>(args)...); }
+
  protected:
   class EnterLeave {
    public:
-    EnterLeave(const Parse *parse, const std::string &proc) :
-     parse_(parse), proc_(proc) {
-      parse_->enter(proc_);
+    EnterLeave(const Parse *parse, const char *proc, std::string_view arg="") :
+     parse_(parse), proc_(proc), arg_(arg) {
+      parse_->enter(proc_, arg_);
     }
 
    ~EnterLeave() {
-      parse_->leave(proc_);
+      parse_->leave(proc_, arg_);
     }
 
    private:
-    const Parse* parse_ {nullptr };
-    std::string  proc_;
+    const Parse*     parse_ { nullptr };
+    const char*      proc_  { nullptr };
+    std::string_view arg_;
   };
 
  private:
-  using ParseP = std::unique_ptr<CFileParse>;
-
-  ParseP      parse_;
-  mutable int depth_        { 0 };
-  GraphMap    graphs_;
-  Graph*      currentGraph_ { nullptr };
-  Node*       currentNode_  { nullptr };
-  Edge*       currentEdge_  { nullptr };
-  bool        debug_        { false };
-  bool        print_        { false };
-  bool        csv_          { false };
-};
-
-//---
-
-namespace Util {
-  double stringToReal(const std::string &s, bool &ok);
-
-  std::vector<double> stringToReals(const std::string &s, bool &ok);
-}
-
-//---
-
-class Attributes {
- public:
-  Attributes() { }
-
-  bool empty() const { return nameValues_.empty(); }
-  auto begin() const { return nameValues_.begin(); }
-  auto end  () const { return nameValues_.end  (); }
-
-  void setNameValue(const std::string &name, const std::string &value) {
-    nameValues_[name] = value;
-  }
-
-  double getReal(const std::string &name, bool &ok) const {
-    auto s = getString(name, ok);
-    if (! ok) return 0.0;
-
-    return Util::stringToReal(s, ok);
-  }
-
-  std::vector<double> getReals(const std::string &name, bool &ok) const {
-    auto s = getString(name, ok);
-    if (! ok) return std::vector<double>();
-
-    return Util::stringToReals(stripQuotes(s), ok);
-  }
-
-  std::string getString(const std::string &name, bool &ok) const {
-    ok = true;
-    auto p = nameValues_.find(name);
-    if (p == nameValues_.end()) { ok = false; return ""; }
-    return (*p).second;
-  }
-
-  std::string stripQuotes(const std::string &s) const {
-    int len = s.size();
-    if (len > 1 && s[0] == '"' && s[len - 1] == '"')
-      return s.substr(1, len - 2);
-    return s;
-  }
-
-  void print(std::ostream &os) const {
-    for (const auto &nv: nameValues_) {
-      os << nv.first << "=" << nv.second << "\n";
-    }
-  }
-
- private:
-  using NameValues = std::map<std::string, std::string>;
-
-  NameValues nameValues_;
+  using LexerP    = std::unique_ptr<Lexer>;
+  using NodeIndex = std::unordered_map<std::string_view, NodeP>;
+
+  StringTable   strings_;
+  Attributes    nodeDefaults_;
+  Attributes    edgeDefaults_;
+  mutable Arena arena_;       // owns all graphs, nodes and edges
+  LexerP        lexer_;
+  mutable int   depth_        { 0 };
+  GraphMap      graphs_;
+  NodeIndex     nodeIndex_;    // all nodes by name (key views node's name)
+  Graph*        currentGraph_ { nullptr };
+  Node*         currentNode_  { nullptr };
+  Edge*         currentEdge_  { nullptr };
+  bool          debug_        { false };
+  bool          print_        { false };
+  bool          csv_          { false };
 };
 
 //---
 
 class Graph {
  public:
-  using NodeMap   = std::map<std::string, NodeP>;
-  using EdgeSet   = std::set<EdgeP>;
+  using NodeMap   = std::map<std::string_view, NodeP, std::less<>>; // key views node name
+  using Edges     = std::vector<EdgeP>;
   using NodeArray = std::vector<Node *>;
   using Graphs    = std::vector<GraphP>;
 
+  enum class PathType {
+    HOPS,     // unit edge costs
+    DIJKSTRA, // edge costs
+    ASTAR     // edge costs + node position (pos) distance estimate
+  };
+
+  enum class MSTType {
+    KRUSKAL, // sorted edges + union find
+    PRIM     // heap of frontier edges (better for dense graphs)
+  };
+
  public:
   Graph(Parse *parse, const std::string &name);
 
@@ -192,7 +313,7 @@ class Graph {
   void setName(const std::string &name) { name_ = name; }
 
   const NodeMap &nodes() const { return nodes_; }
-  const EdgeSet &edges() const { return edges_; }
+  const Edges   &edges() const { return edges_; }
 
   std::string hierName() const {
     if (parent_)
@@ -203,7 +324,7 @@ class Graph {
 
   //---
 
-  NodeP getNode(const std::string &name, bool create=false);
+  NodeP getNode(std::string_view name, bool create=false);
 
   NodeP addNode(const std::string &name);
   void  addNode(NodeP node);
@@ -216,13 +337,18 @@ class Graph {
   //---
 
   const Attributes &attributes() const { return attributes_; }
-  void setAttribute(const std::string &name, const std::string &value);
+  void setAttribute(std::string_view name, std::string_view value);
 
-  const Attributes &nodeAttributes() const { return nodeAttributes_; }
-  void setNodeAttribute(const std::string &name, const std::string &value);
+  const Attributes &nodeAttributes() const { return *nodeAttributes_.attributes; }
+  void setNodeAttribute(std::string_view name, std::string_view value);
 
-  const Attributes &edgeAttributes() const { return edgeAttributes_; }
-  void setEdgeAttribute(const std::string &name, const std::string &value);
+  const Attributes &edgeAttributes() const { return *edgeAttributes_.attributes; }
+  void setEdgeAttribute(std::string_view name, std::string_view value);
+
+  //! get current node/edge defaults to use as parent of new object attributes
+  //! (marked as shared so later default changes are made to a new copy)
+  const Attributes *shareNodeAttributes() const;
+  const Attributes *shareEdgeAttributes() const;
 
   //---
 
@@ -242,33 +368,71 @@ class Graph {
 
   //---
 
-  GraphP minimumSpaningTree() const;
+  //! build immutable CSR adjacency snapshot (used by graph algorithms)
+  CSRGraph freeze() const;
+
+  //---
+
+  // graph algorithms. Each builds a snapshot with freeze() per call, the overloads taking
+  // a snapshot (of this graph, see freeze()) let callers reuse one for repeated queries
+
+  // derived graphs (minimumSpaningTree, subGraphs) are allocated in the parse arena and
+  // live until the parse is destroyed. Callers computing them repeatedly should take a
+  // Parse::arenaMark() before and call Parse::releaseArena() when done with the result
+
+  //! minimum spanning tree (forest) of graph's edges (treated as undirected)
+  GraphP minimumSpaningTree(MSTType type=MSTType::KRUSKAL) const;
+  GraphP minimumSpaningTree(const CSRGraph &csr, MSTType type=MSTType::KRUSKAL) const;
 
   bool isCycle(Node *node) const;
-  bool isCycle(Node *start_node, Node *node) const;
+  bool isCycle(const CSRGraph &csr, Node *node) const;
 
   void resetNodeVisited() const;
   void resetEdgeVisited() const;
 
-  NodeArray shortestPath(NodeP fromNode, NodeP toNode) const;
+  //! shortest path along out edges. Edge cost is Edge::cost() or the value of the named
+  //! numeric edge attribute (e.g. weight, len) when costName is set
+  NodeArray shortestPath(NodeP fromNode, NodeP toNode, PathType type=PathType::HOPS,
+                         const std::string &costName="") const;
+  NodeArray shortestPath(const CSRGraph &csr, NodeP fromNode, NodeP toNode,
+                         PathType type=PathType::HOPS, const std::string &costName="") const;
 
+  //! copy of graph's edges per connected component
   Graphs subGraphs() const;
+  Graphs subGraphs(const CSRGraph &csr) const;
 
  private:
-  void addNodeToSubGraph(Node *startNode, GraphP graph) const;
+  using Visited = std::vector<bool>;
+  using Indices = std::vector<uint32_t>;
+
+  bool nodePositions(const CSRGraph &csr, std::vector<double> &x, std::vector<double> &y) const;
+
+  Indices kruskalEdges(const CSRGraph &csr) const;
+  Indices primEdges   (const CSRGraph &csr) const;
 
  private:
-  using SubGraphs = std::set<Graph *>;
-
-  Parse*      parse_  { nullptr };
-  Graph*      parent_ { nullptr };
-  std::string name_;
-  NodeMap     nodes_;
-  EdgeSet     edges_;
-  Attributes  attributes_;
-  Attributes  nodeAttributes_;
-  Attributes  edgeAttributes_;
-  SubGraphs   graphs_;
+  // current node/edge defaults (older generations are kept for objects which reference them)
+  struct DefaultAttributes {
+    Attributes*  attributes { nullptr };
+    mutable bool shared     { false };
+  };
+
+  using SubGraphs      = std::set<Graph *>;
+  using AttributesList = std::deque<Attributes>;
+
+  void setDefaultAttribute(DefaultAttributes &defaults, std::string_view name,
+                           std::string_view value);
+
+  Parse*            parse_  { nullptr };
+  Graph*            parent_ { nullptr };
+  std::string       name_;
+  NodeMap           nodes_;
+  Edges             edges_;
+  Attributes        attributes_;
+  AttributesList    attributesList_;
+  DefaultAttributes nodeAttributes_;
+  DefaultAttributes edgeAttributes_;
+  SubGraphs         graphs_;
 };
 
 //---
@@ -284,18 +448,18 @@ class Node {
 
   const Graph *graph() const { return graph_; }
 
-  const std::string &name() const { return name_; }
+  const std::string &name() const { return strings().str(name_); }
 
   const Edges &edges() const { return edges_; }
 
   const Attributes &attributes() const { return attributes_; }
-  void setAttribute(const std::string &name, const std::string &value);
+  void setAttribute(std::string_view name, std::string_view value);
 
-  const std::string &color() const { return color_; }
-  void setColor(const std::string &s) { color_ = s; }
+  const std::string &color() const { return attributes_.getStringRef("color"); }
+  void setColor(std::string_view s) { setAttribute("color", s); }
 
-  const std::string &label() const { return label_; }
-  void setLabel(const std::string &s) { label_ = s; }
+  const std::string &label() const { return attributes_.getStringRef("label"); }
+  void setLabel(std::string_view s) { setAttribute("label", s); }
 
   EdgeP addNodeEdge(Node *node);
 
@@ -317,13 +481,16 @@ class Node {
   void setVisited(bool visited) { visited_ = visited; }
 
  private:
-  Graph*      graph_   { nullptr };
-  std::string name_;
-  std::string label_;
-  Edges       edges_;
-  Attributes  attributes_;
-  std::string color_;
-  bool        visited_ { false };
+  StringTable &strings() const { return graph_->parse()->strings(); }
+
+ private:
+  using Id = StringTable::Id;
+
+  Graph*     graph_   { nullptr };
+  Id         name_    { 0 };
+  Edges      edges_;
+  Attributes attributes_;
+  bool       visited_ { false };
 };
 
 //---
@@ -346,7 +513,7 @@ class Edge {
   void setDirected(bool b) { directed_ = b; }
 
   const Attributes &attributes() const { return attributes_; }
-  void setAttribute(const std::string &name, const std::string &value);
+  void setAttribute(std::string_view name, std::string_view value);
 
   double cost() const { return cost_; }
   void setCost(double r) { cost_ = r; }
@@ -1,9 +1,12 @@
 #ifndef CASTAR_NODE_H
 #define CASTAR_NODE_H
 
+#include <algorithm>
+#include <deque>
 #include <list>
-#include <map>
-#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <cassert>
 #include <iostream>
@@ -11,15 +14,26 @@
 template<typename NODE>
 class CAStar {
  public:
+  enum class State {
+    NONE,
+    OPEN,
+    CLOSED
+  };
+
   struct NodeData {
+    NODE*  node                { nullptr };
     NODE*  parent              { nullptr };
     double costFromStart       { 0.0 };
     double estimatedCostToGoal { 0.0 };
     double totalCost           { 0.0 };
+    State  state               { State::NONE };
+    size_t heapPos             { 0 };
   };
 
  public:
-  using NodeList = std::list<NODE *>;
+  using NodeList     = std::list<NODE *>;
+  using NodeCost     = std::pair<NODE *, double>;
+  using NodeCostList = std::vector<NodeCost>;
 
  public:
   CAStar() { }
@@ -39,6 +53,12 @@ class CAStar {
 
   virtual NodeList getNextNodes(NODE *node) const;
 
+  // successor nodes and traverse costs (default uses getNextNodes and traverseCost)
+  virtual void getNextNodeCosts(NODE *node, NodeCostList &nodeCosts);
+
+  // optional dense node index (>= 0) to store node data in array instead of hash map
+  virtual int nodeIndex(NODE *) const { return -1; }
+
   //------
 
   bool isOpenNode(NODE *node) const;
@@ -53,14 +73,37 @@ class CAStar {
  protected:
   NodeData &getNodeData(NODE *node) const;
 
+  const NodeData *findNodeData(NODE *node) const;
+
+  void clearNodeData();
+
+  //--- open node heap (d-ary min heap on total cost with position in node data)
+
+  void pushOpenNode  (NodeData &data);
+  void updateOpenNode(NodeData &data); // decrease key
+  void removeOpenNode(NodeData &data);
+
+  void siftUp  (size_t pos);
+  void siftDown(size_t pos);
+
+  void setHeapEntry(size_t pos, NodeData *data) {
+    openHeap_[pos] = data;
+
+    data->heapPos = pos;
+  }
+
  protected:
-  using NodeSet     = std::set<NODE *>;
-  using NodeDataMap = std::map<NODE *, NodeData>;
+  static constexpr size_t HEAP_ARITY = 4;
 
-  NodeSet openNodes_;   // open nodes
-  NodeSet closedNodes_; // closed nodes
+  using OpenHeap      = std::vector<NodeData *>;
+  using NodeDataMap   = std::unordered_map<NODE *, NodeData>; // stable element addresses
+  using NodeDataArray = std::deque<NodeData>;                 // stable element addresses
 
-  mutable NodeDataMap nodeDataMap_;
+  OpenHeap     openHeap_;  // open nodes
+  NodeCostList nextNodes_; // successor nodes buffer (reused)
+
+  mutable NodeDataMap   nodeDataMap_;
+  mutable NodeDataArray nodeDataArray_;
 };
 
 //---
@@ -71,8 +114,7 @@ CAStar<NODE>::
 search(NODE *startNode, NODE *goalNode, NodeList &pathNodes)
 {
   // clear open and closed
-  openNodes_  .clear();
-  closedNodes_.clear();
+  clearNodeData();
 
   auto &startNodeData = getNodeData(startNode);
 
@@ -81,68 +123,66 @@ search(NODE *startNode, NODE *goalNode, NodeList &pathNodes)
   startNodeData.estimatedCostToGoal = pathCostEstimate(startNode, goalNode);
   startNodeData.totalCost           = startNodeData.estimatedCostToGoal;
 
-  openNodes_.insert(startNode);
+  pushOpenNode(startNodeData);
 
   // process the list until we get to the goal or fail
-  while (! openNodes_.empty()) {
-    // remove node from open with lowest total cost
+  while (! openHeap_.empty()) {
+    // get node from open with lowest total cost
     auto *node = getBestOpenNode();
 
     // if at goal then we're done
     if (node == goalNode) {
       // construct path backward from Node to start
-      pathNodes.push_front(node);
-
-      auto &nodeData = getNodeData(node);
-
-      while (nodeData.parent) {
-        node = nodeData.parent;
-
-        pathNodes.push_front(node);
-
-        nodeData = getNodeData(node);
-      }
+      for (auto *pathNode = node; pathNode; pathNode = getNodeData(pathNode).parent)
+        pathNodes.push_front(pathNode);
 
       return true;
     }
 
+    auto &nodeData = getNodeData(node);
+
     // remove open node
-    openNodes_.erase(node);
+    removeOpenNode(nodeData);
 
-    // push node onto closed
-    closedNodes_.insert(node);
+    // mark node closed
+    nodeData.state = State::CLOSED;
 
-    auto &nodeData = getNodeData(node);
+    // get successor nodes of this node (and cost to them)
+    nextNodes_.clear();
+
+    getNextNodeCosts(node, nextNodes_);
 
-    // get successor nodes of this node
-    NodeList nextNodes = getNextNodes(node);
+    for (const auto &nodeCost : nextNodes_) {
+      auto *nextNode = nodeCost.first;
+
+      auto &nextNodeData = getNodeData(nextNode);
 
-    for (auto *nextNode : nextNodes) {
       // if closed then skip
-      if (isClosedNode(nextNode))
+      if (nextNodeData.state == State::CLOSED)
         continue;
 
       // get cost to this next node
-      double nextCost = nodeData.costFromStart + traverseCost(node, nextNode);
+      double nextCost = nodeData.costFromStart + nodeCost.second;
 
-      bool isOpen = isOpenNode(nextNode);
-
-      auto &nextNodeData = getNodeData(nextNode);
+      bool isOpen = (nextNodeData.state == State::OPEN);
 
       // better if not already open, or already open and this is a better path to this node
       bool isBetter = (! isOpen || nextCost < nextNodeData.costFromStart);
 
       if (isBetter) {
-        if (isOpen)
-          openNodes_.erase(nextNode);
+        nextNodeData.parent        = node;
+        nextNodeData.costFromStart = nextCost;
+
+        // estimate only depends on node so only calculated once
+        if (! isOpen)
+          nextNodeData.estimatedCostToGoal = pathCostEstimate(nextNode, goalNode);
 
-        nextNodeData.parent              = node;
-        nextNodeData.costFromStart       = nextCost;
-        nextNodeData.estimatedCostToGoal = pathCostEstimate(nextNode, goalNode);
-        nextNodeData.totalCost           = nextNodeData.costFromStart +
-                                           nextNodeData.estimatedCostToGoal;
+        nextNodeData.totalCost = nextNodeData.costFromStart + nextNodeData.estimatedCostToGoal;
 
-        openNodes_.insert(nextNode);
+        if (isOpen)
+          updateOpenNode(nextNodeData);
+        else
+          pushOpenNode(nextNodeData);
       }
     }
   }
@@ -155,7 +195,9 @@ bool
 CAStar<NODE>::
 isOpenNode(NODE *node) const
 {
-  return openNodes_.find(node) != openNodes_.end();
+  auto *data = findNodeData(node);
+
+  return (data && data->state == State::OPEN);
 }
 
 template<typename NODE>
@@ -163,7 +205,9 @@ bool
 CAStar<NODE>::
 isClosedNode(NODE *node) const
 {
-  return closedNodes_.find(node) != closedNodes_.end();
+  auto *data = findNodeData(node);
+
+  return (data && data->state == State::CLOSED);
 }
 
 template<typename NODE>
@@ -171,23 +215,12 @@ NODE *
 CAStar<NODE>::
 getBestOpenNode()
 {
-  NODE   *minNode = nullptr;
-  double  minCost = 0.0;
+  if (openHeap_.empty())
+    return nullptr;
 
-  for (auto *node : openNodes_) {
-    auto &nodeData = getNodeData(node);
-
-    double cost = nodeData.totalCost;
-
-    if (minNode == nullptr || cost < minCost) {
-      minNode = node;
-      minCost = cost;
-    }
-  }
-
-  //printNode(minNode);
+  //printNode(openHeap_[0]->node);
 
-  return minNode;
+  return openHeap_[0]->node;
 }
 
 template<typename NODE>
@@ -220,6 +253,15 @@ getNextNodes(NODE *) const
   return NodeList();
 }
 
+template<typename NODE>
+void
+CAStar<NODE>::
+getNextNodeCosts(NODE *node, NodeCostList &nodeCosts)
+{
+  for (auto *nextNode : getNextNodes(node))
+    nodeCosts.push_back(NodeCost(nextNode, traverseCost(node, nextNode)));
+}
+
 template<typename NODE>
 void
 CAStar<NODE>::
@@ -235,16 +277,162 @@ typename CAStar<NODE>::NodeData &
 CAStar<NODE>::
 getNodeData(NODE *node) const
 {
-  using ValueType = typename NodeDataMap::value_type;
+  int ind = nodeIndex(node);
 
-  auto *th = const_cast<CAStar *>(this);
+  if (ind >= 0) {
+    if (size_t(ind) >= nodeDataArray_.size())
+      nodeDataArray_.resize(ind + 1);
+
+    auto &data = nodeDataArray_[ind];
+
+    data.node = node;
+
+    return data;
+  }
 
-  auto p = th->nodeDataMap_.find(node);
+  auto &data = nodeDataMap_[node];
 
-  if (p == th->nodeDataMap_.end())
-    p = th->nodeDataMap_.insert(p, ValueType(node, NodeData()));
+  data.node = node;
+
+  return data;
+}
+
+template<typename NODE>
+const typename CAStar<NODE>::NodeData *
+CAStar<NODE>::
+findNodeData(NODE *node) const
+{
+  int ind = nodeIndex(node);
+
+  if (ind >= 0) {
+    if (size_t(ind) >= nodeDataArray_.size() || nodeDataArray_[ind].node != node)
+      return nullptr;
+
+    return &nodeDataArray_[ind];
+  }
+
+  auto p = nodeDataMap_.find(node);
+
+  if (p == nodeDataMap_.end())
+    return nullptr;
+
+  return &(*p).second;
+}
+
+template<typename NODE>
+void
+CAStar<NODE>::
+clearNodeData()
+{
+  openHeap_.clear();
+
+  nodeDataMap_  .clear();
+  nodeDataArray_.clear();
+}
+
+template<typename NODE>
+void
+CAStar<NODE>::
+pushOpenNode(NodeData &data)
+{
+  data.state = State::OPEN;
+
+  openHeap_.push_back(nullptr);
+
+  setHeapEntry(openHeap_.size() - 1, &data);
+
+  siftUp(data.heapPos);
+}
+
+template<typename NODE>
+void
+CAStar<NODE>::
+updateOpenNode(NodeData &data)
+{
+  assert(data.state == State::OPEN);
+
+  // cost only decreases so move towards root
+  siftUp(data.heapPos);
+}
+
+template<typename NODE>
+void
+CAStar<NODE>::
+removeOpenNode(NodeData &data)
+{
+  assert(data.state == State::OPEN);
+
+  auto pos = data.heapPos;
+
+  data.state = State::NONE;
+
+  // replace with last entry and restore heap order
+  auto *last = openHeap_.back();
+
+  openHeap_.pop_back();
+
+  if (pos < openHeap_.size()) {
+    setHeapEntry(pos, last);
+
+    siftUp  (pos);
+    siftDown(last->heapPos);
+  }
+}
+
+template<typename NODE>
+void
+CAStar<NODE>::
+siftUp(size_t pos)
+{
+  auto *data = openHeap_[pos];
+
+  while (pos > 0) {
+    auto parentPos = (pos - 1)/HEAP_ARITY;
+
+    auto *parentData = openHeap_[parentPos];
+
+    if (! (data->totalCost < parentData->totalCost))
+      break;
+
+    setHeapEntry(pos, parentData);
+
+    pos = parentPos;
+  }
+
+  setHeapEntry(pos, data);
+}
+
+template<typename NODE>
+void
+CAStar<NODE>::
+siftDown(size_t pos)
+{
+  auto n = openHeap_.size();
+
+  auto *data = openHeap_[pos];
+
+  while (true) {
+    auto firstChild = pos*HEAP_ARITY + 1;
+    if (firstChild >= n) break;
+
+    // find smallest child
+    auto minPos  = firstChild;
+    auto lastPos = std::min(firstChild + HEAP_ARITY, n);
+
+    for (auto childPos = firstChild + 1; childPos < lastPos; ++childPos) {
+      if (openHeap_[childPos]->totalCost < openHeap_[minPos]->totalCost)
+        minPos = childPos;
+    }
+
+    if (! (openHeap_[minPos]->totalCost < data->totalCost))
+      break;
+
+    setHeapEntry(pos, openHeap_[minPos]);
+
+    pos = minPos;
+  }
 
-  return (*p).second;
+  setHeapEntry(pos, data);
 }
 
 #endif
@@ -0,0 +1,147 @@
+#include <CDotCSRGraph.h>
+#include <CDotUnionFind.h>
+
+namespace CDotParse {
+
+CSRGraph::
+CSRGraph(const Graph *graph) :
+ graph_(graph)
+{
+  auto addNode = [&](Node *node) {
+    auto p = nodeIndex_.find(node);
+
+    if (p != nodeIndex_.end())
+      return (*p).second;
+
+    auto n = numNodes();
+
+    nodeIndex_.emplace(node, n);
+
+    nodes_.push_back(node);
+
+    return n;
+  };
+
+  //---
+
+  // own nodes first
+  nodes_    .reserve(graph->nodes().size());
+  nodeIndex_.reserve(graph->nodes().size());
+
+  for (const auto &pn : graph->nodes())
+    (void) addNode(pn.second);
+
+  numGraphNodes_ = numNodes();
+
+  //---
+
+  // out edges grouped by from node (nodes_ grows as edges reach nodes in other graphs)
+  outOffsets_.push_back(0);
+
+  for (Index n = 0; n < numNodes(); ++n) {
+    for (auto *edge : nodes_[n]->edges()) {
+      auto to = addNode(edge->toNode());
+
+      edges_   .push_back(edge);
+      edgeFrom_.push_back(n);
+      edgeTo_  .push_back(to);
+      edgeCost_.push_back(edge->cost());
+    }
+
+    outOffsets_.push_back(numEdges());
+  }
+
+  //---
+
+  // in edges (counting sort of edge indices by to node)
+  inOffsets_.assign(numNodes() + 1, 0);
+
+  for (Index e = 0; e < numEdges(); ++e)
+    ++inOffsets_[edgeTo_[e] + 1];
+
+  for (Index n = 0; n < numNodes(); ++n)
+    inOffsets_[n + 1] += inOffsets_[n];
+
+  inEdges_.resize(numEdges());
+
+  auto pos = Indices(inOffsets_.begin(), inOffsets_.end() - 1);
+
+  for (Index e = 0; e < numEdges(); ++e)
+    inEdges_[pos[edgeTo_[e]]++] = e;
+}
+
+CSRGraph::Index
+CSRGraph::
+nodeIndex(const Node *node) const
+{
+  auto p = nodeIndex_.find(node);
+
+  if (p == nodeIndex_.end())
+    return NO_INDEX;
+
+  return (*p).second;
+}
+
+CSRGraph::Indices
+CSRGraph::
+connectedComponents(Index &numComponents) const
+{
+  // single pass union of edge end points
+  UnionFind unionFind(numNodes());
+
+  for (Index e = 0; e < numEdges(); ++e)
+    (void) unionFind.unite(edgeFrom_[e], edgeTo_[e]);
+
+  // number set roots in node order
+  Indices rootComponent(numNodes(), NO_INDEX);
+  Indices components   (numNodes());
+
+  numComponents = 0;
+
+  for (Index n = 0; n < numNodes(); ++n) {
+    auto root = unionFind.find(n);
+
+    if (rootComponent[root] == NO_INDEX)
+      rootComponent[root] = numComponents++;
+
+    components[n] = rootComponent[root];
+  }
+
+  return components;
+}
+
+CSRGraph::Ids
+CSRGraph::
+nodeAttributeIds(std::string_view name) const
+{
+  Ids ids(numNodes(), 0);
+
+  Id nameId;
+
+  if (! graph_ || ! graph_->parse()->strings().find(name, nameId))
+    return ids;
+
+  for (Index n = 0; n < numNodes(); ++n)
+    (void) nodes_[n]->attributes().getValueId(nameId, ids[n]);
+
+  return ids;
+}
+
+CSRGraph::Ids
+CSRGraph::
+edgeAttributeIds(std::string_view name) const
+{
+  Ids ids(numEdges(), 0);
+
+  Id nameId;
+
+  if (! graph_ || ! graph_->parse()->strings().find(name, nameId))
+    return ids;
+
+  for (Index e = 0; e < numEdges(); ++e)
+    (void) edges_[e]->attributes().getValueId(nameId, ids[e]);
+
+  return ids;
+}
+
+}
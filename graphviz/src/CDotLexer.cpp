@@ -0,0 +1,330 @@
+#include <CDotLexer.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cctype>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace CDotParse {
+
+Lexer::
+Lexer(const std::string &filename) :
+ fileName_(filename)
+{
+  load();
+
+  nextToken();
+}
+
+Lexer::
+~Lexer()
+{
+  if (mapped_)
+    ::munmap(const_cast<char *>(data_), len_);
+}
+
+void
+Lexer::
+load()
+{
+  // map regular files
+  int fd = ::open(fileName_.c_str(), O_RDONLY);
+
+  if (fd >= 0) {
+    struct stat st;
+
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+      void *addr = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+      if (addr != MAP_FAILED) {
+        ::madvise(addr, size_t(st.st_size), MADV_SEQUENTIAL);
+
+        data_   = static_cast<const char *>(addr);
+        len_    = size_t(st.st_size);
+        mapped_ = true;
+      }
+    }
+
+    ::close(fd);
+  }
+
+  if (mapped_)
+    return;
+
+  //---
+
+  // fallback to reading whole file into buffer (empty file, pipe, ...)
+  std::ifstream is(fileName_, std::ios::in | std::ios::binary);
+  if (! is) return;
+
+  std::ostringstream ss;
+
+  ss << is.rdbuf();
+
+  buffer_ = ss.str();
+
+  data_ = buffer_.data();
+  len_  = buffer_.size();
+}
+
+void
+Lexer::
+nextToken()
+{
+  skipSpace();
+
+  readToken(token_);
+}
+
+void
+Lexer::
+skipSpace()
+{
+  // '#' lines (preprocessor output) are only skipped at the start of a line
+  bool lineStart = (pos_ == 0 || data_[pos_ - 1] == '\n');
+
+  while (pos_ < len_) {
+    char c = data_[pos_];
+
+    if      (c == '\n') {
+      lineStart = true;
+
+      ++pos_;
+    }
+    else if (std::isspace(static_cast<unsigned char>(c))) {
+      ++pos_;
+    }
+    else if (c == '#' && lineStart) {
+      while (pos_ < len_ && data_[pos_] != '\n')
+        ++pos_;
+    }
+    else if (c == '/' && pos_ + 1 < len_ && data_[pos_ + 1] == '/') { // single line
+      pos_ += 2;
+
+      while (pos_ < len_ && data_[pos_] != '\n')
+        ++pos_;
+    }
+    else if (c == '/' && pos_ + 1 < len_ && data_[pos_ + 1] == '*') { // multi line
+      pos_ += 2;
+
+      while (pos_ < len_ && ! (data_[pos_] == '*' && pos_ + 1 < len_ && data_[pos_ + 1] == '/'))
+        ++pos_;
+
+      pos_ = std::min(pos_ + 2, len_);
+
+      lineStart = false;
+    }
+    else
+      break;
+  }
+}
+
+void
+Lexer::
+readToken(Token &token)
+{
+  token.pos = pos_;
+
+  if (pos_ >= len_) {
+    token.type = TokenType::END;
+    token.str  = std::string_view();
+    return;
+  }
+
+  auto setToken = [&](TokenType type, size_t start, size_t end) {
+    token.type = type;
+    token.str  = std::string_view(data_ + start, end - start);
+  };
+
+  auto charToken = [&](TokenType type, size_t n) {
+    setToken(type, pos_, pos_ + n);
+
+    pos_ += n;
+  };
+
+  char c = data_[pos_];
+
+  switch (c) {
+    case '{': charToken(TokenType::OPEN_BRACE   , 1); return;
+    case '}': charToken(TokenType::CLOSE_BRACE  , 1); return;
+    case '[': charToken(TokenType::OPEN_BRACKET , 1); return;
+    case ']': charToken(TokenType::CLOSE_BRACKET, 1); return;
+    case '=': charToken(TokenType::EQUALS       , 1); return;
+    case ';': charToken(TokenType::SEMI_COLON   , 1); return;
+    case ',': charToken(TokenType::COMMA        , 1); return;
+    case ':': charToken(TokenType::COLON        , 1); return;
+    default : break;
+  }
+
+  //---
+
+  // edge op
+  if (c == '-' && pos_ + 1 < len_) {
+    char c1 = data_[pos_ + 1];
+
+    if (c1 == '>') { charToken(TokenType::DIRECTED_EDGE  , 2); return; }
+    if (c1 == '-') { charToken(TokenType::UNDIRECTED_EDGE, 2); return; }
+  }
+
+  //---
+
+  // quoted string (TODO: single quote not allowed ?)
+  if (c == '"' || c == '\'') {
+    size_t start = ++pos_;
+
+    while (pos_ < len_ && data_[pos_] != c) {
+      if (data_[pos_] == '\\' && pos_ + 1 < len_)
+        ++pos_;
+
+      ++pos_;
+    }
+
+    setToken(TokenType::STRING, start, pos_);
+
+    if (pos_ < len_)
+      ++pos_;
+
+    return;
+  }
+
+  //---
+
+  // html string (nested angle brackets, skip brackets in quoted strings)
+  if (c == '<') {
+    size_t start = pos_++;
+
+    int num_html   = 1;
+    int num_squote = 0;
+    int num_dquote = 0;
+
+    while (pos_ < len_) {
+      char c1 = data_[pos_++];
+
+      if      (num_squote > 0) {
+        if      (c1 == '\\') {
+          if (pos_ < len_)
+            ++pos_;
+        }
+        else if (c1 == '\'')
+          --num_squote;
+      }
+      else if (num_dquote > 0) {
+        if      (c1 == '\\') {
+          if (pos_ < len_)
+            ++pos_;
+        }
+        else if (c1 == '\"')
+          --num_dquote;
+      }
+      else {
+        if      (c1 == '<')
+          ++num_html;
+        else if (c1 == '>') {
+          --num_html;
+
+          if (num_html == 0)
+            break;
+        }
+        else if (c1 == '\'')
+          ++num_squote;
+        else if (c1 == '\"')
+          ++num_dquote;
+      }
+    }
+
+    setToken(TokenType::HTML, start, pos_);
+
+    return;
+  }
+
+  //---
+
+  // number
+  if (isDigit(pos_) || ((c == '-' || c == '.') && (isDigit(pos_ + 1) ||
+      (c == '-' && pos_ + 2 < len_ && data_[pos_ + 1] == '.' && isDigit(pos_ + 2))))) {
+    size_t start = pos_++;
+
+    while (isDigit(pos_))
+      ++pos_;
+
+    if (c != '.' && pos_ < len_ && data_[pos_] == '.') {
+      ++pos_;
+
+      while (isDigit(pos_))
+        ++pos_;
+    }
+
+    setToken(TokenType::NUMBER, start, pos_);
+
+    return;
+  }
+
+  //---
+
+  // identifier
+  if (isIdentifierStart(c)) {
+    size_t start = pos_++;
+
+    while (pos_ < len_ && isIdentifierChar(data_[pos_]))
+      ++pos_;
+
+    setToken(TokenType::IDENTIFIER, start, pos_);
+
+    return;
+  }
+
+  //---
+
+  charToken(TokenType::INVALID, 1);
+}
+
+bool
+Lexer::
+isIdentifierStart(char c) const
+{
+  auto uc = static_cast<unsigned char>(c);
+
+  // allow non-ascii (utf-8) chars in identifiers
+  return (c == '_' || std::isalpha(uc) || uc >= 0x80);
+}
+
+bool
+Lexer::
+isIdentifierChar(char c) const
+{
+  auto uc = static_cast<unsigned char>(c);
+
+  return (c == '_' || std::isalnum(uc) || uc >= 0x80);
+}
+
+bool
+Lexer::
+isDigit(size_t pos) const
+{
+  return (pos < len_ && std::isdigit(static_cast<unsigned char>(data_[pos])));
+}
+
+void
+Lexer::
+position(size_t pos, int &lineNum, int &charNum) const
+{
+  lineNum = 1;
+  charNum = 0;
+
+  for (size_t i = 0; i < pos && i < len_; ++i) {
+    if (data_[i] == '\n') {
+      ++lineNum;
+
+      charNum = 0;
+    }
+    else
+      ++charNum;
+  }
+}
+
+}
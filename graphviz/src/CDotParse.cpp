@@ -1,19 +1,24 @@
 #include <CDotParse.h>
-#include <CFileParse.h>
+#include <CDotCSRGraph.h>
+#include <CDotUnionFind.h>
 #include <CAStarNode.h>
 #include <CStrUtil.h>
 
-#include <list>
+#include <algorithm>
+#include <queue>
+#include <cmath>
 #include <cassert>
 
 namespace CDotParse {
 
 Parse::
-Parse(const std::string &filename)
+Parse(const std::string &filename) :
+ nodeDefaults_(&strings_), edgeDefaults_(&strings_)
 {
-  parse_ = std::make_unique<CFileParse>(filename);
+  nodeDefaults_.setNameValue("shape", "circle");
+  edgeDefaults_.setNameValue("shape", "arrow");
 
-  parse_->setStream(true);
+  lexer_ = std::make_unique<Lexer>(filename);
 }
 
 Parse::
@@ -27,31 +32,16 @@ parse()
 {
   EnterLeave el(this, "parse");
 
-  if (parse_->isChar('#')) {
-    while (! parse_->eof()) {
-      if (parse_->isChar('\n'))
-        break;
-
-      parse_->skipChar();
-    }
-  }
-
-  //---
+  if (! lexer_->isValid())
+    return errorMsg("failed to read file");
 
-  while (! parse_->eof()) {
-    skipSpace();
-
-    if (parse_->eof())
-      break;
-
-    std::string identifier;
+  while (! lexer_->isEOF()) {
+    std::string_view identifier;
 
     if (! parseIdentifier(identifier))
       return errorMsg("expected identfier");
 
     if (identifier == "strict") {
-      skipSpace();
-
       if (! parseIdentifier(identifier))
         return errorMsg("expected identfier");
     }
@@ -61,7 +51,7 @@ parse()
         return errorMsg("parseGraph failed");
     }
     else
-      return errorMsg("Invalid identifier '" + identifier + "'");
+      return errorMsg("Invalid identifier '" + std::string(identifier) + "'");
   }
 
   if (isPrint()) {
@@ -86,29 +76,25 @@ parseGraph()
   EnterLeave el(this, "parseGraph");
 
   while (true) {
-    skipSpace();
-
-    if (parse_->eof())
+    if (lexer_->isEOF())
       break;
 
-    if      (parse_->isChar('[')) {
+    if      (isToken(Lexer::TokenType::OPEN_BRACKET)) {
       parseAttrList("");
     }
-    else if (parse_->isChar('{')) {
-      parse_->skipChar();
+    else if (isToken(Lexer::TokenType::OPEN_BRACE)) {
+      skipToken();
 
       parseStatementList();
 
-      skipSpace();
-
-      if (! parse_->isChar('}'))
+      if (! isToken(Lexer::TokenType::CLOSE_BRACE))
         return errorMsg("expected }");
 
-      parse_->skipChar();
+      skipToken();
     }
     else {
       // graph id
-      std::string id;
+      std::string_view id;
 
       if (! parseID(id))
         return errorMsg("expected identfier");
@@ -130,24 +116,17 @@ parseStatementList()
   EnterLeave el(this, "parseStatementList");
 
   while (true) {
-    skipSpace();
-
-    if (parse_->eof())
+    if (lexer_->isEOF())
       break;
 
+    if (isToken(Lexer::TokenType::CLOSE_BRACE))
+      return true;
+
     if (! parseStatement())
       return errorMsg("parseStatement failed");
 
-    skipSpace();
-
-    if (parse_->isChar(';')) {
-      parse_->skipChar();
-
-      skipSpace();
-    }
-
-    if (parse_->isChar('}'))
-      return true;
+    if (isToken(Lexer::TokenType::SEMI_COLON))
+      skipToken();
   }
 
   return errorMsg("parseStatementList failed");
@@ -159,44 +138,32 @@ parseStatement()
 {
   EnterLeave el(this, "parseStatement");
 
-  skipSpace();
-
-  //---
-
-  if (parse_->isChar('{')) {
-    parse_->skipChar();
+  if (isToken(Lexer::TokenType::OPEN_BRACE)) {
+    skipToken();
 
     parseStatementList();
 
-    skipSpace();
-
-    if (! parse_->isChar('}'))
+    if (! isToken(Lexer::TokenType::CLOSE_BRACE))
       return errorMsg("expected }");
 
-    parse_->skipChar();
-
-    skipSpace();
+    skipToken();
 
     return true;
   }
 
   //---
 
-  std::string id;
+  std::string_view id;
 
   if (! parseID(id))
     return errorMsg("expected identifier");
 
-  skipSpace();
-
   // attr_stmt
   if      (id == "graph" || id == "node" || id == "edge") {
     parseAttrList(id);
   }
   else if (id == "subgraph") {
-    std::string id1;
-
-    skipSpace();
+    std::string_view id1;
 
     if (! parseID(id1))
       return errorMsg("expected identfier");
@@ -211,135 +178,105 @@ parseStatement()
 
     //---
 
-    skipSpace();
-
-    if (parse_->isChar('{')) {
-      parse_->skipChar();
+    if (isToken(Lexer::TokenType::OPEN_BRACE)) {
+      skipToken();
 
       if (! parseStatementList())
         return errorMsg("parseStatementList failed");
 
-      skipSpace();
-
-      if (! parse_->isChar('}'))
+      if (! isToken(Lexer::TokenType::CLOSE_BRACE))
         return errorMsg("expected }");
 
-      parse_->skipChar();
-
-      skipSpace();
+      skipToken();
     }
 
     currentGraph_ = subGraph->parent();
   }
   // name = value
-  else if (parse_->isChar('=')) {
-    parse_->skipChar();
-
-    skipSpace();
+  else if (isToken(Lexer::TokenType::EQUALS)) {
+    skipToken();
 
-    std::string id1;
+    std::string_view id1;
 
     if (! parseID(id1))
       return errorMsg("expected identifier");
   }
   // node [ <attributes> ]
-  else if (parse_->isChar('[')) {
-    currentNode_ = getNode(id).get();
+  else if (isToken(Lexer::TokenType::OPEN_BRACKET)) {
+    currentNode_ = getNode(id);
 
     parseAttrList("");
   }
   // edge
-  else if (parse_->isString("->") || parse_->isString("--")) {
-    bool directed = parse_->isString("->");
-
-    parse_->skipChar(2);
+  else if (lexer_->token().isEdgeOp()) {
+    bool directed = isToken(Lexer::TokenType::DIRECTED_EDGE);
 
-    skipSpace();
+    skipToken();
 
     std::vector<Node *> nodes1;
 
-    Node *node1 = getNode(id).get();
+    Node *node1 = getNode(id);
 
     nodes1.push_back(node1);
 
     while (true) {
       std::vector<Node *> nodes2;
 
-      if (parse_->isChar('{')) {
-        parse_->skipChar();
+      if (isToken(Lexer::TokenType::OPEN_BRACE)) {
+        skipToken();
 
-        skipSpace();
-
-        while (! parse_->eof() && ! parse_->isChar('}')) {
-          std::string id1;
+        while (! lexer_->isEOF() && ! isToken(Lexer::TokenType::CLOSE_BRACE)) {
+          std::string_view id1;
 
           if (! parseID(id1))
             return errorMsg("expected identfier");
 
-          Node *node2 = getNode(id1).get();
+          Node *node2 = getNode(id1);
 
           nodes2.push_back(node2);
 
           for (const auto &n1 : nodes1) {
-            currentEdge_ = n1->addNodeEdge(node2).get();
+            currentEdge_ = n1->addNodeEdge(node2);
 
             currentEdge_->setDirected(directed);
           }
 
-          skipSpace();
-
-          if (parse_->isChar('[')) {
+          if (isToken(Lexer::TokenType::OPEN_BRACKET))
             parseAttrList("");
 
-            skipSpace();
-          }
-
-          if (parse_->isChar(',')) {
-            parse_->skipChar();
-
-            skipSpace();
-          }
+          if (isToken(Lexer::TokenType::COMMA))
+            skipToken();
         }
 
-        if (parse_->isChar('}')) {
-          parse_->skipChar();
-
-          skipSpace();
-        }
+        if (isToken(Lexer::TokenType::CLOSE_BRACE))
+          skipToken();
       }
       else {
-        std::string id1;
+        std::string_view id1;
 
         if (! parseID(id1))
           return errorMsg("expected identfier");
 
-        Node *node2 = getNode(id1).get();
+        Node *node2 = getNode(id1);
 
         nodes2.push_back(node2);
 
         for (const auto &n1 : nodes1) {
-          currentEdge_ = n1->addNodeEdge(node2).get();
+          currentEdge_ = n1->addNodeEdge(node2);
 
           currentEdge_->setDirected(directed);
         }
 
-        skipSpace();
-
-        if (parse_->isChar('[')) {
+        if (isToken(Lexer::TokenType::OPEN_BRACKET))
           parseAttrList("");
-
-          skipSpace();
-        }
       }
 
       //---
 
-      if (! parse_->isString("->") && ! parse_->isString("--"))
+      if (! lexer_->token().isEdgeOp())
         break;
 
-      parse_->skipChar(2);
-
-      skipSpace();
+      skipToken();
 
       //---
 
@@ -348,11 +285,8 @@ parseStatement()
 
     currentEdge_ = nullptr;
   }
-  else if (parse_->isChar('}')) {
-    currentNode_ = getNode(id).get();
-  }
   else {
-    currentNode_ = getNode(id).get();
+    currentNode_ = getNode(id);
   }
 
   return true;
@@ -360,41 +294,33 @@ parseStatement()
 
 bool
 Parse::
-parseAttrList(const std::string &id)
+parseAttrList(std::string_view id)
 {
-  EnterLeave el(this, "parseAttrList " + id);
+  EnterLeave el(this, "parseAttrList", id);
 
   while (true) {
-    skipSpace();
-
-    if (parse_->eof())
+    if (lexer_->isEOF())
       break;
 
-    if (! parse_->isChar('['))
+    if (! isToken(Lexer::TokenType::OPEN_BRACKET))
       return errorMsg("expected [");
 
-    parse_->skipChar();
+    skipToken();
 
-    parse_->skipSpace();
-
-    if (parse_->isChar(']')) {
-      parse_->skipChar();
+    if (isToken(Lexer::TokenType::CLOSE_BRACKET)) {
+      skipToken();
       break;
     }
 
     if (! parseAList(id))
       return errorMsg("parseAList failed");
 
-    skipSpace();
-
-    if (! parse_->isChar(']'))
+    if (! isToken(Lexer::TokenType::CLOSE_BRACKET))
       return errorMsg("expected ]");
 
-    parse_->skipChar();
-
-    skipSpace();
+    skipToken();
 
-    if (! parse_->isChar('['))
+    if (! isToken(Lexer::TokenType::OPEN_BRACKET))
       break;
   }
 
@@ -403,45 +329,45 @@ parseAttrList(const std::string &id)
 
 bool
 Parse::
-parseAList(const std::string &id)
+parseAList(std::string_view id)
 {
-  EnterLeave el(this, "parseAList " + id);
+  EnterLeave el(this, "parseAList", id);
 
   while (true) {
-    skipSpace();
-
-    if (parse_->eof())
+    if (lexer_->isEOF())
       break;
 
-    std::string id1;
+    std::string_view id1;
 
     if (! parseID(id1))
       return errorMsg("expected identifier");
 
-    skipSpace();
-
-    if (! parse_->isChar('='))
+    if (! isToken(Lexer::TokenType::EQUALS))
       return errorMsg("expected =");
 
-    parse_->skipChar();
+    skipToken();
 
-    skipSpace();
+    if (isToken(Lexer::TokenType::NUMBER)) {
+      bool ok;
 
-    if (parse_->isDigit() || parse_->isChar('.') || parse_->isChar('-')) {
-      double r;
+      double r = Util::stringToReal(std::string(lexer_->token().str), ok);
 
-      if (! parse_->readReal(&r))
+      if (! ok)
         return errorMsg("expected real");
 
+      skipToken();
+
+      auto value = std::to_string(r);
+
       if      (currentEdge_)
-        currentEdge_->setAttribute(id1, std::to_string(r));
+        currentEdge_->setAttribute(id1, value);
       else if (currentNode_)
-        currentNode_->setAttribute(id1, std::to_string(r));
+        currentNode_->setAttribute(id1, value);
       else if (currentGraph_)
-        currentGraph_->setAttribute(id1, std::to_string(r));
+        currentGraph_->setAttribute(id1, value);
     }
     else {
-      std::string id2;
+      std::string_view id2;
 
       if (! parseID(id2))
         return errorMsg("expected identifier");
@@ -467,16 +393,11 @@ parseAList(const std::string &id)
 
     //---
 
-    skipSpace();
-
-    if (parse_->isChar(']'))
+    if (isToken(Lexer::TokenType::CLOSE_BRACKET))
       break;
 
-    if (parse_->isChar(';') || parse_->isChar(',')) {
-      parse_->skipChar();
-
-      skipSpace();
-    }
+    if (isToken(Lexer::TokenType::SEMI_COLON) || isToken(Lexer::TokenType::COMMA))
+      skipToken();
   }
 
   return true;
@@ -484,108 +405,18 @@ parseAList(const std::string &id)
 
 bool
 Parse::
-parseID(std::string &id)
+parseID(std::string_view &id)
 {
   EnterLeave el(this, "parseID");
 
-  // TODO: single quote not allowed ?
-  if      (parse_->isChar('\'')) {
-    //id += '\'';
-
-    parse_->skipChar();
-
-    while (! parse_->eof()) {
-      char c = parse_->readChar();
-
-      if (c == '\'')
-        break;
-
-      id += c;
-    }
-  }
-  else if (parse_->isChar('\"')) {
-    //id += '\"';
-
-    parse_->skipChar();
-
-    while (! parse_->eof()) {
-      char c = parse_->readChar();
-
-      if (c == '\"')
-        break;
-
-      id += c;
-    }
-  }
-  else if (parse_->isChar('<')) {
-    id += '<';
-
-    parse_->skipChar();
-
-    int num_html   = 1;
-    int num_squote = 0;
-    int num_dquote = 0;
-
-    while (! parse_->eof()) {
-      char c = parse_->readChar();
-
-      id += c;
-
-      if      (num_squote > 0) {
-        if      (c == '\\') {
-          if (! parse_->eof()) {
-            char c1 = parse_->readChar();
+  const auto &token = lexer_->token();
 
-            id += c1;
-          }
-        }
-        else if (c == '\'') {
-          --num_squote;
-        }
-      }
-      else if (num_dquote > 0) {
-        if      (c == '\\') {
-          if (! parse_->eof()) {
-            char c1 = parse_->readChar();
-
-            id += c1;
-          }
-        }
-        else if (c == '\"') {
-          --num_dquote;
-        }
-      }
-      else {
-        if      (c == '<')
-          ++num_html;
-        else if (c == '>') {
-          --num_html;
+  if (! token.isID())
+    return false;
 
-          if (num_html == 0)
-            break;
-        }
-        else if (c == '\'')
-          ++num_squote;
-        else if (c == '\"')
-          ++num_dquote;
-      }
-    }
-  }
-  else if (parse_->isDigit()) {
-    while (! parse_->eof() && parse_->isDigit())
-      id += parse_->readChar();
+  id = token.str;
 
-    if (parse_->isChar('.')) {
-      id += parse_->readChar();
-
-      while (! parse_->eof() && parse_->isDigit())
-        id += parse_->readChar();
-    }
-  }
-  else {
-    if (! parse_->readIdentifier(id))
-      return false;
-  }
+  skipToken();
 
   if (isDebug()) {
     depthSpaces(); std::cerr << " " << id << "\n";
@@ -596,13 +427,17 @@ parseID(std::string &id)
 
 bool
 Parse::
-parseIdentifier(std::string &id)
+parseIdentifier(std::string_view &id)
 {
   EnterLeave el(this, "parseIdentifier");
 
-  if (! parse_->readIdentifier(id))
+  if (! isToken(Lexer::TokenType::IDENTIFIER))
     return false;
 
+  id = lexer_->token().str;
+
+  skipToken();
+
   if (isDebug()) {
     depthSpaces(); std::cerr << " " << id << "\n";
   }
@@ -612,65 +447,15 @@ parseIdentifier(std::string &id)
 
 void
 Parse::
-skipSpace()
+enter(const char *proc, std::string_view arg) const
 {
-  while (true) {
-    // skip space
-    while (! parse_->eof() && parse_->isSpace()) {
-      std::string sstr;
-
-      while (! parse_->eof() && parse_->isSpace())
-        sstr += parse_->readChar();
-
-      if (parse_->isChar('#')) {
-        auto p = sstr.find('\n');
-
-        if (p != std::string::npos) {
-          while (! parse_->eof()) {
-            if (parse_->isChar('\n'))
-              break;
-
-            parse_->skipChar();
-          }
-        }
-      }
-    }
-
-    // skip comments
-    if      (parse_->isString("//")) { // single line
-      while (! parse_->eof() && parse_->isString("//")) {
-        parse_->skipChar(2);
-
-        while (! parse_->eof() && ! parse_->isChar('\n'))
-          parse_->skipChar();
-
-        if (parse_->isChar('\n'))
-          parse_->skipChar();
-
-        parse_->skipSpace();
-      }
-    }
-    else if (parse_->isString("/*")) { // multi line
-      parse_->skipChar(2);
-
-      while (! parse_->eof() && ! parse_->isString("*/")) {
-        parse_->skipChar();
-      }
+  if (isDebug()) {
+    depthSpaces(); std::cerr << "> " << proc;
 
-      if (parse_->isString("*/"))
-        parse_->skipChar(2);
-    }
-    else
-      break;
-  }
-}
+    if (! arg.empty())
+      std::cerr << " " << arg;
 
-void
-Parse::
-enter(const std::string &proc) const
-{
-  if (isDebug()) {
-    depthSpaces(); std::cerr << "> " << proc << "\n";
+    std::cerr << "\n";
   }
 
   ++depth_;
@@ -678,12 +463,17 @@ enter(const std::string &proc) const
 
 void
 Parse::
-leave(const std::string &proc) const
+leave(const char *proc, std::string_view arg) const
 {
   --depth_;
 
   if (isDebug()) {
-    depthSpaces(); std::cerr << "< " << proc << "\n";
+    depthSpaces(); std::cerr << "< " << proc;
+
+    if (! arg.empty())
+      std::cerr << " " << arg;
+
+    std::cerr << "\n";
   }
 }
 
@@ -699,46 +489,58 @@ bool
 Parse::
 errorMsg(const std::string &msg) const
 {
-  std::cerr << "Error: " << parse_->fileName() << "@" <<
-               parse_->lineNum() << ":" << parse_->charNum() << " ";
+  int lineNum, charNum;
+
+  lexer_->position(lexer_->token().pos, lineNum, charNum);
+
+  std::cerr << "Error: " << lexer_->fileName() << "@" << lineNum << ":" << charNum << " ";
   std::cerr << msg << "\n";
   return false;
 }
 
 Graph *
 Parse::
-getGraph(const std::string &name)
+getGraph(std::string_view name)
 {
   auto p = graphs_.find(name);
 
   if (p == graphs_.end()) {
-    auto graph = GraphP(makeGraph(name));
+    auto name1 = std::string(name);
+
+    auto graph = makeGraph(name1);
 
-    p = graphs_.insert(p, GraphMap::value_type(name, graph));
+    p = graphs_.insert(p, GraphMap::value_type(name1, graph));
   }
 
-  return (*p).second.get();
+  return (*p).second;
 }
 
 NodeP
 Parse::
-getNode(const std::string &name)
+getNode(std::string_view name)
 {
-  for (auto &pg : graphs_) {
-    auto graph = pg.second;
+  auto p = nodeIndex_.find(name);
 
-    auto node = graph->getNode(name, /*create*/false);
-    if (node) return node;
-  }
+  if (p != nodeIndex_.end())
+    return (*p).second;
 
   return currentGraph()->getNode(name, /*create*/true);
 }
 
+void
+Parse::
+addNodeIndex(NodeP node)
+{
+  // first node with name wins (names are unique across parsed graphs, derived graphs
+  // e.g. minimumSpaningTree reuse existing names so don't replace the parsed node)
+  nodeIndex_.emplace(std::string_view(node->name()), node);
+}
+
 Graph *
 Parse::
 makeGraph(const std::string &name) const
 {
-  return new Graph(const_cast<Parse *>(this), name);
+  return create<Graph>(const_cast<Parse *>(this), name);
 }
 
 Graph *
@@ -750,7 +552,7 @@ currentGraph() const
 
   assert(! graphs_.empty());
 
-  return graphs_.begin()->second.get();
+  return graphs_.begin()->second;
 }
 
 Node *
@@ -766,7 +568,7 @@ Node *
 Parse::
 makeNode(Graph *graph, const std::string &name) const
 {
-  return new Node(graph, name);
+  return create<Node>(graph, name);
 }
 
 Edge *
@@ -775,15 +577,20 @@ makeEdge(Node *node1, Node *node2) const
 {
   //assert(node1->graph() == this && node2->graph() == this);
 
-  return new Edge(node1, node2);
+  return create<Edge>(node1, node2);
 }
 
 //---
 
 Graph::
 Graph(Parse *parse, const std::string &name) :
- parse_(parse), name_(name)
+ parse_(parse), name_(name), attributes_(&parse->strings())
 {
+  attributesList_.emplace_back(&parse->strings(), &parse->nodeDefaults());
+  nodeAttributes_.attributes = &attributesList_.back();
+
+  attributesList_.emplace_back(&parse->strings(), &parse->edgeDefaults());
+  edgeAttributes_.attributes = &attributesList_.back();
 }
 
 Graph::
@@ -793,7 +600,7 @@ Graph::
 
 NodeP
 Graph::
-getNode(const std::string &name, bool create)
+getNode(std::string_view name, bool create)
 {
   auto p = nodes_.find(name);
 
@@ -805,17 +612,14 @@ getNode(const std::string &name, bool create)
 
   //---
 
-  return addNode(name);
+  return addNode(std::string(name));
 }
 
 NodeP
 Graph::
 addNode(const std::string &name)
 {
-  auto node = NodeP(parse()->makeNode(this, name));
-
-  for (const auto &pn : nodeAttributes())
-    node->setAttribute(pn.first, pn.second);
+  auto node = parse()->makeNode(this, name);
 
   addNode(node);
 
@@ -830,6 +634,8 @@ addNode(NodeP node)
   assert(p == nodes_.end());
 
   nodes_[node->name()] = node;
+
+  parse_->addNodeIndex(node);
 }
 
 EdgeP
@@ -843,14 +649,14 @@ void
 Graph::
 addEdge(EdgeP edge)
 {
-  edges_.insert(edge);
+  edges_.push_back(edge);
 }
 
 void
 Graph::
 removeEdge(EdgeP edge)
 {
-  auto p = edges_.find(edge);
+  auto p = std::find(edges_.begin(), edges_.end(), edge);
 
   if (p != edges_.end())
     edges_.erase(p);
@@ -858,23 +664,57 @@ removeEdge(EdgeP edge)
 
 void
 Graph::
-setAttribute(const std::string &name, const std::string &value)
+setAttribute(std::string_view name, std::string_view value)
 {
   attributes_.setNameValue(name, value);
 }
 
 void
 Graph::
-setNodeAttribute(const std::string &name, const std::string &value)
+setNodeAttribute(std::string_view name, std::string_view value)
 {
-  nodeAttributes_.setNameValue(name, value);
+  setDefaultAttribute(nodeAttributes_, name, value);
 }
 
 void
 Graph::
-setEdgeAttribute(const std::string &name, const std::string &value)
+setEdgeAttribute(std::string_view name, std::string_view value)
 {
-  edgeAttributes_.setNameValue(name, value);
+  setDefaultAttribute(edgeAttributes_, name, value);
+}
+
+void
+Graph::
+setDefaultAttribute(DefaultAttributes &defaults, std::string_view name, std::string_view value)
+{
+  // defaults only apply to objects created after they are set so if current defaults
+  // are referenced by existing objects then update a copy
+  if (defaults.shared) {
+    attributesList_.push_back(*defaults.attributes);
+
+    defaults.attributes = &attributesList_.back();
+    defaults.shared     = false;
+  }
+
+  defaults.attributes->setNameValue(name, value);
+}
+
+const Attributes *
+Graph::
+shareNodeAttributes() const
+{
+  nodeAttributes_.shared = true;
+
+  return nodeAttributes_.attributes;
+}
+
+const Attributes *
+Graph::
+shareEdgeAttributes() const
+{
+  edgeAttributes_.shared = true;
+
+  return edgeAttributes_.attributes;
 }
 
 void
@@ -883,6 +723,10 @@ addGraph(Graph *graph)
 {
   graph->setParent(this);
 
+  // sub graph defaults inherit from ours
+  graph->nodeAttributes_.attributes->setParent(shareNodeAttributes());
+  graph->edgeAttributes_.attributes->setParent(shareEdgeAttributes());
+
   graphs_.insert(graph);
 }
 
@@ -905,121 +749,297 @@ outputCSV(std::ostream &os) const
     pn.second->outputCSV(os);
 }
 
+CSRGraph
+Graph::
+freeze() const
+{
+  return CSRGraph(this);
+}
+
 GraphP
 Graph::
-minimumSpaningTree() const
+minimumSpaningTree(MSTType type) const
 {
-  auto newGraph = GraphP(parse_->makeGraph(""));
+  return minimumSpaningTree(freeze(), type);
+}
 
-  int num_nodes = nodes_.size();
-  int num_edges = edges_.size();
+GraphP
+Graph::
+minimumSpaningTree(const CSRGraph &csr, MSTType type) const
+{
+  assert(csr.graph() == this);
+
+  auto newGraph = parse_->makeGraph("");
 
-  if (num_nodes == 0 || num_edges == 0)
+  if (csr.numGraphNodes() == 0 || csr.numGraphEdges() == 0)
     return newGraph;
 
-  std::list<EdgeP> in_edges;
+  // get tree edges
+  auto treeEdges = (type == MSTType::PRIM ? primEdges(csr) : kruskalEdges(csr));
 
-  for (auto &edge : edges_)
-    in_edges.push_back(edge);
+  // copy tree edges (and their nodes) to new graph
+  std::vector<Node *> newNodes(csr.numNodes(), nullptr);
 
-  int num_in_edges = in_edges.size();
+  auto getNewNode = [&](CSRGraph::Index n) {
+    if (! newNodes[n])
+      newNodes[n] = newGraph->addNode(csr.node(n)->name());
 
-  while (num_in_edges > 0) {
-    EdgeP  min_edge;
-    double min_cost { };
+    return newNodes[n];
+  };
 
-    for (auto &iedge : in_edges) {
-      auto cost = iedge->cost();
+  for (auto e : treeEdges) {
+    auto *fromNode = getNewNode(csr.edgeFrom(e));
+    auto *toNode   = getNewNode(csr.edgeTo  (e));
 
-      if (min_edge == nullptr || cost < min_cost) {
-        min_edge = iedge;
-        min_cost = cost;
-      }
-    }
+    auto *edge = newGraph->addEdge(fromNode, toNode);
+
+    edge->setCost(csr.edgeCost(e));
+  }
+
+  if (parse_->isDebug()) {
+    std::cout << (type == MSTType::PRIM ? "Prim" : "Kruskal") << std::endl;
+
+    std::cout << *newGraph << std::endl;
+  }
+
+  return newGraph;
+}
+
+Graph::Indices
+Graph::
+kruskalEdges(const CSRGraph &csr) const
+{
+  // sort graph edges by cost once (stable so equal costs keep edge order)
+  Indices edges(csr.numGraphEdges());
+
+  for (CSRGraph::Index e = 0; e < csr.numGraphEdges(); ++e)
+    edges[e] = e;
+
+  std::stable_sort(edges.begin(), edges.end(), [&](uint32_t e1, uint32_t e2) {
+    return csr.edgeCost(e1) < csr.edgeCost(e2);
+  });
+
+  // add edges which join separate trees
+  UnionFind unionFind(csr.numNodes());
+
+  Indices treeEdges;
 
-    if (! min_edge)
+  for (auto e : edges) {
+    if (unionFind.numSets() == 1)
       break;
 
-    in_edges.remove(min_edge);
+    if (unionFind.unite(csr.edgeFrom(e), csr.edgeTo(e)))
+      treeEdges.push_back(e);
+  }
 
-    --num_in_edges;
+  return treeEdges;
+}
 
-    auto *minFromNode = min_edge->fromNode();
-    auto *minToNode   = min_edge->toNode  ();
+Graph::Indices
+Graph::
+primEdges(const CSRGraph &csr) const
+{
+  struct HeapEdge {
+    double   cost { 0.0 };
+    uint32_t edge { 0 };
 
-    const std::string &name1 = minFromNode->name();
-    const std::string &name2 = minToNode  ->name();
+    bool operator>(const HeapEdge &rhs) const {
+      return (cost > rhs.cost || (cost == rhs.cost && edge > rhs.edge));
+    }
+  };
 
-    minFromNode = newGraph->getNode(name1).get();
-    minToNode   = newGraph->getNode(name2).get();
+  using Heap = std::priority_queue<HeapEdge, std::vector<HeapEdge>, std::greater<HeapEdge>>;
 
-    if (minFromNode == nullptr)
-      minFromNode = newGraph->addNode(name1).get();
+  auto numEdges = csr.numGraphEdges();
 
-    if (minToNode == nullptr)
-      minToNode = newGraph->addNode(name2).get();
+  Visited inTree(csr.numNodes(), false);
 
-    min_edge = newGraph->addEdge(minFromNode, minToNode);
+  Heap heap;
 
-    min_edge->setCost(min_cost);
+  // push graph edges (out and in) of node which leave the tree
+  auto addNode = [&](CSRGraph::Index n) {
+    inTree[n] = true;
 
-    if (newGraph->isCycle(minFromNode) || newGraph->isCycle(minToNode)) {
-      newGraph->removeEdge(min_edge);
+    for (auto e = csr.outBegin(n); e < csr.outEnd(n); ++e) {
+      if (e < numEdges && ! inTree[csr.edgeTo(e)])
+        heap.push(HeapEdge{csr.edgeCost(e), e});
     }
-  }
 
-  if (parse_->isDebug()) {
-    std::cout << "Kruskal" << std::endl;
+    for (auto *pe = csr.inBegin(n); pe != csr.inEnd(n); ++pe) {
+      if (*pe < numEdges && ! inTree[csr.edgeFrom(*pe)])
+        heap.push(HeapEdge{csr.edgeCost(*pe), *pe});
+    }
+  };
 
-    std::cout << *newGraph << std::endl;
+  Indices treeEdges;
+
+  // grow tree from each unvisited node (spanning forest)
+  for (CSRGraph::Index root = 0; root < csr.numNodes(); ++root) {
+    if (inTree[root])
+      continue;
+
+    addNode(root);
+
+    while (! heap.empty()) {
+      auto e = heap.top().edge;
+
+      heap.pop();
+
+      // skip stale edges (both ends already in tree)
+      auto from = csr.edgeFrom(e);
+      auto to   = csr.edgeTo  (e);
+
+      if (inTree[from] && inTree[to])
+        continue;
+
+      treeEdges.push_back(e);
+
+      addNode(inTree[from] ? to : from);
+    }
   }
 
-  return newGraph;
+  return treeEdges;
+}
+
+Graph::NodeArray
+Graph::
+shortestPath(NodeP fromNode, NodeP toNode, PathType type, const std::string &costName) const
+{
+  return shortestPath(freeze(), fromNode, toNode, type, costName);
 }
 
 Graph::NodeArray
 Graph::
-shortestPath(NodeP fromNode, NodeP toNode) const
+shortestPath(const CSRGraph &csr, NodeP fromNode, NodeP toNode, PathType type,
+             const std::string &costName) const
 {
+  assert(csr.graph() == this);
+
+  using Reals = std::vector<double>;
+
   class ShortestPath : public CAStar<Node> {
    public:
-    ShortestPath(Graph *graph) :
-     graph_(graph) {
+    ShortestPath(const CSRGraph &csr, const Reals &costs) :
+     csr_(csr), costs_(costs) {
     }
 
     virtual ~ShortestPath() { }
 
-    Graph *graph() const { return graph_; }
+    void setPositions(const Reals &x, const Reals &y, double scale) {
+      x_ = x; y_ = y; scale_ = scale;
+    }
+
+    // smallest/optimal cost to goal (scaled distance if positions, otherwise zero)
+    double pathCostEstimate(Node *node, Node *goalNode) override {
+      if (scale_ <= 0.0)
+        return 0.0;
+
+      auto n1 = csr_.nodeIndex(node);
+      auto n2 = csr_.nodeIndex(goalNode);
 
-    // smallest/optimal cost to goal
-    double pathCostEstimate(Node * /*startNode*/, Node * /*goalNode*/) override {
-      return 1;
+      return scale_*std::hypot(x_[n2] - x_[n1], y_[n2] - y_[n1]);
     }
 
-    double traverseCost(Node * /*node*/, Node * /*newNode*/) override {
-      return 1;
+    int nodeIndex(Node *node) const override {
+      auto n = csr_.nodeIndex(node);
+
+      return (n != CSRGraph::NO_INDEX ? int(n) : -1);
     }
 
-    NodeList getNextNodes(Node *node) const override {
-      NodeList nodes;
+    void getNextNodeCosts(Node *node, NodeCostList &nodeCosts) override {
+      auto n = csr_.nodeIndex(node);
+      if (n == CSRGraph::NO_INDEX) return;
 
-      for (const auto &edge : node->edges())
-        nodes.push_back(edge->toNode());
+      for (auto e = csr_.outBegin(n); e < csr_.outEnd(n); ++e)
+        nodeCosts.push_back(NodeCost(csr_.node(csr_.edgeTo(e)), costs_[e]));
 
-      return nodes;
+      // undirected (--) edges can also be walked from their to node
+      for (auto *pe = csr_.inBegin(n); pe != csr_.inEnd(n); ++pe) {
+        if (! csr_.edge(*pe)->isDirected())
+          nodeCosts.push_back(NodeCost(csr_.node(csr_.edgeFrom(*pe)), costs_[*pe]));
+      }
     }
 
    private:
-    Graph *graph_ { nullptr };
+    const CSRGraph &csr_;
+    const Reals    &costs_;
+    Reals           x_, y_;
+    double          scale_ { 0.0 };
   };
 
-  ShortestPath shortestPath(const_cast<Graph *>(this));
+  NodeArray pnodes;
 
-  ShortestPath::NodeList nodes;
+  if (csr.nodeIndex(fromNode) == CSRGraph::NO_INDEX ||
+      csr.nodeIndex(toNode  ) == CSRGraph::NO_INDEX)
+    return pnodes;
 
-  NodeArray pnodes;
+  //---
+
+  // get edge costs (unit, edge cost or named edge attribute value), negative costs are
+  // not supported by the search so are clamped to zero
+  Reals costs(csr.numEdges(), 1.0);
 
-  if (! shortestPath.search(fromNode.get(), toNode.get(), nodes))
+  if (type != PathType::HOPS) {
+    auto &strings = parse_->strings();
+
+    CSRGraph::Ids costIds;
+
+    if (costName != "")
+      costIds = csr.edgeAttributeIds(costName);
+
+    for (CSRGraph::Index e = 0; e < csr.numEdges(); ++e) {
+      double cost = csr.edgeCost(e);
+
+      if (! costIds.empty() && costIds[e]) {
+        bool ok;
+
+        auto r = Util::stringToReal(strings.str(costIds[e]), ok);
+
+        if (ok)
+          cost = r;
+      }
+
+      costs[e] = std::max(cost, 0.0);
+    }
+  }
+
+  ShortestPath shortestPath(csr, costs);
+
+  //---
+
+  // A* estimate is euclidean distance between node positions scaled by smallest edge
+  // cost/length ratio so it never over estimates (only used if all nodes have positions).
+  // Undirected edges are walked both ways with the same cost and length so each edge's
+  // ratio covers both directions
+  if (type == PathType::ASTAR) {
+    Reals x, y;
+
+    if (nodePositions(csr, x, y)) {
+      double scale = -1.0;
+
+      for (CSRGraph::Index e = 0; e < csr.numEdges(); ++e) {
+        auto n1 = csr.edgeFrom(e);
+        auto n2 = csr.edgeTo  (e);
+
+        double len = std::hypot(x[n2] - x[n1], y[n2] - y[n1]);
+        if (len <= 0.0) continue;
+
+        double ratio = costs[e]/len;
+
+        if (scale < 0.0 || ratio < scale)
+          scale = ratio;
+      }
+
+      if (scale > 0.0)
+        shortestPath.setPositions(x, y, scale);
+    }
+  }
+
+  //---
+
+  ShortestPath::NodeList nodes;
+
+  if (! shortestPath.search(fromNode, toNode, nodes))
     return pnodes;
 
   for (auto *node : nodes)
@@ -1030,41 +1050,79 @@ shortestPath(NodeP fromNode, NodeP toNode) const
 
 bool
 Graph::
-isCycle(Node *node) const
+nodePositions(const CSRGraph &csr, std::vector<double> &x, std::vector<double> &y) const
 {
-  resetEdgeVisited();
+  auto &strings = parse_->strings();
+
+  auto posIds = csr.nodeAttributeIds("pos");
+
+  x.resize(csr.numNodes());
+  y.resize(csr.numNodes());
+
+  for (CSRGraph::Index n = 0; n < csr.numNodes(); ++n) {
+    if (! posIds[n])
+      return false;
+
+    // pos is "x,y" with optional '!' (pinned) suffix
+    auto str = strings.str(posIds[n]);
+
+    if (! str.empty() && str.back() == '!')
+      str.pop_back();
 
-  return isCycle(node, node);
+    bool ok = true;
+
+    auto reals = Util::stringToReals(str, ok);
+
+    if (! ok || reals.size() < 2)
+      return false;
+
+    x[n] = reals[0];
+    y[n] = reals[1];
+  }
+
+  return true;
 }
 
 bool
 Graph::
-isCycle(Node *node, Node *startNode) const
+isCycle(Node *node) const
 {
-  auto edges = startNode->edges();
+  return isCycle(freeze(), node);
+}
 
-  for (auto &edge : edges) {
-    if (edge->isVisited())
-      continue;
+bool
+Graph::
+isCycle(const CSRGraph &csr, Node *node) const
+{
+  assert(csr.graph() == this);
 
-    edge->setVisited(true);
+  auto n = csr.nodeIndex(node);
+  if (n == CSRGraph::NO_INDEX) return false;
 
-    auto *fromNode = edge->fromNode();
-    auto *toNode   = edge->toNode  ();
+  // depth first search (explicit stack) of nodes reachable from node's out edges
+  Visited nodeVisited(csr.numNodes(), false);
 
-    if (fromNode == startNode) {
-      if (node == toNode)
-        return true;
+  Indices stack;
 
-      if (isCycle(node, toNode))
-        return true;
-    }
-    else {
-      if (node == fromNode)
-        return true;
+  stack.push_back(n);
+
+  while (! stack.empty()) {
+    auto n1 = stack.back();
+
+    stack.pop_back();
 
-      if (isCycle(node, fromNode))
+    for (auto e = csr.outBegin(n1); e < csr.outEnd(n1); ++e) {
+      auto n2 = csr.edgeTo(e);
+
+      if (n2 == n)
         return true;
+
+      if (nodeVisited[n2])
+        continue;
+
+      nodeVisited[n2] = true;
+
+      stack.push_back(n2);
     }
   }
 
@@ -1091,68 +1149,41 @@ Graph::Graphs
 Graph::
 subGraphs() const
 {
-  Graphs graphs;
-
-  resetNodeVisited();
-  resetEdgeVisited();
-
-  int ind = 0;
+  return subGraphs(freeze());
+}
 
-  // find next start node
-  auto nextStartNode = [&]() {
-    NodeP startNode;
+Graph::Graphs
+Graph::
+subGraphs(const CSRGraph &csr) const
+{
+  assert(csr.graph() == this);
 
-    for (const auto &node : nodes()) {
-      if (! node.second->isVisited())
-        return node.second;
-    }
+  Graphs graphs;
 
-    return NodeP();
-  };
+  // connected components (edge direction ignored) numbered in node order
+  CSRGraph::Index numComponents = 0;
 
-  // get start node
-  auto startNode = nextStartNode();
+  auto components = csr.connectedComponents(numComponents);
 
-  while (startNode) {
-    // create sub graph for node
-    auto subName = "subgraph_" + std::to_string(ind++);
+  // create sub graph per component (all components contain an own node)
+  for (CSRGraph::Index c = 0; c < numComponents; ++c) {
+    auto subName = "subgraph_" + std::to_string(c);
 
-    auto subGraph = GraphP(parse_->makeGraph(subName));
+    graphs.push_back(parse_->makeGraph(subName));
+  }
 
-    graphs.push_back(subGraph);
+  // add copy of edges to their component's sub graph
+  for (CSRGraph::Index e = 0; e < csr.numEdges(); ++e) {
+    auto *edge = csr.edge(e);
 
-    // add node edges
-    addNodeToSubGraph(startNode.get(), subGraph);
+    auto subEdge = parse_->makeEdge(edge->fromNode(), edge->toNode());
 
-    // next start node
-    startNode = nextStartNode();
+    graphs[components[csr.edgeFrom(e)]]->addEdge(subEdge);
   }
 
   return graphs;
 }
 
-void
-Graph::
-addNodeToSubGraph(Node *startNode, GraphP subGraph) const
-{
-  startNode->setVisited(true);
-
-  auto edges = startNode->edges();
-
-  for (auto &edge : edges) {
-    if (edge->isVisited())
-      continue;
-
-    edge->setVisited(true);
-
-    auto subEdge = EdgeP(parse_->makeEdge(edge->fromNode(), edge->toNode()));
-
-    subGraph->addEdge(subEdge);
-
-    addNodeToSubGraph(edge->toNode(), subGraph);
-  }
-}
-
 #if 0
 Graph::Edges
 Graph::
@@ -1173,14 +1204,14 @@ getEdges() const
 
 Edge::
 Edge(Node *fromNode, Node *toNode) :
- fromNode_(fromNode), toNode_(toNode)
+ fromNode_(fromNode), toNode_(toNode),
+ attributes_(&fromNode->graph()->parse()->strings(), fromNode->graph()->shareEdgeAttributes())
 {
-  setAttribute("shape", "arrow");
 }
 
 void
 Edge::
-setAttribute(const std::string &name, const std::string &value)
+setAttribute(std::string_view name, std::string_view value)
 {
   attributes_.setNameValue(name, value);
 }
@@ -1196,7 +1227,7 @@ print(std::ostream &os) const
 
     bool first = true;
 
-    for (const auto &pn : attributes()) {
+    for (const auto &pn : attributes().nameValues()) {
       if (! first)
         os << ",";
 
@@ -1229,9 +1260,9 @@ attributesCSVStr() const
 
   bool first = true;
 
-  for (const auto &pn : attributes()) {
-    const auto &name  = pn.first;
-    const auto &value = pn.second;
+  for (const auto &pn : attributes().nameValues()) {
+    auto name  = std::string(pn.first);
+    auto value = std::string(pn.second);
 
     if      (name == "shape") {
     }
@@ -1263,22 +1294,17 @@ attributesCSVStr() const
 
 Node::
 Node(Graph *graph, const std::string &name) :
- graph_(graph), name_(name)
+ graph_(graph), attributes_(&graph->parse()->strings(), graph->shareNodeAttributes())
 {
   assert(graph);
 
-  setAttribute("shape", "circle");
+  name_ = strings().intern(name);
 }
 
 void
 Node::
-setAttribute(const std::string &name, const std::string &value)
+setAttribute(std::string_view name, std::string_view value)
 {
-  if      (name == "color")
-    setColor(value);
-  else if (name == "label")
-    setLabel(value);
-
   attributes_.setNameValue(name, value);
 }
 
@@ -1287,18 +1313,12 @@ Node::
 addNodeEdge(Node *node)
 {
   // TODO: check for existing edge
-  auto edge = EdgeP(graph()->parse()->makeEdge(this, node));
+  auto edge = graph()->parse()->makeEdge(this, node);
 
   addEdge(edge);
 
-  for (const auto &pn : graph()->nodeAttributes())
-    edge->setAttribute(pn.first, pn.second);
-
   graph_->addEdge(edge);
 
-  if (node->graph_ != graph_)
-    graph_->addEdge(edge);
-
   return edge;
 }
 
@@ -1320,7 +1340,7 @@ print(std::ostream &os) const
 
     bool first = true;
 
-    for (const auto &pn : attributes()) {
+    for (const auto &pn : attributes().nameValues()) {
       if (! first)
         os << ",";
 
@@ -1363,9 +1383,9 @@ attributesCSVStr() const
 
   bool first = true;
 
-  for (const auto &pn : attributes()) {
-    auto name  = pn.first;
-    auto value = pn.second;
+  for (const auto &pn : attributes().nameValues()) {
+    auto name  = std::string(pn.first);
+    auto value = std::string(pn.second);
 
     if      (name == "shape") {
     }
@@ -1408,6 +1428,103 @@ attributesCSVStr() const
 
 //---
 
+Attributes::NameValueArray
+Attributes::
+nameValues() const
+{
+  NameValueArray nameValues;
+
+  // add local values then inherited values not overridden
+  std::vector<Id> names;
+
+  for (auto *attributes = this; attributes; attributes = attributes->parent_) {
+    for (const auto &nv : attributes->nameValues_) {
+      if (std::find(names.begin(), names.end(), nv.name) != names.end())
+        continue;
+
+      names.push_back(nv.name);
+
+      nameValues.emplace_back(strings_->str(nv.name), strings_->str(nv.value));
+    }
+  }
+
+  std::sort(nameValues.begin(), nameValues.end(),
+            [](const NameValue &nv1, const NameValue &nv2) { return nv1.first < nv2.first; });
+
+  return nameValues;
+}
+
+void
+Attributes::
+setNameValue(std::string_view name, std::string_view value)
+{
+  auto nameId  = strings_->intern(name);
+  auto valueId = strings_->intern(value);
+
+  auto p = std::lower_bound(nameValues_.begin(), nameValues_.end(), nameId,
+             [](const IdValue &nv, Id id) { return nv.name < id; });
+
+  if (p != nameValues_.end() && (*p).name == nameId)
+    (*p).value = valueId;
+  else
+    nameValues_.insert(p, IdValue { nameId, valueId });
+}
+
+bool
+Attributes::
+findValue(Id name, Id &value) const
+{
+  for (auto *attributes = this; attributes; attributes = attributes->parent_) {
+    const auto &nameValues = attributes->nameValues_;
+
+    auto p = std::lower_bound(nameValues.begin(), nameValues.end(), name,
+               [](const IdValue &nv, Id id) { return nv.name < id; });
+
+    if (p != nameValues.end() && (*p).name == name) {
+      value = (*p).value;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+//---
+
+StringTable::Id
+StringTable::
+intern(std::string_view str)
+{
+  auto p = ids_.find(str);
+
+  if (p != ids_.end())
+    return (*p).second;
+
+  auto id = Id(strings_.size());
+
+  strings_.emplace_back(str);
+
+  ids_.emplace(std::string_view(strings_.back()), id);
+
+  return id;
+}
+
+bool
+StringTable::
+find(std::string_view str, Id &id) const
+{
+  auto p = ids_.find(str);
+
+  if (p == ids_.end())
+    return false;
+
+  id = (*p).second;
+
+  return true;
+}
+
+//---
+
 namespace Util {
 
 double stringToReal(const std::string &s, bool &ok) {
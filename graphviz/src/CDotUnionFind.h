@@ -0,0 +1,84 @@
+#ifndef CDotUnionFind_H
+#define CDotUnionFind_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+namespace CDotParse {
+
+// disjoint set forest over dense indices (path compression + union by rank)
+class UnionFind {
+ public:
+  using Index = uint32_t;
+
+ public:
+  UnionFind(Index n=0) { reset(n); }
+
+  void reset(Index n) {
+    parent_.resize(n);
+    rank_  .assign(n, 0);
+
+    for (Index i = 0; i < n; ++i)
+      parent_[i] = i;
+
+    numSets_ = n;
+  }
+
+  Index size() const { return Index(parent_.size()); }
+
+  //! number of disjoint sets
+  Index numSets() const { return numSets_; }
+
+  //! get set representative
+  Index find(Index i) {
+    Index root = i;
+
+    while (parent_[root] != root)
+      root = parent_[root];
+
+    // compress path
+    while (parent_[i] != root) {
+      Index next = parent_[i];
+
+      parent_[i] = root;
+
+      i = next;
+    }
+
+    return root;
+  }
+
+  //! merge sets (returns false if already in same set)
+  bool unite(Index i, Index j) {
+    i = find(i);
+    j = find(j);
+
+    if (i == j)
+      return false;
+
+    if (rank_[i] < rank_[j])
+      std::swap(i, j);
+
+    parent_[j] = i;
+
+    if (rank_[i] == rank_[j])
+      ++rank_[i];
+
+    --numSets_;
+
+    return true;
+  }
+
+ private:
+  using Indices = std::vector<Index>;
+  using Ranks   = std::vector<uint8_t>;
+
+  Indices parent_;
+  Ranks   rank_;
+  Index   numSets_ { 0 };
+};
+
+}
+
+#endif
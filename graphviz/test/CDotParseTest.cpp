@@ -9,7 +9,11 @@ main(int argc, char **argv)
   bool        print      = false;
   bool        csv        = false;
   bool        mst        = false;
+  bool        prim       = false;
   bool        sub_graphs = false;
+  std::string pathFrom, pathTo, costName;
+
+  auto pathType = CDotParse::Graph::PathType::HOPS;
 
   for (auto i = 1; i < argc; ++i) {
     if (argv[i][0] == '-') {
@@ -23,10 +27,23 @@ main(int argc, char **argv)
         csv = true;
       else if (arg == "mst")
         mst = true;
+      else if (arg == "prim")
+        prim = true;
       else if (arg == "sub_graphs")
         sub_graphs = true;
+      else if (arg == "path" && i + 2 < argc) {
+        pathFrom = argv[++i];
+        pathTo   = argv[++i];
+      }
+      else if (arg == "dijkstra")
+        pathType = CDotParse::Graph::PathType::DIJKSTRA;
+      else if (arg == "astar")
+        pathType = CDotParse::Graph::PathType::ASTAR;
+      else if (arg == "cost" && i + 1 < argc)
+        costName = argv[++i];
       else if (arg == "h") {
-        std::cerr << "CDotParseTest [-debug] [-print] [-csv] [-mst] [-sub_graphs] <file>\n";
+        std::cerr << "CDotParseTest [-debug] [-print] [-csv] [-mst [-prim]] [-sub_graphs] "
+                     "[-path <from> <to> [-dijkstra|-astar] [-cost <name>]] <file>\n";
         exit(1);
       }
       else
@@ -56,9 +73,15 @@ main(int argc, char **argv)
     std::cerr << "Minimum Spaning Tree\n";
 
     for (const auto &ng : parse.graphs()) {
-      auto graph = ng.second->minimumSpaningTree();
+      // release each tree once output (owned by parse arena)
+      auto mark = parse.arenaMark();
+
+      auto graph = ng.second->minimumSpaningTree(prim ? CDotParse::Graph::MSTType::PRIM :
+                                                        CDotParse::Graph::MSTType::KRUSKAL);
 
       std::cout << *graph << "\n";
+
+      parse.releaseArena(mark);
     }
   }
 
@@ -66,6 +89,8 @@ main(int argc, char **argv)
     std::cerr << "Sub Graphs\n";
 
     for (const auto &ng : parse.graphs()) {
+      auto mark = parse.arenaMark();
+
       auto subGraphs = ng.second->subGraphs();
 
       for (const auto &subGraph : subGraphs) {
@@ -74,7 +99,28 @@ main(int argc, char **argv)
         for (const auto &edge : subGraph->edges())
           std::cout << " " << *edge << "\n";
       }
+
+      parse.releaseArena(mark);
+    }
+  }
+
+  if (pathFrom != "") {
+    std::cerr << "Shortest Path\n";
+
+    auto *graph = parse.currentGraph();
+
+    auto fromNode = graph->getNode(pathFrom);
+    auto toNode   = graph->getNode(pathTo);
+
+    if (! fromNode || ! toNode) {
+      std::cerr << "Invalid path nodes\n";
+      exit(1);
     }
+
+    auto nodes = graph->shortestPath(fromNode, toNode, pathType, costName);
+
+    for (const auto &node : nodes)
+      std::cout << " " << node->name() << "\n";
   }
 
   exit(0);
@@ -1,13 +1,18 @@
 #ifndef CQGraphViz_H
 #define CQGraphViz_H
 
+#include <CQGraphVizSpatialIndex.h>
+#include <CQGraphVizSceneCache.h>
+
 #include <QPainterPath>
+#include <QHash>
 #include <QRectF>
 #include <QPointF>
 #include <QColor>
 
 #include <vector>
 #include <set>
+#include <unordered_map>
 #include <memory>
 
 namespace CQGraphViz {
@@ -29,10 +34,32 @@ class App {
   bool processJson(const std::string &filename);
   bool processDot (const std::string &filename);
 
-  Object *findObject(int id);
-  Object *findObject(const QString &name);
+  Object *findObject(int id) const;
+  Object *findObject(const QString &name) const;
+
+  //! get window rect of object (rect, or pos/edge end points if no drawn shape)
+  QRectF objectRect(const Object *object) const;
+
+  //! get window rect of object including its texts
+  QRectF objectDrawRect(const Object *object) const;
 
  private:
+  friend class DrawBuilder;
+  friend class JsonLoader;
+  friend class SceneCache;
+
+  //! add object (id and name must be set) and index by id/name
+  void addObject(const ObjectP &object);
+
+  //! build spatial index of loaded objects and edges
+  void buildSpatialIndex();
+
+  //! load scene from cache for file (if cache dir set, App empty and cache up to date)
+  bool loadSceneCache(const std::string &filename, SceneCache::Format format);
+
+  //! save scene to cache for file (if cache dir set)
+  void saveSceneCache(const std::string &filename, SceneCache::Format format);
+
   void errorMsg(const std::string &str) const;
 //void debugMsg(const std::string &str) const;
 
@@ -60,6 +87,9 @@ class App {
 
   const Edges &edges() const { return edges_; }
 
+  //! spatial index of objects and edges (by draw rect)
+  const SpatialIndex &spatialIndex() const { return spatialIndex_; }
+
   bool isDirected() const { return directed_; }
 
   //---
@@ -70,14 +100,25 @@ class App {
   bool isDebug() const { return debug_; }
   void setDebug(bool b) { debug_ = b; }
 
+  //! directory for binary scene cache files (empty for no cache)
+  const std::string &cacheDir() const { return cacheDir_; }
+  void setCacheDir(const std::string &dir) { cacheDir_ = dir; }
+
  private:
-  QRectF  bbox_;
-  ObjectP root_;
-  Objects objects_;
-  Edges   edges_;
-  bool    directed_ { false };
-  double  fontSize_ { -1 };
-  bool    debug_    { false };
+  using IdObjects   = std::unordered_map<int, Object *>;
+  using NameObjects = QHash<QString, Object *>;
+
+  QRectF       bbox_;
+  ObjectP      root_;
+  Objects      objects_;
+  IdObjects    idObjects_;
+  NameObjects  nameObjects_;
+  Edges        edges_;
+  SpatialIndex spatialIndex_;
+  bool         directed_ { false };
+  double       fontSize_ { -1 };
+  bool         debug_    { false };
+  std::string  cacheDir_;
 };
 
 //---
@@ -101,13 +142,11 @@ struct PathData {
   QColor       fg;
   StyleData    style;
 
-  void closePath() const {
+  void closePath() {
     if (! closed) {
-      auto *th = const_cast<PathData *>(this);
-
-      th->path.closeSubpath();
+      path.closeSubpath();
 
-      th->closed = true;
+      closed = true;
     }
   }
 };
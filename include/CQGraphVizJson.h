@@ -0,0 +1,126 @@
+#ifndef CQGraphVizJson_H
+#define CQGraphVizJson_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdio>
+
+namespace CQGraphViz {
+
+/*!
+ * SAX style callbacks for JsonReader.
+ *
+ * String and key views are only valid for the duration of the call.
+ * Return false from any callback to stop the parse.
+ */
+class JsonHandler {
+ public:
+  JsonHandler() { }
+
+  virtual ~JsonHandler() { }
+
+  virtual bool startObject() = 0;
+  virtual bool endObject  () = 0;
+
+  virtual bool startArray() = 0;
+  virtual bool endArray  () = 0;
+
+  virtual bool key(std::string_view name) = 0;
+
+  virtual bool stringValue (std::string_view str) = 0;
+  virtual bool numberValue (double r) = 0;
+  virtual bool booleanValue(bool b) = 0;
+  virtual bool nullValue   () = 0;
+};
+
+//---
+
+/*!
+ * Streaming JSON reader.
+ *
+ * The file is read in fixed size chunks and parse events are passed directly to
+ * the handler so no document tree is built.
+ */
+class JsonReader {
+ public:
+  JsonReader(size_t bufferSize=64*1024);
+
+ ~JsonReader();
+
+  JsonReader(const JsonReader &) = delete;
+  JsonReader &operator=(const JsonReader &) = delete;
+
+  //! parse file (returns false on syntax error, read error or handler abort)
+  bool parseFile(const std::string &filename, JsonHandler &handler);
+
+  //! error message for failed parse
+  const std::string &errorMsg() const { return errorMsg_; }
+
+  //! line number of last read character
+  int lineNum() const { return lineNum_; }
+
+ private:
+  enum class State {
+    VALUE,
+    FIRST_VALUE,
+    FIRST_KEY,
+    KEY,
+    AFTER_VALUE
+  };
+
+  bool parse(JsonHandler &handler);
+
+  bool parseValue(int c, JsonHandler &handler);
+
+  bool readString();
+  bool readNumber(int c, double &r);
+  bool readLiteral(const char *str);
+
+  bool readHex(unsigned int &code);
+
+  void addUtf8(unsigned int code);
+
+  int skipSpace();
+
+  int peekChar() {
+    if (pos_ >= len_ && ! fill())
+      return EOF;
+
+    return static_cast<unsigned char>(buffer_[pos_]);
+  }
+
+  int getChar() {
+    if (pos_ >= len_ && ! fill())
+      return EOF;
+
+    char c = buffer_[pos_++];
+
+    if (c == '\n')
+      ++lineNum_;
+
+    return static_cast<unsigned char>(c);
+  }
+
+  bool fill();
+
+  bool error(const std::string &msg);
+
+ private:
+  using Buffer = std::vector<char>;
+  using Stack  = std::vector<char>;
+
+  FILE*       fp_      { nullptr };
+  Buffer      buffer_;
+  size_t      pos_     { 0 };
+  size_t      len_     { 0 };
+  int         lineNum_ { 1 };
+  Stack       stack_;    // open containers ('{' or '[')
+  State       state_   { State::VALUE };
+  std::string str_;      // current string/key (reused)
+  std::string errorMsg_;
+};
+
+}
+
+#endif
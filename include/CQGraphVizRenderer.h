@@ -0,0 +1,188 @@
+#ifndef CQGraphVizRenderer_H
+#define CQGraphVizRenderer_H
+
+#include <QTransform>
+#include <QFont>
+#include <QHash>
+#include <QRectF>
+#include <QMutex>
+
+#include <list>
+#include <vector>
+
+class QPainter;
+
+namespace CQGraphViz {
+
+class App;
+class Object;
+struct StyleData;
+
+/*!
+ * Cache of fonts scaled from a base font so text fits a pixel size.
+ *
+ * Entries are keyed by base font, text and pixel size so one cache can be shared by
+ * renderers using different base fonts. The cache holds at most maxSize entries,
+ * dropping the least recently used.
+ *
+ * Lookups and inserts are locked so one cache can be shared by renderers in
+ * several threads.
+ */
+class FitFontCache {
+ public:
+  struct FitFont {
+    QFont  font;
+    double dy { 0.0 }; // baseline offset from center
+  };
+
+ public:
+  FitFontCache(const QFont &font=QFont());
+
+  FitFontCache(const FitFontCache &) = delete;
+  FitFontCache &operator=(const FitFontCache &) = delete;
+
+  //! default base font
+  QFont font() const;
+  void setFont(const QFont &f);
+
+  //! max number of entries
+  int maxSize() const;
+  void setMaxSize(int n);
+
+  int size() const;
+
+  void clear();
+
+  //! get default or specified base font scaled so text fits pixel size (bucketed by
+  //! whole pixels)
+  FitFont fitFont(const QSizeF &size, const QString &text);
+  FitFont fitFont(const QFont &font, const QSizeF &size, const QString &text);
+
+ private:
+  struct FitFontKey {
+    QFont   font;
+    QString text;
+    int     w { 0 };
+    int     h { 0 };
+
+    FitFontKey(const QFont &font, const QString &text, int w, int h) :
+     font(font), text(text), w(w), h(h) {
+    }
+
+    bool operator==(const FitFontKey &rhs) const {
+      return (w == rhs.w && h == rhs.h && text == rhs.text && font == rhs.font);
+    }
+
+    friend uint qHash(const FitFontKey &key, uint seed=0) {
+      return qHash(key.font, seed) ^ qHash(key.text, seed) ^ (uint(key.w)*31u + uint(key.h));
+    }
+  };
+
+  // keys in use order (most recent first)
+  using UseList = std::list<FitFontKey>;
+
+  struct FitFontEntry {
+    FitFont           fitFont;
+    UseList::iterator use;
+  };
+
+  using FitFonts = QHash<FitFontKey, FitFontEntry>;
+
+  // lookups reorder the use list so all access is exclusive
+  mutable QMutex lock_;
+  QFont          font_;
+  int            maxSize_ { 10000 };
+  FitFonts       fitFonts_;
+  UseList        useList_;
+};
+
+//---
+
+/*!
+ * Draws the objects of an App to a QPainter (so any QPaintDevice).
+ *
+ * The window to pixel mapping is given by a transform and only objects overlapping
+ * the drawn pixel rect are drawn (using the App spatial index). Small texts, nodes
+ * and curves are simplified (level of detail) using the pixel thresholds.
+ *
+ * The renderer only reads the App so separate renderers can draw the same App from
+ * different threads (highlight must be off as it reads the object inside state).
+ */
+class Renderer {
+ public:
+  using ObjectArray = std::vector<Object *>;
+
+ public:
+  Renderer(const App *app);
+
+  const App *app() const { return app_; }
+
+  //! window to pixel transform
+  const QTransform &transform() const { return transform_; }
+  void setTransform(const QTransform &t);
+
+  //! base font for labels and fitted texts
+  const QFont &font() const { return font_; }
+  void setFont(const QFont &f);
+
+  //! shared fitted font cache (used when its base font matches font, not owned)
+  FitFontCache *sharedFitFonts() const { return sharedFitFonts_; }
+  void setSharedFitFonts(FitFontCache *cache) { sharedFitFonts_ = cache; }
+
+  //! draw objects under mouse (inside state) highlighted
+  bool isHighlight() const { return highlight_; }
+  void setHighlight(bool b) { highlight_ = b; }
+
+  //! level of detail thresholds (pixels)
+  double minTextPixels() const { return minTextPixels_; }
+  void setMinTextPixels(double r) { minTextPixels_ = r; }
+
+  double minShapePixels() const { return minShapePixels_; }
+  void setMinShapePixels(double r) { minShapePixels_ = r; }
+
+  double minCurvePixels() const { return minCurvePixels_; }
+  void setMinCurvePixels(double r) { minCurvePixels_ = r; }
+
+  //! draw bbox background, root and all objects and edges overlapping pixel rect
+  void draw(QPainter *painter, const QRectF &pixelRect);
+
+  //! draw object shapes (paths and lines)
+  void drawObject(QPainter *painter, const Object *object);
+
+  //! draw object texts (or label if no texts)
+  void drawObjectText(QPainter *painter, const Object *object);
+
+  QPointF windowToPixel(const QPointF &p) const;
+  QRectF  windowToPixel(const QRectF &r) const;
+
+  double windowToPixelWidth (double w) const;
+  double windowToPixelHeight(double h) const;
+
+  //! equal scale transform fitting window rect into pixel size (y up, centered)
+  static QTransform fitTransform(const QRectF &rect, const QSizeF &size, double margin=0.0);
+
+ private:
+  //! get fitted font from shared (if base font matches) or own cache
+  FitFontCache::FitFont fitFontToRect(const QSizeF &size, const QString &text);
+
+  void setWindowLineStyle(QPainter *painter, const StyleData &style) const;
+
+  void setPixelLineWidth(QPainter *painter, double pw) const;
+
+ private:
+  const App*    app_            { nullptr };
+  QTransform    transform_;
+  double        scale_          { 1.0 };     // pixels per window unit
+  QFont         font_;
+  bool          highlight_      { true };
+  double        minTextPixels_  { 4.0 };     // hide text below this pixel height
+  double        minShapePixels_ { 3.0 };     // fill node rect below this pixel size
+  double        minCurvePixels_ { 8.0 };     // draw curve as line below this pixel size
+  FitFontCache  fitFonts_;                   // own fitted fonts (cleared on scale change)
+  FitFontCache* sharedFitFonts_ { nullptr }; // shared fitted fonts
+  ObjectArray   visibleObjects_;
+};
+
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef CQGraphVizSceneCache_H
+#define CQGraphVizSceneCache_H
+
+#include <string>
+#include <cstdint>
+
+namespace CQGraphViz {
+
+class App;
+
+/*!
+ * Binary cache of a decoded App scene (objects, edges, paths, texts, bbox and edge
+ * adjacency) so a file can be reopened without parsing it.
+ *
+ * The cache file is a header and a table of sections, each a flat array of fixed
+ * size records (paths are flat element arrays, strings are a shared table). It is
+ * memory mapped on load and only used if the stored source path, modification time,
+ * size and format match the source file.
+ */
+class SceneCache {
+ public:
+  //! source format (cache of same file parsed differently is not used)
+  enum class Format : uint32_t {
+    JSON = 1,
+    DOT  = 2
+  };
+
+ public:
+  SceneCache(App *app);
+
+  //! cache file name for source file in cache directory
+  static std::string cacheFilename(const std::string &dir, const std::string &filename);
+
+  //! load scene from cache file into (empty) App if cache is valid for source file
+  bool load(const std::string &cacheFile, const std::string &filename, Format format);
+
+  //! save App scene to cache file (keyed by source file)
+  bool save(const std::string &cacheFile, const std::string &filename, Format format) const;
+
+  //! error for failed load/save (empty if cache missing or stale)
+  const std::string &errorMsg() const { return errorMsg_; }
+
+ private:
+  bool error(const std::string &msg) const;
+
+ private:
+  App*                app_ { nullptr };
+  mutable std::string errorMsg_;
+};
+
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef CQGraphVizSpatialIndex_H
+#define CQGraphVizSpatialIndex_H
+
+#include <QRectF>
+#include <QPointF>
+
+#include <vector>
+#include <cstdint>
+
+namespace CQGraphViz {
+
+class Object;
+
+/*!
+ * Hierarchical grid over object rectangles (window coordinates) for point and rect queries.
+ *
+ * Built once after load. Level 0 has about one cell per object and each coarser level
+ * halves the cell counts down to a single cell. Each object is stored only in the finest
+ * level where its rect spans at most two cells in each direction, so large objects (e.g.
+ * long edges of radial layouts) are listed in a few coarse cells rather than in many
+ * fine ones and memory stays O(objects). Queries check the covered cells of each level.
+ *
+ * Cells are stored compactly as offsets into a single item index array per level. Query
+ * results are returned in object insertion order. Queries are const and do not share
+ * state so can be made from several threads.
+ */
+class SpatialIndex {
+ public:
+  using ObjectArray = std::vector<Object *>;
+
+ public:
+  SpatialIndex() { }
+
+  void clear();
+
+  //! add object with rect (call build when all added)
+  void add(Object *object, const QRectF &rect);
+
+  //! build grid for added objects
+  void build();
+
+  bool empty() const { return items_.empty(); }
+
+  //! bounding rect of all objects
+  const QRectF &bbox() const { return bbox_; }
+
+  //! objects whose rect contains point
+  void objectsAt(const QPointF &p, ObjectArray &objects) const;
+
+  //! objects whose rect overlaps rect
+  void objectsIn(const QRectF &rect, ObjectArray &objects) const;
+
+ private:
+  struct Item {
+    Object* object { nullptr };
+    QRectF  rect;
+  };
+
+  using Items   = std::vector<Item>;
+  using Indices = std::vector<uint32_t>;
+
+  struct Level {
+    int     nx         { 0 };
+    int     ny         { 0 };
+    double  cellWidth  { 1.0 };
+    double  cellHeight { 1.0 };
+    Indices cellOffsets;          // nx*ny + 1 offsets into cellItems
+    Indices cellItems;            // item indices (ascending per cell)
+  };
+
+  using Levels = std::vector<Level>;
+
+  bool cellRange(const Level &level, const QRectF &rect,
+                 int &ix1, int &iy1, int &ix2, int &iy2) const;
+
+  int cellX(const Level &level, double x) const;
+  int cellY(const Level &level, double y) const;
+
+ private:
+  Items  items_;
+  QRectF bbox_;
+  Levels levels_;                 // finest (0) to single cell
+};
+
+}
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef CQGraphVizTileRenderer_H
+#define CQGraphVizTileRenderer_H
+
+#include <CQGraphVizRenderer.h>
+
+#include <QObject>
+#include <QThreadPool>
+#include <QTransform>
+#include <QImage>
+#include <QFont>
+#include <QHash>
+
+#include <set>
+#include <algorithm>
+
+class QPainter;
+
+namespace CQGraphViz {
+
+class App;
+
+/*!
+ * Renders an App into fixed size QImage tiles on a thread pool.
+ *
+ * Tiles are on a grid in scaled (untranslated) pixel coordinates so panning
+ * reuses cached tiles and only zoom (or font) changes need a new set. Missing
+ * tiles are queued to the pool and tilesReady is emitted (in the owning thread)
+ * as they complete. Until then tiles from the previous scale are drawn scaled.
+ *
+ * The App must not be changed while tiles are rendering (call clear first).
+ */
+class TileRenderer : public QObject {
+  Q_OBJECT
+
+ public:
+  TileRenderer(const App *app, QObject *parent=nullptr);
+
+ ~TileRenderer();
+
+  //! tile size (pixels)
+  int tileSize() const { return tileSize_; }
+  void setTileSize(int i);
+
+  //! maximum number of cached tiles
+  int maxTiles() const { return maxTiles_; }
+  void setMaxTiles(int i) { maxTiles_ = std::max(i, 1); }
+
+  //! base font for texts
+  const QFont &font() const { return font_; }
+  void setFont(const QFont &f);
+
+  //! wait for running tiles and drop all cached tiles (call before App is changed)
+  void clear();
+
+  //! draw cached tiles covering pixel rect (for window to pixel transform) and
+  //! queue render of missing tiles
+  void draw(QPainter *painter, const QTransform &transform, const QRect &pixelRect);
+
+ signals:
+  void tilesReady();
+
+ private:
+  struct TileKey {
+    int ix { 0 };
+    int iy { 0 };
+
+    TileKey(int ix, int iy) :
+     ix(ix), iy(iy) {
+    }
+
+    bool operator==(const TileKey &rhs) const {
+      return (ix == rhs.ix && iy == rhs.iy);
+    }
+
+    bool operator<(const TileKey &rhs) const {
+      return (iy < rhs.iy || (iy == rhs.iy && ix < rhs.ix));
+    }
+
+    friend uint qHash(const TileKey &key, uint seed=0) {
+      return (uint(key.ix)*73856093u ^ uint(key.iy)*19349663u) ^ seed;
+    }
+  };
+
+  struct Tile {
+    QImage image;
+    uint   used { 0 }; // last draw (for eviction)
+  };
+
+  using Tiles   = QHash<TileKey, Tile>;
+  using TileSet = std::set<TileKey>;
+
+  //! start new tile set for scale (keep current as fallback)
+  void setScale(const QTransform &scale);
+
+  void queueTile(const TileKey &key);
+
+  void tileDone(int generation, const TileKey &key, const QImage &image);
+
+  void evictTiles();
+
+  //! drawn pixel rect of scene (in scaled pixel coordinates)
+  QRectF sceneRect() const;
+
+ private:
+  class TileJob;
+
+  const App*   app_        { nullptr };
+  QThreadPool  pool_;
+  int          tileSize_   { 256 };
+  int          maxTiles_   { 256 };
+  QFont        font_;
+  FitFontCache fitFonts_;               // fitted fonts shared by tile jobs
+  QTransform   scale_;                  // current window to scaled pixel (no translate)
+  bool         scaleSet_   { false };
+  int          generation_ { 0 };       // incremented for new scale/font/tile size
+  uint         used_       { 0 };
+  Tiles        tiles_;                  // tiles for current scale
+  TileSet      pending_;                // tiles queued for current scale
+  QTransform   oldScale_;               // previous scale (fallback tiles)
+  Tiles        oldTiles_;               // tiles for previous scale
+};
+
+}
+
+#endif
@@ -1,6 +1,8 @@
 #include <CQGraph.h>
 #include <CDotParse.h>
+#include <CDotCSRGraph.h>
 #include <CForceDirected.h>
+#include <CQGraphMultilevelLayout.h>
 #include <CirclePack.h>
 #include <CGraphPlacer.h>
 #include <CDisplayRange2D.h>
@@ -8,10 +10,17 @@
 #include <QApplication>
 #include <QVBoxLayout>
 #include <QPainter>
-#include <QTimer>
+#include <QElapsedTimer>
 #include <QMouseEvent>
+#include <QKeyEvent>
 
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include <map>
+#include <random>
+#include <unordered_map>
 
 class CForceDirectedDotNode : public CDotParse::Node  {
  public:
@@ -306,17 +315,17 @@ class CQGraphDotParse : public CDotParse::Parse {
   // make dot node
   CDotParse::Node *makeNode(CDotParse::Graph *graph, const std::string &name) const override {
     if      (graph_->packType() == CQGraph::PackType::FORCE_DIRECTED) {
-      auto *node = new CForceDirectedDotNode(graph->parse(), name);
+      auto *node = create<CForceDirectedDotNode>(graph->parse(), name);
 
       return node;
     }
     else if (graph_->packType() == CQGraph::PackType::CIRCLE_PACK) {
-      auto *node = new CirclePackNode(graph_->parse(), name);
+      auto *node = create<CirclePackNode>(graph_->parse(), name);
 
       return dynamic_cast<CDotParse::Node *>(node);
     }
     else if (graph_->packType() == CQGraph::PackType::GRAPH_PLACER) {
-      auto *node = new GraphPlacerDotNode(graph, name);
+      auto *node = create<GraphPlacerDotNode>(graph, name);
 
       return node;
     }
@@ -327,7 +336,7 @@ class CQGraphDotParse : public CDotParse::Parse {
   // make dot edge
   CDotParse::Edge *makeEdge(CDotParse::Node *node1, CDotParse::Node *node2) const override {
     if      (graph_->packType() == CQGraph::PackType::FORCE_DIRECTED) {
-      auto *edge = new CForceDirectedDotEdge(node1, node2);
+      auto *edge = create<CForceDirectedDotEdge>(node1, node2);
 
       return edge;
     }
@@ -335,7 +344,7 @@ class CQGraphDotParse : public CDotParse::Parse {
       return CDotParse::Parse::makeEdge(node1, node2);
     }
     else if (graph_->packType() == CQGraph::PackType::GRAPH_PLACER) {
-      auto *edge = new GraphPlacerDotEdge(node1, node2);
+      auto *edge = create<GraphPlacerDotEdge>(node1, node2);
 
       return edge;
     }
@@ -382,27 +391,165 @@ GraphPlacerEdge(CQGraph *graph, CGraphPlacer::OptReal value, GraphPlacerNode *sr
 
 //---
 
+namespace {
+
+// compare exact and Barnes-Hut force layout steps/sec on random connected graph
+void
+benchmarkForceLayout(int numNodes, int numSteps, double theta)
+{
+  std::mt19937 rng(1);
+
+  std::uniform_real_distribution<double> pos(-5.0, 5.0);
+
+  CQGraphForceLayout layout;
+
+  for (int i = 0; i < numNodes; ++i)
+    layout.addPoint(pos(rng), pos(rng));
+
+  // random spanning tree plus extra edges
+  for (int i = 1; i < numNodes; ++i)
+    layout.addSpring(i, int(rng() % i));
+
+  for (int i = 0; i < numNodes/2; ++i)
+    layout.addSpring(int(rng() % numNodes), int(rng() % numNodes));
+
+  //---
+
+  auto runSteps = [&](const CQGraphForceLayout::Repulsion &repulsion, CQGraphForceLayout &l,
+                      bool simd=true) {
+    l.setRepulsionType(repulsion);
+    l.setTheta        (theta);
+    l.setSimd         (simd);
+
+    auto t1 = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < numSteps; ++i)
+      l.step(0.01);
+
+    auto t2 = std::chrono::steady_clock::now();
+
+    return numSteps/std::max(std::chrono::duration<double>(t2 - t1).count(), 1E-9);
+  };
+
+  auto exactLayout  = layout;
+  auto scalarLayout = layout;
+  auto bhLayout     = layout;
+
+  double exactRate  = runSteps(CQGraphForceLayout::Repulsion::EXACT     , exactLayout);
+  double scalarRate = (CQGraphForceLayout::isSimdAvailable() ?
+    runSteps(CQGraphForceLayout::Repulsion::EXACT, scalarLayout, /*simd*/false) : exactRate);
+  double bhRate     = runSteps(CQGraphForceLayout::Repulsion::BARNES_HUT, bhLayout    );
+
+  // approximation error : relative difference of one step's movement
+  auto exactStep = layout;
+  auto bhStep    = layout;
+
+  bhStep.setRepulsionType(CQGraphForceLayout::Repulsion::BARNES_HUT);
+  bhStep.setTheta        (theta);
+
+  exactStep.step(0.01);
+  bhStep   .step(0.01);
+
+  double errSum = 0.0, moveSum = 0.0;
+
+  for (int i = 0; i < numNodes; ++i) {
+    double ex = exactStep.x(i) - layout.x(i), ey = exactStep.y(i) - layout.y(i);
+    double bx = bhStep   .x(i) - layout.x(i), by = bhStep   .y(i) - layout.y(i);
+
+    errSum  += std::hypot(bx - ex, by - ey);
+    moveSum += std::hypot(ex, ey);
+  }
+
+  std::cerr << "Nodes " << numNodes << ", Springs " << layout.numSprings() <<
+               ", Steps " << numSteps << "\n";
+  std::cerr << "Exact      : " << exactRate << " steps/sec" <<
+               (CQGraphForceLayout::isSimdAvailable() ? " (AVX2)" : "") << "\n";
+  if (CQGraphForceLayout::isSimdAvailable())
+    std::cerr << "Scalar     : " << scalarRate << " steps/sec\n";
+  std::cerr << "Barnes-Hut : " << bhRate << " steps/sec (theta " << theta << ")\n";
+  std::cerr << "Speedup    : " << bhRate/std::max(exactRate, 1E-9) << "\n";
+  std::cerr << "Step error : " << errSum/std::max(moveSum, 1E-9) << "\n";
+}
+
+}
+
+//---
+
 int
 main(int argc, char **argv)
 {
   QApplication app(argc, argv);
 
-  std::vector<std::string> args;
-  CQGraph::PackType        packType = CQGraph::PackType::FORCE_DIRECTED;
-  int                      debug    = false;
+  std::vector<std::string>       args;
+  CQGraph::PackType              packType       = CQGraph::PackType::FORCE_DIRECTED;
+  CQGraphForceDirectedParameters forceParameters;
+  int                            benchmarkNodes = 0;
+  int                            benchmarkSteps = 10;
+  bool                           repulsionSet   = false;
+  int                            debug          = false;
 
   for (int i = 1; i < argc; ++i) {
     if   (argv[i][0] == '-') {
       auto arg = std::string(&argv[i][1]);
 
       if      (arg == "h")
-        std::cerr << "Usage: CQGraph [-debug] [-h]\n";
+        std::cerr << "Usage: CQGraph [-force_directed|-multilevel|-circle|-graph] "
+                     "[-exact|-barnes_hut] [-theta <r>] "
+                     "[-energy_threshold <r>] [-displacement_threshold <r>] "
+                     "[-converged_steps <n>] "
+                     "[-benchmark <nodes>] [-benchmark_steps <n>] [-debug] [-h]\n";
       else if (arg == "force_directed")
         packType = CQGraph::PackType::FORCE_DIRECTED;
       else if (arg == "circle" || arg == "circle_pack")
         packType = CQGraph::PackType::CIRCLE_PACK;
       else if (arg == "graph" || arg == "graph_placer")
         packType = CQGraph::PackType::GRAPH_PLACER;
+      else if (arg == "multilevel")
+        packType = CQGraph::PackType::MULTILEVEL;
+      else if (arg == "exact") {
+        forceParameters.repulsionType = CQGraphForceLayout::Repulsion::EXACT;
+        repulsionSet                  = true;
+      }
+      else if (arg == "barnes_hut" || arg == "bh") {
+        forceParameters.repulsionType = CQGraphForceLayout::Repulsion::BARNES_HUT;
+        repulsionSet                  = true;
+      }
+      else if (arg == "theta") {
+        if (i + 1 < argc)
+          forceParameters.theta = std::max(std::atof(argv[++i]), 0.0);
+        else
+          std::cerr << "Missing value for '" << arg << "'\n";
+      }
+      else if (arg == "energy_threshold") {
+        if (i + 1 < argc)
+          forceParameters.energyThreshold = std::max(std::atof(argv[++i]), 0.0);
+        else
+          std::cerr << "Missing value for '" << arg << "'\n";
+      }
+      else if (arg == "displacement_threshold") {
+        if (i + 1 < argc)
+          forceParameters.displacementThreshold = std::max(std::atof(argv[++i]), 0.0);
+        else
+          std::cerr << "Missing value for '" << arg << "'\n";
+      }
+      else if (arg == "converged_steps") {
+        if (i + 1 < argc)
+          forceParameters.convergedSteps = std::max(std::atoi(argv[++i]), 1);
+        else
+          std::cerr << "Missing value for '" << arg << "'\n";
+      }
+      else if (arg == "benchmark") {
+        if (i + 1 < argc)
+          benchmarkNodes = std::atoi(argv[++i]);
+        else
+          std::cerr << "Missing value for '" << arg << "'\n";
+      }
+      else if (arg == "benchmark_steps") {
+        if (i + 1 < argc)
+          benchmarkSteps = std::max(std::atoi(argv[++i]), 1);
+        else
+          std::cerr << "Missing value for '" << arg << "'\n";
+      }
       else if (arg == "debug")
         debug = true;
     }
@@ -410,12 +557,23 @@ main(int argc, char **argv)
       args.push_back(argv[i]);
   }
 
+  if (benchmarkNodes > 0) {
+    benchmarkForceLayout(benchmarkNodes, benchmarkSteps, forceParameters.theta);
+    return 0;
+  }
+
+  // multilevel is for large graphs so continues with Barnes-Hut unless exact requested
+  if (packType == CQGraph::PackType::MULTILEVEL && ! repulsionSet)
+    forceParameters.repulsionType = CQGraphForceLayout::Repulsion::BARNES_HUT;
+
   auto graph = std::make_unique<CQGraph>();
 
   graph->setDebug(debug);
 
   graph->setPackType(packType);
 
+  graph->setForceParameters(forceParameters);
+
   //---
 
   for (const auto &arg : args)
@@ -447,6 +605,9 @@ CQGraph()
 CQGraph::
 ~CQGraph()
 {
+  // stop simulation before deleting it
+  delete forceDirectedThread_;
+
   delete parse_;
 
   delete forceDirected_;
@@ -459,6 +620,11 @@ void
 CQGraph::
 loadFile(const std::string &filename)
 {
+  // dot graphs/nodes are owned by the parse
+  minGraph_ = nullptr;
+
+  shortestPath_.clear();
+
   delete parse_;
 
   parse_ = new CQGraphDotParse(this, filename);
@@ -514,6 +680,9 @@ init()
 
     initGraphPlacer();
   }
+  else if (packType() == PackType::MULTILEVEL) {
+    initMultilevel();
+  }
 
   if (packType() == PackType::GRAPH_PLACER) {
     minGraph_ = parse_->currentGraph()->minimumSpaningTree();
@@ -523,7 +692,7 @@ init()
     if (minGraph_->nodes().size() > 1) {
       std::cerr << "Shortest Path\n";
 
-      CDotParse::NodeP minNode, maxNode;
+      CDotParse::NodeP minNode = nullptr, maxNode = nullptr;
 
       CGraphPlacerNode *minPNode = nullptr;
       CGraphPlacerNode *maxPNode = nullptr;
@@ -545,7 +714,7 @@ init()
       }
 
       if (minNode != maxNode) {
-        shortestPath_ = parse_->currentGraph()->shortestPath(minNode, maxNode);
+        shortestPath_ = minGraph_->shortestPath(minNode, maxNode);
 
 #if 0
         for (const auto &node : shortestPath_) {
@@ -559,6 +728,17 @@ init()
   }
 }
 
+void
+CQGraph::
+setForceParameters(const CQGraphForceDirectedParameters &parameters)
+{
+  forceParameters_ = parameters;
+
+  // running simulation applies them before its next step (restarting if converged)
+  if (forceDirectedThread_)
+    forceDirectedThread_->setParameters(forceParameters_);
+}
+
 void
 CQGraph::
 initForceDirected()
@@ -574,7 +754,7 @@ initForceDirected()
     for (const auto &nn : pgraph->nodes()) {
       auto node1 = nn.second;
 
-      auto *dnode1 = dynamic_cast<CForceDirectedDotNode *>(node1.get());
+      auto *dnode1 = dynamic_cast<CForceDirectedDotNode *>(node1);
 
       auto fnode1 = forceDirected->getNode(dnode1->id());
 
@@ -606,17 +786,64 @@ initForceDirected()
     }
   }
 
-  int    initSteps { 1000 };
-  double stepSize  { 0.01 };
+  // untangle and animate on worker thread, canvas redraws on each new snapshot
+  forceDirectedThread_ = new CQGraphForceDirectedThread(forceDirected, this);
+
+  forceDirectedThread_->setParameters(forceParameters());
+
+  connect(forceDirectedThread_, SIGNAL(snapshotReady()), canvas_, SLOT(update()));
+
+  forceDirectedThread_->start();
+}
+
+void
+CQGraph::
+initMultilevel()
+{
+  // dense node index and edges (node index pairs) of all parse graphs
+  std::vector<QString>                               nodeNames;
+  std::vector<CQGraphForceDirectedThread::EdgeNodes> edgeNodes;
+
+  std::unordered_map<const CDotParse::Node *, int> nodeIndex;
+
+  for (const auto &ng : parse_->graphs()) {
+    auto csr = ng.second->freeze();
+
+    // csr nodes include nodes in other graphs reached by out edges
+    std::vector<int> csrIndex(csr.numNodes());
+
+    for (CDotParse::CSRGraph::Index n = 0; n < csr.numNodes(); ++n) {
+      const auto *node = csr.node(n);
+
+      auto p = nodeIndex.find(node);
+
+      if (p == nodeIndex.end()) {
+        p = nodeIndex.emplace(node, int(nodeNames.size())).first;
+
+        nodeNames.push_back(QString::fromStdString(node->name()));
+      }
+
+      csrIndex[n] = p->second;
+    }
+
+    // out edges of graph's own nodes (others are added by their graph)
+    for (CDotParse::CSRGraph::Index e = 0; e < csr.numGraphEdges(); ++e)
+      edgeNodes.emplace_back(csrIndex[csr.edgeFrom(e)], csrIndex[csr.edgeTo(e)]);
+  }
+
+  //---
+
+  // coarsen, layout and refine on worker thread then continue as force directed
+  forceDirectedThread_ = new CQGraphForceDirectedThread(nodeNames, edgeNodes, this);
 
-  for (int i = 0; i < initSteps; ++i)
-    forceDirected->step(stepSize);
+  forceDirectedThread_->setMultilevel(true);
+  forceDirectedThread_->setInitSteps (0);
 
-  timer_ = new QTimer(this);
+  forceDirectedThread_->setParameters(forceParameters());
 
-  connect(timer_, SIGNAL(timeout()), this, SLOT(animate()));
+  connect(forceDirectedThread_, SIGNAL(snapshotReady()), canvas_, SLOT(update()));
 
-  timer_->start(250);
+  forceDirectedThread_->start();
 }
 
 void
@@ -631,7 +858,7 @@ initCirclePack()
     for (const auto &nn : pgraph->nodes()) {
       auto node = nn.second;
 
-      pack->addNode(dynamic_cast<CirclePackNode *>(node.get()));
+      pack->addNode(dynamic_cast<CirclePackNode *>(node));
     }
   }
 }
@@ -710,25 +937,297 @@ initGraphPlacer()
 //pgraph->print(std::cerr);
 }
 
+//------
+
+CQGraphForceDirectedThread::
+CQGraphForceDirectedThread(CForceDirectedMgr *forceDirected, QObject *parent) :
+ QThread(parent), forceDirected_(forceDirected)
+{
+  // layout point per node (dense node order) from library's initial point, and
+  // library point to node index for edges
+  std::map<const void *, int> pointNode;
+
+  for (auto &node : forceDirected_->nodes()) {
+    auto *snode = dynamic_cast<CForceDirectedSpringNode *>(node.get());
+
+    auto point = forceDirected_->point(node);
+
+    const auto &p = point->p();
+
+    pointNode[&*point] = layout_.addPoint(p.x(), p.y());
+
+    nodeNames_.push_back(QString::fromStdString(snode ? snode->name() : std::string()));
+  }
+
+  for (auto &edge : forceDirected_->edges()) {
+    bool isTemp = false;
+
+    auto spring = forceDirected_->spring(edge, isTemp);
+
+    auto p1 = pointNode.find(&*spring->point1());
+    auto p2 = pointNode.find(&*spring->point2());
+
+    if (p1 == pointNode.end() || p2 == pointNode.end())
+      continue;
+
+    layout_.addSpring(p1->second, p2->second);
+
+    edgeNodes_.push_back(EdgeNodes(p1->second, p2->second));
+  }
+
+  // initial positions so window can draw before first step
+  publish(0, false);
+
+  notifyPending_ = false;
+}
+
+CQGraphForceDirectedThread::
+CQGraphForceDirectedThread(const std::vector<QString> &nodeNames,
+                           const std::vector<EdgeNodes> &edgeNodes, QObject *parent) :
+ QThread(parent), nodeNames_(nodeNames), edgeNodes_(edgeNodes)
+{
+  // points at origin until laid out
+  int n = int(nodeNames_.size());
+
+  for (int i = 0; i < n; ++i)
+    layout_.addPoint(0.0, 0.0);
+
+  for (const auto &edge : edgeNodes_) {
+    if (edge.first >= 0 && edge.first < n && edge.second >= 0 && edge.second < n)
+      layout_.addSpring(edge.first, edge.second);
+  }
+
+  publish(0, false);
+
+  notifyPending_ = false;
+}
+
+CQGraphForceDirectedThread::
+~CQGraphForceDirectedThread()
+{
+  stop();
+}
+
+const CQGraphForceDirectedThread::Snapshot &
+CQGraphForceDirectedThread::
+snapshot()
+{
+  // clear before taking buffer so a publish after this is notified
+  notifyPending_ = false;
+
+  buffer_.update();
+
+  return buffer_.front();
+}
+
+CQGraphForceDirectedThread::Parameters
+CQGraphForceDirectedThread::
+parameters() const
+{
+  QMutexLocker locker(&mutex_);
+
+  return parameters_;
+}
+
 void
-CQGraph::
-animate()
+CQGraphForceDirectedThread::
+setParameters(const Parameters &parameters)
 {
-  if (! parse_)
-    return;
+  QMutexLocker locker(&mutex_);
 
-  assert(packType() == PackType::FORCE_DIRECTED);
+  parameters_        = parameters;
+  parametersChanged_ = true;
+  wake_              = true;
 
-  auto *forceDirected = forceDirected_;
-  if (! forceDirected) return;
+  wakeCond_.wakeAll();
+}
 
-  int    animateteps { 100 };
-  double stepSize    { 0.01 };
+void
+CQGraphForceDirectedThread::
+restart()
+{
+  QMutexLocker locker(&mutex_);
 
-  for (int i = 0; i < animateteps; ++i)
-    forceDirected->step(stepSize);
+  restart_ = true;
+  wake_    = true;
 
-  update();
+  wakeCond_.wakeAll();
+}
+
+void
+CQGraphForceDirectedThread::
+stop()
+{
+  {
+    QMutexLocker locker(&mutex_);
+
+    stopped_ = true;
+    wake_    = true;
+
+    wakeCond_.wakeAll();
+  }
+
+  wait();
+}
+
+void
+CQGraphForceDirectedThread::
+run()
+{
+  int  step           = 0;
+  int  convergedSteps = 0; // consecutive steps below thresholds
+  bool converged      = false;
+
+  Parameters parameters;
+
+  QElapsedTimer timer;
+
+  if (multilevel_)
+    runMultilevel(step);
+
+  while (! stopped_) {
+    // apply changed parameters and restart request (from GUI thread)
+    {
+      QMutexLocker locker(&mutex_);
+
+      if (parametersChanged_) {
+        parameters = parameters_;
+
+        layout_.setRepulsionType(parameters.repulsionType);
+        layout_.setTheta        (parameters.theta);
+
+        parametersChanged_ = false;
+        converged          = false;
+        convergedSteps     = 0;
+      }
+
+      if (restart_) {
+        restart_       = false;
+        converged      = false;
+        convergedSteps = 0;
+      }
+
+      // idle (no stepping or repaint) until woken by parameter change, restart or stop
+      if (converged) {
+        if (! wake_)
+          wakeCond_.wait(&mutex_);
+
+        wake_ = false;
+
+        continue;
+      }
+    }
+
+    //---
+
+    // untangle in batches (published so layout is shown as it progresses) then
+    // animate batches at fixed interval
+    bool untangle = (step < initSteps_);
+
+    int n = (untangle ? std::min(std::max(publishSteps_, 1), initSteps_ - step) :
+                        animateSteps_);
+
+    timer.start();
+
+    for (int i = 0; i < n && ! stopped_; ++i) {
+      layout_.step(stepSize_);
+
+      ++step;
+
+      // converged if below thresholds for enough steps (energy oscillates as layout
+      // rearranges so a single quiet step is not enough)
+      if (layout_.isConverged(parameters.energyThreshold, parameters.displacementThreshold))
+        ++convergedSteps;
+      else
+        convergedSteps = 0;
+
+      if (convergedSteps >= std::max(parameters.convergedSteps, 1)) {
+        converged = true;
+        break;
+      }
+    }
+
+    publish(step, converged);
+
+    if (! untangle && ! converged)
+      waitFor(animateInterval_ - int(timer.elapsed()));
+  }
+}
+
+void
+CQGraphForceDirectedThread::
+runMultilevel(int &step)
+{
+  CQGraphMultilevelLayout multilevel;
+
+  multilevel.setTheta   (parameters().theta);
+  multilevel.setStopFlag(&stopped_);
+
+  multilevel.setGraph(layout_.numPoints(), edgeNodes_);
+
+  multilevel.coarsen();
+
+  // publish coarsest layout and each refined level (nodes at their ancestor's position)
+  CQGraphMultilevelLayout::Reals x, y;
+
+  auto publishLevel = [&]() {
+    multilevel.positions(x, y);
+
+    for (int i = 0; i < layout_.numPoints(); ++i)
+      layout_.setPosition(i, x[i], y[i]);
+
+    step = multilevel.numSteps();
+
+    publish(step, false);
+  };
+
+  multilevel.layoutCoarsest();
+
+  publishLevel();
+
+  while (! stopped_ && multilevel.refine())
+    publishLevel();
+}
+
+void
+CQGraphForceDirectedThread::
+waitFor(int ms)
+{
+  QMutexLocker locker(&mutex_);
+
+  if (! wake_ && ms > 0)
+    wakeCond_.wait(&mutex_, ms);
+
+  wake_ = false;
+}
+
+void
+CQGraphForceDirectedThread::
+publish(int step, bool converged)
+{
+  auto &snapshot = buffer_.back();
+
+  int n = layout_.numPoints();
+
+  snapshot.points.resize(n);
+
+  for (int i = 0; i < n; ++i) {
+    snapshot.points[i].x = layout_.x(i);
+    snapshot.points[i].y = layout_.y(i);
+  }
+
+  layout_.calcRange(snapshot.xmin, snapshot.ymin, snapshot.xmax, snapshot.ymax);
+
+  snapshot.step      = step;
+  snapshot.energy    = layout_.stepEnergy();
+  snapshot.maxMove   = layout_.maxDisplacement();
+  snapshot.converged = converged;
+
+  buffer_.publish();
+
+  // only signal if last notification has been handled (snapshot read)
+  if (! notifyPending_.exchange(true))
+    emit snapshotReady();
 }
 
 //------
@@ -758,6 +1257,31 @@ mouseMoveEvent(QMouseEvent *me)
   graph_->status()->update();
 }
 
+void
+CQGraphCanvas::
+keyPressEvent(QKeyEvent *e)
+{
+  if (graph_->packType() != CQGraph::PackType::FORCE_DIRECTED &&
+      graph_->packType() != CQGraph::PackType::MULTILEVEL)
+    return;
+
+  auto *thread = graph_->forceDirectedThread();
+  if (! thread) return;
+
+  // B : toggle Barnes-Hut repulsion, R : restart converged simulation
+  if      (e->key() == Qt::Key_B) {
+    auto parameters = graph_->forceParameters();
+
+    parameters.repulsionType =
+      (parameters.repulsionType == CQGraphForceLayout::Repulsion::EXACT ?
+       CQGraphForceLayout::Repulsion::BARNES_HUT : CQGraphForceLayout::Repulsion::EXACT);
+
+    graph_->setForceParameters(parameters);
+  }
+  else if (e->key() == Qt::Key_R)
+    thread->restart();
+}
+
 void
 CQGraphCanvas::
 resizeEvent(QResizeEvent *)
@@ -792,33 +1316,53 @@ paintEvent(QPaintEvent *)
   else if (graph_->packType() == CQGraph::PackType::GRAPH_PLACER) {
     drawGraphPlacer(&painter);
   }
+  else if (graph_->packType() == CQGraph::PackType::MULTILEVEL) {
+    drawForceDirected(&painter);
+  }
 }
 
 void
 CQGraphCanvas::
 drawForceDirected(QPainter *painter)
 {
-  auto *forceDirected = graph_->forceDirected();
-  if (! forceDirected) return;
+  // only draws latest snapshot, simulation is owned by worker thread
+  auto *thread = graph_->forceDirectedThread();
+  if (! thread) return;
 
-  double xmin, ymin, xmax, ymax;
+  const auto &snapshot = thread->snapshot();
+
+  // status shows simulation step state
+  if (snapshot.step != drawnStep_) {
+    drawnStep_ = snapshot.step;
 
-  forceDirected->calcRange(xmin, ymin, xmax, ymax);
+    graph_->status()->update();
+  }
 
   double m = graph_->margin();
 
-  CDisplayRange2D range(m, m, width() - m, height() - m, xmin, ymin, xmax, ymax);
+  CDisplayRange2D range(m, m, width() - m, height() - m,
+                        snapshot.xmin, snapshot.ymin, snapshot.xmax, snapshot.ymax);
 
-  //std::cerr << xmin << " " << ymin << " " << xmax << " " << ymax << "\n";
+  //std::cerr << snapshot.xmin << " " << snapshot.ymin << " " <<
+  //             snapshot.xmax << " " << snapshot.ymax << "\n";
 
   double r = 32;
 
-  auto drawNode = [&](CForceDirectedSpringNode *node, const Springy::Vector &p) {
+  // node pixel positions
+  const auto &points = snapshot.points;
+
+  std::vector<QPointF> ppoints(points.size());
+
+  for (size_t i = 0; i < points.size(); ++i) {
     double px, py;
 
-    range.windowToPixel(p.x(), p.y(), &px, &py);
+    range.windowToPixel(points[i].x, points[i].y, &px, &py);
+
+    ppoints[i] = QPointF(px, py);
+  }
 
-    QRectF rect(px - r, py - r, 2*r, 2*r);
+  auto drawNode = [&](const QString &name, const QPointF &p) {
+    QRectF rect(p.x() - r, p.y() - r, 2*r, 2*r);
 
     painter->setPen  (Qt::NoPen);
     painter->setBrush(QColor(200, 200, 200));
@@ -827,7 +1371,7 @@ drawForceDirected(QPainter *painter)
 
     painter->setPen(Qt::black);
 
-    painter->drawText(rect, Qt::AlignCenter, QString::fromStdString(node->name()));
+    painter->drawText(rect, Qt::AlignCenter, name);
   };
 
   auto movePointOnLine = [](const QPointF &p1, const QPointF &p2, double d) {
@@ -848,62 +1392,18 @@ drawForceDirected(QPainter *painter)
     painter->drawLine(pp1, pp2);
   };
 
-#if 0
-  for (const auto &ng : parse_->graphs()) {
-    auto graph = ng.second;
-
-    for (const auto &nn : graph->nodes()) {
-      auto *node1 = dynamic_cast<CForceDirectedSpringNode *>(nn.second.get());
-
-      auto p1 = forceDirected->point(dynamic_cast<Springy::Node *>(node1))->p();
+  const auto &names = thread->nodeNames();
 
-      drawNode(node1, p1);
-
-      for (const auto &edge : node1->edges()) {
-        auto *node2 = dynamic_cast<CForceDirectedSpringNode *>(edge->toNode());
+  for (size_t i = 0; i < ppoints.size() && i < names.size(); ++i)
+    drawNode(names[i], ppoints[i]);
 
-        auto p2 = forceDirected->point(dynamic_cast<Springy::Node *>(node2))->p();
+  for (const auto &edgeNodes : thread->edgeNodes()) {
+    if (size_t(edgeNodes.first ) >= ppoints.size() ||
+        size_t(edgeNodes.second) >= ppoints.size())
+      continue;
 
-        drawNode(node2, p2);
-
-        //std::cerr << p1.x() << " " << p1.y() << " " << p2.x() << " " << p2.y() << "\n";
-
-        double px1, py1, px2, py2;
-
-        range.windowToPixel(p1.x(), p1.y(), &px1, &py1);
-        range.windowToPixel(p2.x(), p2.y(), &px2, &py2);
-
-        drawEdge(QPointF(px1, py1), QPointF(px2, py2));
-
-        //std::cerr << x1 << " " << y1 << " " << x2 << " " << y2 << "\n";
-      }
-    }
-  }
-#else
-  for (auto &node : forceDirected->nodes()) {
-    auto point = forceDirected->point(node);
-
-    const auto &p1 = point->p();
-
-    drawNode(dynamic_cast<CForceDirectedSpringNode *>(node.get()), p1);
-  }
-
-  for (auto &edge : forceDirected->edges()) {
-    bool isTemp = false;
-
-    auto spring = forceDirected->spring(edge, isTemp);
-
-    const auto &p1 = spring->point1()->p();
-    const auto &p2 = spring->point2()->p();
-
-    double px1, py1, px2, py2;
-
-    range.windowToPixel(p1.x(), p1.y(), &px1, &py1);
-    range.windowToPixel(p2.x(), p2.y(), &px2, &py2);
-
-    drawEdge(QPointF(px1, py1), QPointF(px2, py2));
+    drawEdge(ppoints[edgeNodes.first], ppoints[edgeNodes.second]);
   }
-#endif
 }
 
 void
@@ -1096,7 +1596,7 @@ drawGraphPlacer(QPainter *painter)
   edgeWidth = 4;
 
   for (auto edge : graph_->minGraph()->edges()) {
-    auto *edge1 = dynamic_cast<GraphPlacerDotEdge *>(edge.get());
+    auto *edge1 = dynamic_cast<GraphPlacerDotEdge *>(edge);
 
     auto *node1 = edge1->fromNode();
     auto *node2 = edge1->toNode  ();
@@ -1176,6 +1676,28 @@ void
 CQGraphStatus::
 paintEvent(QPaintEvent *)
 {
+  auto *thread = graph_->forceDirectedThread();
+
+  if (thread) {
+    const auto &snapshot = thread->currentSnapshot();
+
+    auto str = QString("Step %1, Energy %2, Max Move %3").
+                 arg(snapshot.step).arg(snapshot.energy).arg(snapshot.maxMove);
+
+    if (snapshot.converged)
+      str += " (Converged)";
+
+    QPainter painter(this);
+
+    QFontMetrics fm(font());
+
+    painter.drawText(2, fm.ascent() + 2, str);
+
+    return;
+  }
+
+  //---
+
   auto *placer = graph_->graphPlacer();
   if (! placer) return;
 
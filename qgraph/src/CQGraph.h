@@ -2,18 +2,38 @@
 #define CQGraph_H
 
 #include <QFrame>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
 
 #include <CDotParse.h>
+#include <CQGraphForceLayout.h>
+
+#include <atomic>
+#include <vector>
 
 class CQGraphDotParse;
 class CQGraphCanvas;
 class CQGraphStatus;
+class CQGraphForceDirectedThread;
 
 class CForceDirectedMgr;
 class GraphPlacer;
 class GraphPlacerGraph;
 
-class QTimer;
+//! force directed simulation parameters
+struct CQGraphForceDirectedParameters {
+  using Repulsion = CQGraphForceLayout::Repulsion;
+
+  Repulsion repulsionType         { Repulsion::EXACT };
+  double    theta                 { 0.8 };
+  double    energyThreshold       { 0.01 };   // converged mean point kinetic energy
+  double    displacementThreshold { 2.5E-4 }; // converged largest point move per step
+                                              // (fraction of layout size)
+  int       convergedSteps        { 100 };    // steps below thresholds to converge
+};
+
+//---
 
 class CQGraph : public QFrame {
   Q_OBJECT
@@ -23,7 +43,8 @@ class CQGraph : public QFrame {
     NONE,
     FORCE_DIRECTED,
     CIRCLE_PACK,
-    GRAPH_PLACER
+    GRAPH_PLACER,
+    MULTILEVEL
   };
 
  public:
@@ -38,12 +59,18 @@ class CQGraph : public QFrame {
   const PackType &packType() const { return packType_; }
   void setPackType(const PackType &t) { packType_ = t; }
 
+  //! force directed parameters (restarts running simulation)
+  const CQGraphForceDirectedParameters &forceParameters() const { return forceParameters_; }
+  void setForceParameters(const CQGraphForceDirectedParameters &parameters);
+
   void loadFile(const std::string &filename);
 
   void init();
 
   CForceDirectedMgr *forceDirected() const { return forceDirected_; }
 
+  CQGraphForceDirectedThread *forceDirectedThread() const { return forceDirectedThread_; }
+
   void *circlePack() const { return circlePack_; }
 
   GraphPlacer *graphPlacer() const { return graphPlacer_; }
@@ -62,30 +89,207 @@ class CQGraph : public QFrame {
   //---
 
   void initForceDirected();
+  void initMultilevel();
   void initCirclePack();
 
   void createGraphPlacer();
   void initGraphPlacer();
 
- private slots:
-  void animate();
+ private:
+  bool                           debug_               { false };
+  PackType                       packType_            { PackType::NONE };
+  CQGraphForceDirectedParameters forceParameters_;
+  CQGraphDotParse*               parse_               { nullptr };
+  CForceDirectedMgr*             forceDirected_       { nullptr };
+  CQGraphForceDirectedThread*    forceDirectedThread_ { nullptr };
+  void*                          circlePack_          { nullptr };
+  GraphPlacer*                   graphPlacer_         { nullptr };
+  GraphPlacerGraph*              graphPlacerGraph_    { nullptr };
+  CDotParse::GraphP              minGraph_            { nullptr };
+  CDotParse::Graph::NodeArray    shortestPath_;
+  CQGraphCanvas*                 canvas_              { nullptr };
+  CQGraphStatus*                 status_              { nullptr };
+  double                         margin_              { 32 };
+};
+
+//---
+
+/*!
+ * Lock free triple buffer for one writer and one reader thread.
+ *
+ * The writer fills back() and publishes it, the reader calls update() to take the
+ * latest published buffer as front(). Neither side waits for the other and a buffer
+ * is never written while it is being read.
+ */
+template<typename T>
+class CQGraphTripleBuffer {
+ public:
+  CQGraphTripleBuffer() { }
+
+  //! writer : buffer to fill
+  T &back() { return buffers_[back_]; }
+
+  //! writer : make back buffer the latest (swap with middle)
+  void publish() {
+    back_ = middle_.exchange(back_ | FRESH_BIT) & INDEX_MASK;
+  }
+
+  //! reader : take latest published buffer as front (returns false if none new)
+  bool update() {
+    if (! (middle_.load() & FRESH_BIT))
+      return false;
+
+    front_ = middle_.exchange(front_) & INDEX_MASK;
+
+    return true;
+  }
+
+  //! reader : latest taken buffer
+  const T &front() const { return buffers_[front_]; }
 
  private:
-  bool                        debug_            { false };
-  PackType                    packType_         { PackType::NONE };
-  CQGraphDotParse*            parse_            { nullptr };
-  CForceDirectedMgr*          forceDirected_    { nullptr };
-  void*                       circlePack_       { nullptr };
-  GraphPlacer*                graphPlacer_      { nullptr };
-  GraphPlacerGraph*           graphPlacerGraph_ { nullptr };
-  CDotParse::GraphP           minGraph_;
-  CDotParse::Graph::NodeArray shortestPath_;
-  QTimer*                     timer_            { nullptr };
-  CQGraphCanvas*              canvas_           { nullptr };
-  CQGraphStatus*              status_           { nullptr };
-  double                      margin_           { 32 };
+  // middle index has fresh bit set when it holds a buffer not yet taken by reader
+  enum { INDEX_MASK = 3, FRESH_BIT = 4 };
+
+  T                buffers_[3];
+  int              back_   { 0 };
+  int              front_  { 1 };
+  std::atomic<int> middle_ { 2 };
+};
+
+//! force directed node positions and range at a simulation step
+struct CQGraphForceDirectedSnapshot {
+  struct Point {
+    double x { 0.0 };
+    double y { 0.0 };
+  };
+
+  std::vector<Point> points;            // node positions (thread node order)
+  double             xmin      { 0.0 };
+  double             ymin      { 0.0 };
+  double             xmax      { 1.0 };
+  double             ymax      { 1.0 };
+  int                step      { 0 };
+  double             energy    { 0.0 };   // last step kinetic energy
+  double             maxMove   { 0.0 };   // last step largest point move
+  bool               converged { false };
 };
 
+/*!
+ * Runs the force directed simulation on a worker thread.
+ *
+ * The simulation is a CQGraphForceLayout of the CForceDirected graph (nodes, springs
+ * and initial points) which only the thread accesses once started. After each batch
+ * of steps the node positions are copied into a triple buffered snapshot which the
+ * GUI thread draws from.
+ *
+ * For a multilevel layout the thread first runs CQGraphMultilevelLayout, publishing
+ * each level as it is refined, and continues from the refined input level.
+ *
+ * Stepping stops once the layout has converged (point energy and largest move below
+ * thresholds for a number of consecutive steps) and the thread then sleeps until the
+ * parameters are changed or it is restarted.
+ */
+class CQGraphForceDirectedThread : public QThread {
+  Q_OBJECT
+
+ public:
+  using Snapshot  = CQGraphForceDirectedSnapshot;
+  using EdgeNodes = std::pair<int, int>;
+
+ public:
+  CQGraphForceDirectedThread(CForceDirectedMgr *forceDirected, QObject *parent=nullptr);
+
+  CQGraphForceDirectedThread(const std::vector<QString> &nodeNames,
+                             const std::vector<EdgeNodes> &edgeNodes, QObject *parent=nullptr);
+
+ ~CQGraphForceDirectedThread();
+
+  using Parameters = CQGraphForceDirectedParameters;
+
+  //! node names and edge node indices (fixed when thread created)
+  const std::vector<QString>   &nodeNames() const { return nodeNames_; }
+  const std::vector<EdgeNodes> &edgeNodes() const { return edgeNodes_; }
+
+  //! untangle steps before first animate interval
+  int initSteps() const { return initSteps_; }
+  void setInitSteps(int i) { initSteps_ = i; }
+
+  //! steps per publish during untangle
+  int publishSteps() const { return publishSteps_; }
+  void setPublishSteps(int i) { publishSteps_ = i; }
+
+  //! steps per animate interval
+  int animateSteps() const { return animateSteps_; }
+  void setAnimateSteps(int i) { animateSteps_ = i; }
+
+  //! animate interval (ms)
+  int animateInterval() const { return animateInterval_; }
+  void setAnimateInterval(int i) { animateInterval_ = i; }
+
+  double stepSize() const { return stepSize_; }
+  void setStepSize(double r) { stepSize_ = r; }
+
+  //! run multilevel layout before stepping (configure before start)
+  bool isMultilevel() const { return multilevel_; }
+  void setMultilevel(bool b) { multilevel_ = b; }
+
+  //! simulation parameters (applied by thread before next step, restarts if converged)
+  Parameters parameters() const;
+  void setParameters(const Parameters &parameters);
+
+  //! latest published snapshot (GUI thread)
+  const Snapshot &snapshot();
+
+  //! snapshot last returned by snapshot() (GUI thread)
+  const Snapshot &currentSnapshot() const { return buffer_.front(); }
+
+  //! restart converged simulation
+  void restart();
+
+  //! stop simulation and wait for thread to finish
+  void stop();
+
+ signals:
+  //! new snapshot published (emitted once until snapshot is read)
+  void snapshotReady();
+
+ protected:
+  void run() override;
+
+ private:
+  void runMultilevel(int &step);
+
+  void waitFor(int ms);
+
+  void publish(int step, bool converged);
+
+ private:
+  using Buffer = CQGraphTripleBuffer<Snapshot>;
+
+  CForceDirectedMgr*     forceDirected_     { nullptr };
+  CQGraphForceLayout     layout_;
+  std::vector<QString>   nodeNames_;
+  std::vector<EdgeNodes> edgeNodes_;
+  int                    initSteps_         { 1000 };
+  int                    publishSteps_      { 50 };
+  int                    animateSteps_      { 100 };
+  int                    animateInterval_   { 250 };
+  double                 stepSize_          { 0.01 };
+  bool                   multilevel_        { false };
+  Buffer                 buffer_;
+  mutable QMutex         mutex_;        // guards parameters and wake state
+  QWaitCondition         wakeCond_;
+  Parameters             parameters_;
+  bool                   parametersChanged_ { true };
+  bool                   restart_           { false };
+  bool                   wake_              { false };
+  std::atomic<bool>      stopped_           { false };
+  std::atomic<bool>      notifyPending_     { false };
+};
+
+//---
+
 class CQGraphCanvas : public QFrame {
   Q_OBJECT
 
@@ -95,6 +299,8 @@ class CQGraphCanvas : public QFrame {
 
   void mouseMoveEvent(QMouseEvent *) override;
 
+  void keyPressEvent(QKeyEvent *) override;
+
   void resizeEvent(QResizeEvent *) override;
 
   void paintEvent(QPaintEvent *) override;
@@ -108,8 +314,9 @@ class CQGraphCanvas : public QFrame {
   QPoint mousePos() const { return mousePos_; }
 
  private:
-  CQGraph *graph_  { nullptr };
+  CQGraph *graph_     { nullptr };
   QPoint   mousePos_;
+  int      drawnStep_ { -1 };
 };
 
 class CQGraphStatus : public QFrame {
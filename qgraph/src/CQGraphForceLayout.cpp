@@ -0,0 +1,721 @@
+#include <CQGraphForceLayout.h>
+
+#include <algorithm>
+#include <cmath>
+
+// AVX2 kernels are compiled with a target attribute (no -mavx2 needed) and selected at
+// run time if the CPU supports AVX2
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CQGRAPH_FORCE_LAYOUT_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// distance added to avoid infinite repulsion (as Springy)
+const double minDistance = 0.1;
+
+// Springy applies repulsion/(d^2/2) to a point for each ordered pair it is in, so
+// twice per pair
+const double repulsionScale = 4.0;
+
+// quadtree depth limit (coincident points share a leaf)
+const int maxTreeDepth = 32;
+
+#ifdef CQGRAPH_FORCE_LAYOUT_AVX2
+#define CQGRAPH_AVX2_TARGET __attribute__((target("avx2")))
+
+// sum of vector elements
+CQGRAPH_AVX2_TARGET
+double
+horizontalSum(__m256d v)
+{
+  __m128d lo = _mm256_castpd256_pd128(v);
+  __m128d hi = _mm256_extractf128_pd(v, 1);
+
+  lo = _mm_add_pd(lo, hi);
+
+  return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+}
+
+// unit direction (1, 0 for coincident points) and length of vectors
+CQGRAPH_AVX2_TARGET
+__m256d
+normalize(__m256d &dx, __m256d &dy)
+{
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d one  = _mm256_set1_pd(1.0);
+
+  __m256d d = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+
+  __m256d nz = _mm256_cmp_pd(d, zero, _CMP_GT_OQ);
+  __m256d rd = _mm256_div_pd(one, d);
+
+  dx = _mm256_blendv_pd(one , _mm256_mul_pd(dx, rd), nz);
+  dy = _mm256_blendv_pd(zero, _mm256_mul_pd(dy, rd), nz);
+
+  return d;
+}
+
+// exact repulsion of all pairs (see CQGraphForceLayout::applyExactRepulsion) with four
+// second points at a time. Second points are peeled until their index is a multiple
+// of four so the vector loads and stores are aligned (arrays are 32 byte aligned)
+CQGRAPH_AVX2_TARGET
+void
+exactRepulsionAVX2(int n, const double *x, const double *y, const double *im,
+                   double *ax, double *ay, double k)
+{
+  const __m256d minD = _mm256_set1_pd(minDistance);
+  const __m256d vk   = _mm256_set1_pd(k);
+
+  for (int i1 = 0; i1 < n; ++i1) {
+    double fx1 = 0.0, fy1 = 0.0;
+
+    auto addPair = [&](int i2) {
+      double dx = x[i1] - x[i2];
+      double dy = y[i1] - y[i2];
+
+      double d = std::sqrt(dx*dx + dy*dy);
+
+      if (d > 0.0) { dx /= d; dy /= d; }
+      else         { dx = 1.0; dy = 0.0; }
+
+      double r = d + minDistance;
+      double f = k/(r*r);
+
+      fx1 += dx*f; fy1 += dy*f;
+
+      ax[i2] -= dx*f*im[i2];
+      ay[i2] -= dy*f*im[i2];
+    };
+
+    int i2 = i1 + 1;
+
+    for ( ; i2 < n && (i2 & 3); ++i2)
+      addPair(i2);
+
+    __m256d x1 = _mm256_set1_pd(x[i1]);
+    __m256d y1 = _mm256_set1_pd(y[i1]);
+
+    __m256d vfx1 = _mm256_setzero_pd();
+    __m256d vfy1 = _mm256_setzero_pd();
+
+    for ( ; i2 + 4 <= n; i2 += 4) {
+      __m256d dx = _mm256_sub_pd(x1, _mm256_load_pd(x + i2));
+      __m256d dy = _mm256_sub_pd(y1, _mm256_load_pd(y + i2));
+
+      __m256d d = normalize(dx, dy);
+
+      __m256d r = _mm256_add_pd(d, minD);
+      __m256d f = _mm256_div_pd(vk, _mm256_mul_pd(r, r));
+
+      __m256d fx = _mm256_mul_pd(dx, f);
+      __m256d fy = _mm256_mul_pd(dy, f);
+
+      vfx1 = _mm256_add_pd(vfx1, fx);
+      vfy1 = _mm256_add_pd(vfy1, fy);
+
+      __m256d im2 = _mm256_load_pd(im + i2);
+
+      _mm256_store_pd(ax + i2, _mm256_sub_pd(_mm256_load_pd(ax + i2), _mm256_mul_pd(fx, im2)));
+      _mm256_store_pd(ay + i2, _mm256_sub_pd(_mm256_load_pd(ay + i2), _mm256_mul_pd(fy, im2)));
+    }
+
+    // remaining (< 4) second points
+    for ( ; i2 < n; ++i2)
+      addPair(i2);
+
+    fx1 += horizontalSum(vfx1);
+    fy1 += horizontalSum(vfy1);
+
+    ax[i1] += fx1*im[i1];
+    ay[i1] += fy1*im[i1];
+  }
+}
+
+// spring forces (see CQGraphForceLayout::applySprings) of four springs at a time (end
+// point positions gathered). Forces are added to end points in spring order as springs
+// can share points
+CQGRAPH_AVX2_TARGET
+void
+springsAVX2(int ns, const int *si1, const int *si2, const double *len,
+            const double *x, const double *y, const double *im,
+            double *ax, double *ay, double k)
+{
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d all  = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+  const __m256d vk   = _mm256_set1_pd(k);
+
+  alignas(32) double fx[4];
+  alignas(32) double fy[4];
+
+  int s = 0;
+
+  for ( ; s + 4 <= ns; s += 4) {
+    __m128i i1 = _mm_load_si128(reinterpret_cast<const __m128i *>(si1 + s));
+    __m128i i2 = _mm_load_si128(reinterpret_cast<const __m128i *>(si2 + s));
+
+    __m256d dx = _mm256_sub_pd(_mm256_mask_i32gather_pd(zero, x, i2, all, 8),
+                               _mm256_mask_i32gather_pd(zero, x, i1, all, 8));
+    __m256d dy = _mm256_sub_pd(_mm256_mask_i32gather_pd(zero, y, i2, all, 8),
+                               _mm256_mask_i32gather_pd(zero, y, i1, all, 8));
+
+    __m256d d = normalize(dx, dy);
+
+    __m256d f = _mm256_mul_pd(vk, _mm256_sub_pd(_mm256_load_pd(len + s), d));
+
+    _mm256_store_pd(fx, _mm256_mul_pd(dx, f));
+    _mm256_store_pd(fy, _mm256_mul_pd(dy, f));
+
+    for (int j = 0; j < 4; ++j) {
+      int j1 = si1[s + j];
+      int j2 = si2[s + j];
+
+      ax[j1] -= fx[j]*im[j1]; ay[j1] -= fy[j]*im[j1];
+      ax[j2] += fx[j]*im[j2]; ay[j2] += fy[j]*im[j2];
+    }
+  }
+
+  // remaining (< 4) springs
+  for ( ; s < ns; ++s) {
+    int i1 = si1[s];
+    int i2 = si2[s];
+
+    double dx = x[i2] - x[i1];
+    double dy = y[i2] - y[i1];
+
+    double d = std::sqrt(dx*dx + dy*dy);
+
+    if (d > 0.0) { dx /= d; dy /= d; }
+    else         { dx = 1.0; dy = 0.0; }
+
+    double f = k*(len[s] - d);
+
+    ax[i1] -= dx*f*im[i1]; ay[i1] -= dy*f*im[i1];
+    ax[i2] += dx*f*im[i2]; ay[i2] += dy*f*im[i2];
+  }
+}
+#endif
+}
+
+//---
+
+CQGraphForceLayout::
+CQGraphForceLayout()
+{
+}
+
+bool
+CQGraphForceLayout::
+isSimdAvailable()
+{
+#ifdef CQGRAPH_FORCE_LAYOUT_AVX2
+  static bool avx2 = __builtin_cpu_supports("avx2");
+
+  return avx2;
+#else
+  return false;
+#endif
+}
+
+void
+CQGraphForceLayout::
+clear()
+{
+  x_      .clear();
+  y_      .clear();
+  vx_     .clear();
+  vy_     .clear();
+  ax_     .clear();
+  ay_     .clear();
+  invMass_.clear();
+
+  springI1_    .clear();
+  springI2_    .clear();
+  springLength_.clear();
+}
+
+void
+CQGraphForceLayout::
+reserve(int numPoints, int numSprings)
+{
+  x_      .reserve(numPoints);
+  y_      .reserve(numPoints);
+  vx_     .reserve(numPoints);
+  vy_     .reserve(numPoints);
+  ax_     .reserve(numPoints);
+  ay_     .reserve(numPoints);
+  invMass_.reserve(numPoints);
+
+  springI1_    .reserve(numSprings);
+  springI2_    .reserve(numSprings);
+  springLength_.reserve(numSprings);
+}
+
+int
+CQGraphForceLayout::
+addPoint(double x, double y, double mass)
+{
+  x_ .push_back(x);
+  y_ .push_back(y);
+  vx_.push_back(0.0);
+  vy_.push_back(0.0);
+  ax_.push_back(0.0);
+  ay_.push_back(0.0);
+
+  invMass_.push_back(mass > 0.0 ? 1.0/mass : 1.0);
+
+  return int(x_.size()) - 1;
+}
+
+void
+CQGraphForceLayout::
+addSpring(int i1, int i2, double length)
+{
+  springI1_    .push_back(i1);
+  springI2_    .push_back(i2);
+  springLength_.push_back(length);
+}
+
+void
+CQGraphForceLayout::
+setPosition(int i, double x, double y)
+{
+  x_ [i] = x;
+  y_ [i] = y;
+  vx_[i] = 0.0;
+  vy_[i] = 0.0;
+}
+
+void
+CQGraphForceLayout::
+calcRange(double &xmin, double &ymin, double &xmax, double &ymax) const
+{
+  int n = numPoints();
+
+  if (n == 0) {
+    xmin = -1.0; ymin = -1.0; xmax = 1.0; ymax = 1.0;
+    return;
+  }
+
+  xmin = x_[0]; xmax = xmin;
+  ymin = y_[0]; ymax = ymin;
+
+  for (int i = 1; i < n; ++i) {
+    xmin = std::min(xmin, x_[i]); xmax = std::max(xmax, x_[i]);
+    ymin = std::min(ymin, y_[i]); ymax = std::max(ymax, y_[i]);
+  }
+}
+
+void
+CQGraphForceLayout::
+step(double dt)
+{
+  bool simd = (simd_ && isSimdAvailable());
+
+  if      (repulsionType_ == Repulsion::BARNES_HUT)
+    applyBarnesHutRepulsion();
+  else if (simd)
+    applyExactRepulsionSimd();
+  else
+    applyExactRepulsion();
+
+  if (simd)
+    applySpringsSimd();
+  else
+    applySprings();
+
+  attractToCentre();
+
+  updateVelocity(dt);
+  updatePosition(dt);
+}
+
+double
+CQGraphForceLayout::
+totalEnergy() const
+{
+  double energy = 0.0;
+
+  int n = numPoints();
+
+  for (int i = 0; i < n; ++i)
+    energy += 0.5*(vx_[i]*vx_[i] + vy_[i]*vy_[i])/invMass_[i];
+
+  return energy;
+}
+
+bool
+CQGraphForceLayout::
+isConverged(double energyThreshold, double displacementThreshold) const
+{
+  if (x_.empty())
+    return true;
+
+  return (stepEnergy_/double(x_.size()) < energyThreshold &&
+          maxDisplacement_ < displacementThreshold*std::max(stepExtent_, 1E-6));
+}
+
+//---
+
+void
+CQGraphForceLayout::
+applyExactRepulsion()
+{
+  // each pair once, equal and opposite force (force on first point summed then
+  // scaled by its inverse mass)
+  int n = numPoints();
+
+  double k = repulsionScale*repulsion_;
+
+  for (int i1 = 0; i1 < n; ++i1) {
+    double x1 = x_[i1];
+    double y1 = y_[i1];
+
+    double fx1 = 0.0, fy1 = 0.0;
+
+    for (int i2 = i1 + 1; i2 < n; ++i2) {
+      double dx = x1 - x_[i2];
+      double dy = y1 - y_[i2];
+
+      double d = std::sqrt(dx*dx + dy*dy);
+
+      if (d > 0.0) { dx /= d; dy /= d; }
+      else         { dx = 1.0; dy = 0.0; }
+
+      double r = d + minDistance;
+      double f = k/(r*r);
+
+      fx1 += dx*f; fy1 += dy*f;
+
+      ax_[i2] -= dx*f*invMass_[i2];
+      ay_[i2] -= dy*f*invMass_[i2];
+    }
+
+    ax_[i1] += fx1*invMass_[i1];
+    ay_[i1] += fy1*invMass_[i1];
+  }
+}
+
+void
+CQGraphForceLayout::
+applyExactRepulsionSimd()
+{
+#ifdef CQGRAPH_FORCE_LAYOUT_AVX2
+  exactRepulsionAVX2(numPoints(), x_.data(), y_.data(), invMass_.data(),
+                     ax_.data(), ay_.data(), repulsionScale*repulsion_);
+#else
+  applyExactRepulsion();
+#endif
+}
+
+void
+CQGraphForceLayout::
+applyBarnesHutRepulsion()
+{
+  buildTree();
+
+  if (cells_.empty())
+    return;
+
+  int n = numPoints();
+
+  for (int i = 0; i < n; ++i) {
+    double px = x_[i];
+    double py = y_[i];
+
+    double fx = 0.0, fy = 0.0;
+
+    stack_.clear();
+
+    stack_.push_back(0);
+
+    while (! stack_.empty()) {
+      int c = stack_.back();
+
+      stack_.pop_back();
+
+      const auto &cell = cells_[c];
+
+      if (cell.leaf) {
+        for (int b = cell.body; b >= 0; b = next_[b]) {
+          if (b != i)
+            addRepulsion(i, x_[b], y_[b], 1.0, fx, fy);
+        }
+
+        continue;
+      }
+
+      // cell containing point is always opened so point never repels itself
+      bool inside = (px >= cell.x && px <= cell.x + cell.size &&
+                     py >= cell.y && py <= cell.y + cell.size);
+
+      double cx = cell.sx/cell.count;
+      double cy = cell.sy/cell.count;
+
+      if (! inside) {
+        double dx = px - cx;
+        double dy = py - cy;
+
+        if (cell.size*cell.size < theta_*theta_*(dx*dx + dy*dy)) {
+          addRepulsion(i, cx, cy, cell.count, fx, fy);
+          continue;
+        }
+      }
+
+      for (int q = 0; q < 4; ++q) {
+        if (cell.child[q] >= 0)
+          stack_.push_back(cell.child[q]);
+      }
+    }
+
+    ax_[i] += fx*invMass_[i];
+    ay_[i] += fy*invMass_[i];
+  }
+}
+
+void
+CQGraphForceLayout::
+addRepulsion(int i, double x, double y, double n, double &fx, double &fy) const
+{
+  double dx = x_[i] - x;
+  double dy = y_[i] - y;
+
+  double d = std::sqrt(dx*dx + dy*dy);
+
+  if (d > 0.0) { dx /= d; dy /= d; }
+  else         { dx = 1.0; dy = 0.0; }
+
+  double r = d + minDistance;
+  double f = n*repulsionScale*repulsion_/(r*r);
+
+  fx += dx*f;
+  fy += dy*f;
+}
+
+void
+CQGraphForceLayout::
+applySprings()
+{
+  int ns = numSprings();
+
+  for (int s = 0; s < ns; ++s) {
+    int i1 = springI1_[s];
+    int i2 = springI2_[s];
+
+    double dx = x_[i2] - x_[i1];
+    double dy = y_[i2] - y_[i1];
+
+    double d = std::sqrt(dx*dx + dy*dy);
+
+    if (d > 0.0) { dx /= d; dy /= d; }
+    else         { dx = 1.0; dy = 0.0; }
+
+    // pull together if longer than rest length, push apart if shorter
+    double f = 0.5*stiffness_*(springLength_[s] - d);
+
+    ax_[i1] -= dx*f*invMass_[i1]; ay_[i1] -= dy*f*invMass_[i1];
+    ax_[i2] += dx*f*invMass_[i2]; ay_[i2] += dy*f*invMass_[i2];
+  }
+}
+
+void
+CQGraphForceLayout::
+applySpringsSimd()
+{
+#ifdef CQGRAPH_FORCE_LAYOUT_AVX2
+  springsAVX2(numSprings(), springI1_.data(), springI2_.data(), springLength_.data(),
+              x_.data(), y_.data(), invMass_.data(), ax_.data(), ay_.data(), 0.5*stiffness_);
+#else
+  applySprings();
+#endif
+}
+
+void
+CQGraphForceLayout::
+attractToCentre()
+{
+  double f = repulsion_/50.0;
+
+  int n = numPoints();
+
+  for (int i = 0; i < n; ++i) {
+    ax_[i] -= x_[i]*f*invMass_[i];
+    ay_[i] -= y_[i]*f*invMass_[i];
+  }
+}
+
+void
+CQGraphForceLayout::
+updateVelocity(double dt)
+{
+  int n = numPoints();
+
+  for (int i = 0; i < n; ++i) {
+    vx_[i] = (vx_[i] + ax_[i]*dt)*damping_;
+    vy_[i] = (vy_[i] + ay_[i]*dt)*damping_;
+
+    ax_[i] = 0.0;
+    ay_[i] = 0.0;
+  }
+}
+
+void
+CQGraphForceLayout::
+updatePosition(double dt)
+{
+  // track energy, largest move and size for convergence test
+  int n = numPoints();
+
+  double energy  = 0.0;
+  double maxMove = 0.0;
+
+  double xmin = 0.0, ymin = 0.0, xmax = 0.0, ymax = 0.0;
+
+  for (int i = 0; i < n; ++i) {
+    double v2 = vx_[i]*vx_[i] + vy_[i]*vy_[i];
+
+    energy += 0.5*v2/invMass_[i];
+
+    maxMove = std::max(maxMove, v2);
+
+    x_[i] += vx_[i]*dt;
+    y_[i] += vy_[i]*dt;
+
+    if (i == 0) {
+      xmin = x_[i]; xmax = x_[i];
+      ymin = y_[i]; ymax = y_[i];
+    }
+    else {
+      xmin = std::min(xmin, x_[i]); xmax = std::max(xmax, x_[i]);
+      ymin = std::min(ymin, y_[i]); ymax = std::max(ymax, y_[i]);
+    }
+  }
+
+  stepEnergy_      = energy;
+  maxDisplacement_ = std::sqrt(maxMove)*std::abs(dt);
+  stepExtent_      = std::max(xmax - xmin, ymax - ymin);
+}
+
+//---
+
+void
+CQGraphForceLayout::
+buildTree()
+{
+  cells_.clear();
+
+  int n = numPoints();
+
+  if (n == 0)
+    return;
+
+  next_.assign(n, -1);
+
+  // square root cell around all points
+  double xmin, ymin, xmax, ymax;
+
+  calcRange(xmin, ymin, xmax, ymax);
+
+  Cell root;
+
+  root.x    = xmin;
+  root.y    = ymin;
+  root.size = std::max(std::max(xmax - xmin, ymax - ymin), 1E-6);
+
+  cells_.reserve(2*n);
+
+  cells_.push_back(root);
+
+  for (int i = 0; i < n; ++i)
+    insertBody(i);
+}
+
+void
+CQGraphForceLayout::
+insertBody(int i)
+{
+  double x = x_[i];
+  double y = y_[i];
+
+  int c     = 0;
+  int depth = 0;
+
+  while (true) {
+    cells_[c].sx += x;
+    cells_[c].sy += y;
+
+    ++cells_[c].count;
+
+    if (cells_[c].leaf) {
+      if (cells_[c].body < 0) {
+        cells_[c].body = i;
+        return;
+      }
+
+      // too deep to split (coincident points) so add to leaf body list
+      if (depth >= maxTreeDepth) {
+        next_[i] = cells_[c].body;
+
+        cells_[c].body = i;
+
+        return;
+      }
+
+      // split leaf, moving its body to child
+      int b = cells_[c].body;
+
+      cells_[c].body = -1;
+      cells_[c].leaf = false;
+
+      int cb = makeChild(c, cellQuadrant(c, x_[b], y_[b]));
+
+      cells_[cb].sx    = x_[b];
+      cells_[cb].sy    = y_[b];
+      cells_[cb].count = 1;
+      cells_[cb].body  = b;
+    }
+
+    int q = cellQuadrant(c, x, y);
+
+    int child = cells_[c].child[q];
+
+    if (child < 0)
+      child = makeChild(c, q);
+
+    c = child;
+
+    ++depth;
+  }
+}
+
+int
+CQGraphForceLayout::
+makeChild(int c, int q)
+{
+  Cell child;
+
+  child.size = cells_[c].size/2.0;
+  child.x    = cells_[c].x + (q & 1 ? child.size : 0.0);
+  child.y    = cells_[c].y + (q & 2 ? child.size : 0.0);
+
+  // may reallocate so don't hold cell references over this
+  cells_.push_back(child);
+
+  int ci = int(cells_.size()) - 1;
+
+  cells_[c].child[q] = ci;
+
+  return ci;
+}
+
+int
+CQGraphForceLayout::
+cellQuadrant(int c, double x, double y) const
+{
+  const auto &cell = cells_[c];
+
+  double h = cell.size/2.0;
+
+  return (x >= cell.x + h ? 1 : 0) | (y >= cell.y + h ? 2 : 0);
+}
@@ -0,0 +1,199 @@
+#ifndef CQGraphForceLayout_H
+#define CQGraphForceLayout_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/*!
+ * Allocator for vectors of SIMD aligned data
+ */
+template<typename T, std::size_t ALIGN=32>
+class CQGraphAlignedAllocator {
+ public:
+  using value_type = T;
+
+  template<typename U>
+  struct rebind { using other = CQGraphAlignedAllocator<U, ALIGN>; };
+
+ public:
+  CQGraphAlignedAllocator() { }
+
+  template<typename U>
+  CQGraphAlignedAllocator(const CQGraphAlignedAllocator<U, ALIGN> &) { }
+
+  T *allocate(std::size_t n) {
+    return static_cast<T *>(::operator new(n*sizeof(T), std::align_val_t(ALIGN)));
+  }
+
+  void deallocate(T *p, std::size_t) {
+    ::operator delete(p, std::align_val_t(ALIGN));
+  }
+
+  template<typename U>
+  bool operator==(const CQGraphAlignedAllocator<U, ALIGN> &) const { return true; }
+
+  template<typename U>
+  bool operator!=(const CQGraphAlignedAllocator<U, ALIGN> &) const { return false; }
+};
+
+//---
+
+/*!
+ * Force directed layout of points (dense node index) connected by springs.
+ *
+ * Uses the Springy physics of the CForceDirected library (coulomb repulsion between
+ * all points, hooke spring attraction, attraction to centre, damped velocity) so a
+ * layout started from the library's points behaves the same.
+ *
+ * Repulsion is either exact (all pairs, O(n^2) per step) or approximated with a
+ * Barnes-Hut quadtree (O(n log n) per step) where a cell whose size divided by its
+ * distance from a point is less than theta is treated as a single body at its
+ * centroid.
+ *
+ * Point state (position, velocity, acceleration, inverse mass) is stored as separate
+ * arrays indexed by point (structure of arrays) and springs as arrays of end point
+ * indices and lengths. On x86 CPUs with AVX2 (checked at run time) the exact repulsion
+ * and spring loops process four points/springs per instruction, otherwise (or if SIMD
+ * is disabled) scalar loops are used. The AVX2 repulsion keeps four partial sums of
+ * the force on each point so results differ from the scalar loops by rounding.
+ *
+ * Arrays are 32 byte aligned so the AVX2 loops can use aligned loads and stores (the
+ * repulsion loop handles second points before the next multiple of four separately).
+ */
+class CQGraphForceLayout {
+ public:
+  enum class Repulsion {
+    EXACT,
+    BARNES_HUT
+  };
+
+ public:
+  CQGraphForceLayout();
+
+  //! repulsion calculation
+  const Repulsion &repulsionType() const { return repulsionType_; }
+  void setRepulsionType(const Repulsion &r) { repulsionType_ = r; }
+
+  //! Barnes-Hut opening angle (0 is exact, larger is faster and less accurate)
+  double theta() const { return theta_; }
+  void setTheta(double r) { theta_ = r; }
+
+  double stiffness() const { return stiffness_; }
+  void setStiffness(double r) { stiffness_ = r; }
+
+  double repulsion() const { return repulsion_; }
+  void setRepulsion(double r) { repulsion_ = r; }
+
+  double damping() const { return damping_; }
+  void setDamping(double r) { damping_ = r; }
+
+  //! use SIMD force loops (if CPU supports AVX2)
+  bool isSimd() const { return simd_; }
+  void setSimd(bool b) { simd_ = b; }
+
+  //! CPU supports SIMD (AVX2) force loops
+  static bool isSimdAvailable();
+
+  //---
+
+  void clear();
+
+  //! reserve space for points and springs
+  void reserve(int numPoints, int numSprings);
+
+  //! add point (returns index)
+  int addPoint(double x, double y, double mass=1.0);
+
+  //! add spring between points
+  void addSpring(int i1, int i2, double length=1.0);
+
+  int numPoints () const { return int(x_.size()); }
+  int numSprings() const { return int(springLength_.size()); }
+
+  double x(int i) const { return x_[i]; }
+  double y(int i) const { return y_[i]; }
+
+  //! move point (and stop it)
+  void setPosition(int i, double x, double y);
+
+  //! point range
+  void calcRange(double &xmin, double &ymin, double &xmax, double &ymax) const;
+
+  //! advance simulation by time step
+  void step(double dt);
+
+  //! kinetic energy
+  double totalEnergy() const;
+
+  //! kinetic energy, largest point move and layout size (max of width and height)
+  //! of last step
+  double stepEnergy() const { return stepEnergy_; }
+  double maxDisplacement() const { return maxDisplacement_; }
+  double stepExtent() const { return stepExtent_; }
+
+  //! last step's mean point kinetic energy and largest point move (as fraction of
+  //! layout size) both below thresholds
+  bool isConverged(double energyThreshold, double displacementThreshold) const;
+
+ private:
+  // quadtree cell (square), leaf cells hold a list of bodies linked by next_
+  struct Cell {
+    double x     { 0.0 };
+    double y     { 0.0 };
+    double size  { 0.0 };
+    double sx    { 0.0 };  // sum of body positions (centroid is sum/count)
+    double sy    { 0.0 };
+    int    count { 0 };
+    int    child[4] { -1, -1, -1, -1 };
+    int    body  { -1 };
+    bool   leaf  { true };
+  };
+
+  void applyExactRepulsion();
+  void applyExactRepulsionSimd();
+  void applyBarnesHutRepulsion();
+  void applySprings();
+  void applySpringsSimd();
+  void attractToCentre();
+  void updateVelocity(double dt);
+  void updatePosition(double dt);
+
+  void buildTree();
+  void insertBody(int i);
+  int  makeChild(int c, int q);
+  int  cellQuadrant(int c, double x, double y) const;
+
+  void addRepulsion(int i, double x, double y, double n, double &fx, double &fy) const;
+
+ private:
+  using Reals        = std::vector<double, CQGraphAlignedAllocator<double>>;
+  using AlignIndices = std::vector<int, CQGraphAlignedAllocator<int>>;
+  using Cells        = std::vector<Cell>;
+  using Indices      = std::vector<int>;
+
+  Repulsion    repulsionType_   { Repulsion::EXACT };
+  double       theta_           { 0.8 };
+  double       stiffness_       { 400.0 };
+  double       repulsion_       { 400.0 };
+  double       damping_         { 0.5 };
+  double       stepEnergy_      { 0.0 };
+  double       maxDisplacement_ { 0.0 };
+  double       stepExtent_      { 0.0 };
+  bool         simd_            { true };
+  Reals        x_;        // point arrays (by point index)
+  Reals        y_;
+  Reals        vx_;
+  Reals        vy_;
+  Reals        ax_;
+  Reals        ay_;
+  Reals        invMass_;
+  AlignIndices springI1_; // spring arrays (by spring index)
+  AlignIndices springI2_;
+  Reals        springLength_;
+  Cells        cells_;    // Barnes-Hut quadtree (rebuilt each step)
+  Indices      next_;     // next body in leaf cell
+  Indices      stack_;    // tree walk stack
+};
+
+#endif
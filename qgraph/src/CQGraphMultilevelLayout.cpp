@@ -0,0 +1,410 @@
+#include <CQGraphMultilevelLayout.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace {
+
+// coarsening stops when a level keeps more than this fraction of its nodes
+const double minShrink = 0.95;
+
+const int maxLevels = 64;
+
+// consecutive quiet steps (see CQGraphForceLayout::isConverged) to end a level early
+const double energyThreshold       = 0.01;
+const double displacementThreshold = 2.5E-4;
+const int    convergedSteps        = 100;
+
+const double stepSize = 0.01;
+
+// fewest refine steps for a (large) level
+const int minRefineSteps = 30;
+
+}
+
+//---
+
+CQGraphMultilevelLayout::
+CQGraphMultilevelLayout()
+{
+}
+
+void
+CQGraphMultilevelLayout::
+setGraph(int numNodes, const Edges &edges)
+{
+  levels_.clear();
+
+  level_    = 0;
+  numSteps_ = 0;
+
+  WeightedEdges wedges;
+
+  wedges.reserve(edges.size());
+
+  for (const auto &edge : edges) {
+    if (edge.first  < 0 || edge.first  >= numNodes ||
+        edge.second < 0 || edge.second >= numNodes)
+      continue;
+
+    WeightedEdge wedge;
+
+    wedge.n1 = edge.first;
+    wedge.n2 = edge.second;
+
+    wedges.push_back(wedge);
+  }
+
+  levels_.emplace_back();
+
+  auto &level = levels_.back();
+
+  buildLevel(level, numNodes, wedges);
+
+  level.nodeWeights.assign(numNodes, 1.0);
+}
+
+void
+CQGraphMultilevelLayout::
+buildLevel(Level &level, int numNodes, WeightedEdges &edges)
+{
+  // undirected, no self edges, duplicates merged (weights summed)
+  for (auto &edge : edges) {
+    if (edge.n1 > edge.n2)
+      std::swap(edge.n1, edge.n2);
+  }
+
+  edges.erase(std::remove_if(edges.begin(), edges.end(),
+                [](const WeightedEdge &edge) { return edge.n1 == edge.n2; }), edges.end());
+
+  std::sort(edges.begin(), edges.end(), [](const WeightedEdge &lhs, const WeightedEdge &rhs) {
+    return (lhs.n1 != rhs.n1 ? lhs.n1 < rhs.n1 : lhs.n2 < rhs.n2);
+  });
+
+  size_t ne = 0;
+
+  for (size_t i = 0; i < edges.size(); ++i) {
+    if (ne > 0 && edges[ne - 1].n1 == edges[i].n1 && edges[ne - 1].n2 == edges[i].n2)
+      edges[ne - 1].w += edges[i].w;
+    else
+      edges[ne++] = edges[i];
+  }
+
+  edges.resize(ne);
+
+  //---
+
+  // CSR adjacency with edge in both directions
+  level.numNodes = numNodes;
+
+  level.offsets.assign(numNodes + 1, 0);
+
+  for (const auto &edge : edges) {
+    ++level.offsets[edge.n1 + 1];
+    ++level.offsets[edge.n2 + 1];
+  }
+
+  for (int i = 0; i < numNodes; ++i)
+    level.offsets[i + 1] += level.offsets[i];
+
+  level.adjNodes  .resize(level.offsets[numNodes]);
+  level.adjWeights.resize(level.offsets[numNodes]);
+
+  std::vector<int> pos(level.offsets.begin(), level.offsets.end() - 1);
+
+  for (const auto &edge : edges) {
+    level.adjNodes[pos[edge.n1]] = edge.n2; level.adjWeights[pos[edge.n1]++] = edge.w;
+    level.adjNodes[pos[edge.n2]] = edge.n1; level.adjWeights[pos[edge.n2]++] = edge.w;
+  }
+
+  level.x.assign(numNodes, 0.0);
+  level.y.assign(numNodes, 0.0);
+}
+
+void
+CQGraphMultilevelLayout::
+coarsen()
+{
+  if (levels_.empty())
+    return;
+
+  levels_.resize(1);
+
+  while (int(levels_.size()) < maxLevels &&
+         levels_.back().numNodes > minCoarseNodes_ &&
+         coarsenLevel(int(levels_.size()) - 1))
+    ;
+
+  level_ = int(levels_.size()) - 1;
+}
+
+bool
+CQGraphMultilevelLayout::
+coarsenLevel(int l)
+{
+  auto &fine = levels_[l];
+
+  int n = fine.numNodes;
+
+  // heavy edge matching : visit nodes in random order and match each unmatched node
+  // with the unmatched neighbour with largest edge weight relative to node weights
+  // (so merged nodes stay similar in size)
+  std::vector<int> order(n);
+
+  for (int i = 0; i < n; ++i)
+    order[i] = i;
+
+  std::mt19937 rng(l + 1);
+
+  std::shuffle(order.begin(), order.end(), rng);
+
+  std::vector<int> match(n, -1);
+
+  for (int u : order) {
+    if (match[u] >= 0)
+      continue;
+
+    int    best      = -1;
+    double bestScore = 0.0;
+
+    for (int j = fine.offsets[u]; j < fine.offsets[u + 1]; ++j) {
+      int v = fine.adjNodes[j];
+
+      if (match[v] >= 0 || v == u)
+        continue;
+
+      double score = fine.adjWeights[j]/(fine.nodeWeights[u]*fine.nodeWeights[v]);
+
+      if (best < 0 || score > bestScore) {
+        best      = v;
+        bestScore = score;
+      }
+    }
+
+    if (best >= 0) {
+      match[u]    = best;
+      match[best] = u;
+    }
+  }
+
+  //---
+
+  // coarse node for matched pairs and unmatched nodes, except unmatched leaves which
+  // collapse into their (matched) neighbour's coarse node (stars shrink quickly)
+  fine.parent.assign(n, -1);
+
+  int nc = 0;
+
+  for (int u = 0; u < n; ++u) {
+    if (fine.parent[u] >= 0)
+      continue;
+
+    if      (match[u] >= 0) {
+      fine.parent[u]        = nc;
+      fine.parent[match[u]] = nc;
+
+      ++nc;
+    }
+    else if (fine.offsets[u + 1] - fine.offsets[u] == 1)
+      continue;
+    else
+      fine.parent[u] = nc++;
+  }
+
+  for (int u = 0; u < n; ++u) {
+    if (fine.parent[u] < 0)
+      fine.parent[u] = fine.parent[fine.adjNodes[fine.offsets[u]]];
+  }
+
+  if (nc > minShrink*n) {
+    fine.parent.clear();
+    return false;
+  }
+
+  //---
+
+  WeightedEdges edges;
+
+  for (int u = 0; u < n; ++u) {
+    for (int j = fine.offsets[u]; j < fine.offsets[u + 1]; ++j) {
+      int v = fine.adjNodes[j];
+
+      if (v < u)
+        continue;
+
+      WeightedEdge edge;
+
+      edge.n1 = fine.parent[u];
+      edge.n2 = fine.parent[v];
+      edge.w  = fine.adjWeights[j];
+
+      edges.push_back(edge);
+    }
+  }
+
+  Level coarse;
+
+  buildLevel(coarse, nc, edges);
+
+  coarse.nodeWeights.assign(nc, 0.0);
+
+  for (int u = 0; u < n; ++u)
+    coarse.nodeWeights[fine.parent[u]] += fine.nodeWeights[u];
+
+  // fine is invalidated by push
+  levels_.push_back(std::move(coarse));
+
+  return true;
+}
+
+void
+CQGraphMultilevelLayout::
+layoutCoarsest()
+{
+  if (levels_.empty())
+    return;
+
+  level_ = int(levels_.size()) - 1;
+
+  auto &level = levels_[level_];
+
+  std::mt19937 rng(0);
+
+  std::uniform_real_distribution<double> pos(-5.0, 5.0);
+
+  for (int i = 0; i < level.numNodes; ++i) {
+    level.x[i] = pos(rng);
+    level.y[i] = pos(rng);
+  }
+
+  layoutLevel(level_, coarseSteps_);
+}
+
+bool
+CQGraphMultilevelLayout::
+refine()
+{
+  if (level_ <= 0)
+    return false;
+
+  const auto &coarse = levels_[level_];
+  auto       &fine   = levels_[level_ - 1];
+
+  // start each node at its coarse node, scaled for larger graph (area per node kept)
+  // with small jitter to separate merged nodes
+  double s = std::sqrt(double(fine.numNodes)/std::max(coarse.numNodes, 1));
+
+  std::mt19937 rng(level_);
+
+  std::uniform_real_distribution<double> jitter(-0.5, 0.5);
+
+  for (int i = 0; i < fine.numNodes; ++i) {
+    int p = fine.parent[i];
+
+    fine.x[i] = s*coarse.x[p] + jitter(rng);
+    fine.y[i] = s*coarse.y[p] + jitter(rng);
+  }
+
+  --level_;
+
+  // larger levels start closer to their final layout (coarse levels have fixed global
+  // structure) so need fewer of their more expensive steps
+  double f = std::sqrt(double(exactLimit_)/std::max(fine.numNodes, 1));
+
+  int steps = std::max(std::min(int(refineSteps_*f), refineSteps_),
+                       std::min(minRefineSteps, refineSteps_));
+
+  layoutLevel(level_, steps);
+
+  return true;
+}
+
+void
+CQGraphMultilevelLayout::
+layoutLevel(int l, int maxSteps)
+{
+  auto &level = levels_[l];
+
+  CQGraphForceLayout layout;
+
+  layout.setRepulsionType(level.numNodes > exactLimit_ ?
+    CQGraphForceLayout::Repulsion::BARNES_HUT : CQGraphForceLayout::Repulsion::EXACT);
+
+  layout.setTheta(theta_);
+
+  layout.reserve(level.numNodes, level.offsets[level.numNodes]/2);
+
+  for (int i = 0; i < level.numNodes; ++i)
+    layout.addPoint(level.x[i], level.y[i]);
+
+  for (int u = 0; u < level.numNodes; ++u) {
+    for (int j = level.offsets[u]; j < level.offsets[u + 1]; ++j) {
+      if (level.adjNodes[j] > u)
+        layout.addSpring(u, level.adjNodes[j]);
+    }
+  }
+
+  int quietSteps = 0;
+
+  for (int i = 0; i < maxSteps; ++i) {
+    if (stop_ && *stop_)
+      break;
+
+    layout.step(stepSize);
+
+    ++numSteps_;
+
+    if (layout.isConverged(energyThreshold, displacementThreshold))
+      ++quietSteps;
+    else
+      quietSteps = 0;
+
+    if (quietSteps >= convergedSteps)
+      break;
+  }
+
+  for (int i = 0; i < level.numNodes; ++i) {
+    level.x[i] = layout.x(i);
+    level.y[i] = layout.y(i);
+  }
+}
+
+void
+CQGraphMultilevelLayout::
+positions(Reals &x, Reals &y) const
+{
+  if (levels_.empty()) {
+    x.clear(); y.clear();
+    return;
+  }
+
+  int n = levels_[0].numNodes;
+
+  x.resize(n);
+  y.resize(n);
+
+  const auto &level = levels_[level_];
+
+  for (int i = 0; i < n; ++i) {
+    int a = i;
+
+    for (int l = 0; l < level_; ++l)
+      a = levels_[l].parent[a];
+
+    x[i] = level.x[a];
+    y[i] = level.y[a];
+  }
+}
+
+void
+CQGraphMultilevelLayout::
+run()
+{
+  coarsen();
+
+  layoutCoarsest();
+
+  while (! (stop_ && *stop_) && refine())
+    ;
+}
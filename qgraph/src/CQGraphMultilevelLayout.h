@@ -0,0 +1,123 @@
+#ifndef CQGraphMultilevelLayout_H
+#define CQGraphMultilevelLayout_H
+
+#include <CQGraphForceLayout.h>
+
+#include <atomic>
+#include <vector>
+
+/*!
+ * Multilevel (coarsen, layout, refine) force directed layout.
+ *
+ * The graph (dense node index, undirected edges) is repeatedly coarsened by heavy edge
+ * matching, with unmatched leaf nodes collapsed into their neighbour, until it is small
+ * or stops shrinking. The coarsest graph is laid out with a force layout and then each
+ * finer level starts from its coarse node's position (scaled for the larger graph) and
+ * is refined with a limited number of force layout steps (Barnes-Hut for large levels).
+ *
+ * Each level has about half the nodes of the one below so total cost is close to that
+ * of the refinement steps at the finest level.
+ */
+class CQGraphMultilevelLayout {
+ public:
+  using Edge  = std::pair<int, int>;
+  using Edges = std::vector<Edge>;
+  using Reals = std::vector<double>;
+
+ public:
+  CQGraphMultilevelLayout();
+
+  //! coarsening stops at this many nodes
+  int minCoarseNodes() const { return minCoarseNodes_; }
+  void setMinCoarseNodes(int i) { minCoarseNodes_ = i; }
+
+  //! max layout steps for coarsest level and for each refined level (reduced for
+  //! levels larger than exact limit)
+  int coarseSteps() const { return coarseSteps_; }
+  void setCoarseSteps(int i) { coarseSteps_ = i; }
+
+  int refineSteps() const { return refineSteps_; }
+  void setRefineSteps(int i) { refineSteps_ = i; }
+
+  //! levels with more nodes use Barnes-Hut repulsion
+  int exactLimit() const { return exactLimit_; }
+  void setExactLimit(int i) { exactLimit_ = i; }
+
+  double theta() const { return theta_; }
+  void setTheta(double r) { theta_ = r; }
+
+  //! stop flag checked between steps (layout is left as is)
+  void setStopFlag(const std::atomic<bool> *stop) { stop_ = stop; }
+
+  //---
+
+  //! set graph (edge direction, self edges and duplicates are ignored)
+  void setGraph(int numNodes, const Edges &edges);
+
+  //! build coarser levels
+  void coarsen();
+
+  int numLevels() const { return int(levels_.size()); }
+
+  //! current level (0 is input graph)
+  int level() const { return level_; }
+
+  int levelNodes(int l) const { return levels_[l].numNodes; }
+
+  //! lay out coarsest level (sets current level)
+  void layoutCoarsest();
+
+  //! refine to next finer level (returns false if already at input level)
+  bool refine();
+
+  //! total force layout steps done
+  int numSteps() const { return numSteps_; }
+
+  //! input node positions (position of node's ancestor at current level)
+  void positions(Reals &x, Reals &y) const;
+
+  //! coarsen, layout and refine to input level
+  void run();
+
+ private:
+  // undirected graph level (CSR adjacency with both directions)
+  struct Level {
+    int              numNodes { 0 };
+    std::vector<int> offsets;      // adjacency offsets (numNodes + 1)
+    std::vector<int> adjNodes;
+    Reals            adjWeights;   // number of input edges merged into edge
+    Reals            nodeWeights;  // number of input nodes merged into node
+    std::vector<int> parent;       // node in next coarser level
+    Reals            x;
+    Reals            y;
+  };
+
+  struct WeightedEdge {
+    int    n1 { 0 };
+    int    n2 { 0 };
+    double w  { 1.0 };
+  };
+
+  using WeightedEdges = std::vector<WeightedEdge>;
+
+  static void buildLevel(Level &level, int numNodes, WeightedEdges &edges);
+
+  bool coarsenLevel(int l);
+
+  void layoutLevel(int l, int maxSteps);
+
+ private:
+  using Levels = std::vector<Level>;
+
+  int                      minCoarseNodes_ { 32 };
+  int                      coarseSteps_    { 2000 };
+  int                      refineSteps_    { 300 };
+  int                      exactLimit_     { 1000 };
+  double                   theta_          { 0.8 };
+  const std::atomic<bool>* stop_           { nullptr };
+  Levels                   levels_;
+  int                      level_          { 0 };
+  int                      numSteps_       { 0 };
+};
+
+#endif
@@ -0,0 +1,375 @@
+#include <CQGraphViz.h>
+#include <CQGraphVizRenderer.h>
+
+#include <QGuiApplication>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QPainter>
+#include <QImage>
+#include <QSvgGenerator>
+#include <QPdfWriter>
+#include <QFileInfo>
+#include <QDir>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+
+// Headless renderer : render dot/json graph files to image files without a window.
+//
+// Files are rendered in parallel (one pool job per file). Each job loads and draws
+// its own App so jobs share nothing but the fitted font cache.
+
+namespace {
+
+enum class Format {
+  AUTO,
+  JSON,
+  DOT
+};
+
+enum class OutFormat {
+  PNG,
+  SVG,
+  PDF
+};
+
+struct Options {
+  Format    format    { Format::AUTO };
+  OutFormat outFormat { OutFormat::PNG };
+  QString   outDir    { "." };
+  QString   cacheDir;          // binary scene cache directory (empty for none)
+  int       width     { 0 };   // pixel size (0 for bbox size times scale)
+  int       height    { 0 };
+  double    scale     { 1.0 }; // pixels per point (if no size)
+  int       margin    { 8 };
+  bool      debug     { false };
+};
+
+std::mutex outputMutex;
+
+void
+outputMsg(const std::string &msg)
+{
+  std::lock_guard<std::mutex> lock(outputMutex);
+
+  std::cerr << msg << "\n";
+}
+
+// output file name for each input file (input base name in output dir). Inputs with the
+// same base name (e.g. a/g.gv and b/g.gv or g.gv and g.json) would be written to the same
+// file by parallel jobs so later ones get a numbered name (g_1.png, ...)
+std::vector<QString>
+outputFilenames(const std::vector<std::string> &filenames, const Options &options)
+{
+  QString suffix;
+
+  if      (options.outFormat == OutFormat::SVG) suffix = "svg";
+  else if (options.outFormat == OutFormat::PDF) suffix = "pdf";
+  else                                          suffix = "png";
+
+  QDir outDir(options.outDir);
+
+  std::set<QString> used;
+
+  std::vector<QString> outFilenames;
+
+  for (const auto &filename : filenames) {
+    auto base = QFileInfo(QString::fromStdString(filename)).completeBaseName();
+
+    auto outFilename = outDir.filePath(base + "." + suffix);
+
+    for (int n = 1; used.find(outFilename) != used.end(); ++n)
+      outFilename = outDir.filePath(base + "_" + QString::number(n) + "." + suffix);
+
+    if (outFilename != outDir.filePath(base + "." + suffix))
+      std::cerr << "Output for '" << filename << "' renamed to '" <<
+                   outFilename.toStdString() << "' (duplicate name)\n";
+
+    used.insert(outFilename);
+
+    outFilenames.push_back(outFilename);
+  }
+
+  return outFilenames;
+}
+
+bool
+renderFile(const std::string &filename, const QString &outFilename, const Options &options,
+           CQGraphViz::FitFontCache *fitFonts)
+{
+  CQGraphViz::App app;
+
+  app.setDebug(options.debug);
+  app.setCacheDir(options.cacheDir.toStdString());
+
+  auto format = options.format;
+
+  if (format == Format::AUTO)
+    format = (QFileInfo(QString::fromStdString(filename)).suffix().toLower() == "json" ?
+              Format::JSON : Format::DOT);
+
+  bool rc = (format == Format::JSON ? app.processJson(filename) : app.processDot(filename));
+
+  if (! rc) {
+    outputMsg("Failed to load '" + filename + "'");
+    return false;
+  }
+
+  //---
+
+  // scene bbox (loaded bbox may be unset for plain dot without layout)
+  auto bbox = app.bbox();
+
+  if (! bbox.isValid())
+    bbox = app.spatialIndex().bbox();
+
+  if (! bbox.isValid()) {
+    outputMsg("No drawable objects in '" + filename + "'");
+    return false;
+  }
+
+  //---
+
+  // image size (scaled bbox or specified size, other dimension from aspect)
+  int w = options.width;
+  int h = options.height;
+
+  double aspect = bbox.width()/std::max(bbox.height(), 1E-6);
+
+  if      (w <= 0 && h <= 0) {
+    w = int(std::ceil(bbox.width ()*options.scale)) + 2*options.margin;
+    h = int(std::ceil(bbox.height()*options.scale)) + 2*options.margin;
+  }
+  else if (w <= 0)
+    w = int(std::ceil((h - 2*options.margin)*aspect)) + 2*options.margin;
+  else if (h <= 0)
+    h = int(std::ceil((w - 2*options.margin)/aspect)) + 2*options.margin;
+
+  w = std::max(w, 1);
+  h = std::max(h, 1);
+
+  //---
+
+  auto font = QGuiApplication::font();
+
+  if (app.fontSize() > 0)
+    font.setPointSizeF(app.fontSize());
+
+  CQGraphViz::Renderer renderer(&app);
+
+  renderer.setTransform(CQGraphViz::Renderer::fitTransform(bbox, QSizeF(w, h), options.margin));
+  renderer.setFont(font);
+  renderer.setSharedFitFonts(fitFonts);
+  renderer.setHighlight(false);
+
+  auto drawScene = [&](QPainter *painter) {
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setRenderHint(QPainter::TextAntialiasing);
+
+    painter->fillRect(QRectF(0, 0, w, h), QColor(255, 255, 255));
+
+    renderer.draw(painter, QRectF(0, 0, w, h));
+  };
+
+  //---
+
+  if      (options.outFormat == OutFormat::SVG) {
+    QSvgGenerator generator;
+
+    generator.setFileName(outFilename);
+    generator.setSize    (QSize(w, h));
+    generator.setViewBox (QRect(0, 0, w, h));
+    generator.setTitle   (QFileInfo(outFilename).completeBaseName());
+
+    QPainter painter;
+
+    if (! painter.begin(&generator)) {
+      outputMsg("Failed to write '" + outFilename.toStdString() + "'");
+      return false;
+    }
+
+    drawScene(&painter);
+
+    painter.end();
+  }
+  else if (options.outFormat == OutFormat::PDF) {
+    QPdfWriter writer(outFilename);
+
+    // one point per pixel
+    writer.setResolution(72);
+    writer.setPageSize(QPageSize(QSizeF(w, h), QPageSize::Point));
+    writer.setPageMargins(QMarginsF(0, 0, 0, 0));
+
+    QPainter painter;
+
+    if (! painter.begin(&writer)) {
+      outputMsg("Failed to write '" + outFilename.toStdString() + "'");
+      return false;
+    }
+
+    drawScene(&painter);
+
+    painter.end();
+  }
+  else {
+    QImage image(w, h, QImage::Format_ARGB32_Premultiplied);
+
+    QPainter painter(&image);
+
+    drawScene(&painter);
+
+    painter.end();
+
+    if (! image.save(outFilename, "PNG")) {
+      outputMsg("Failed to write '" + outFilename.toStdString() + "'");
+      return false;
+    }
+  }
+
+  if (options.debug)
+    outputMsg(filename + " -> " + outFilename.toStdString());
+
+  return true;
+}
+
+//---
+
+// render one file on the pool
+class RenderJob : public QRunnable {
+ public:
+  RenderJob(const std::string &filename, const QString &outFilename, const Options &options,
+            CQGraphViz::FitFontCache *fitFonts, std::atomic<int> &numFailed) :
+   filename_(filename), outFilename_(outFilename), options_(options), fitFonts_(fitFonts),
+   numFailed_(numFailed) {
+  }
+
+  void run() override {
+    if (! renderFile(filename_, outFilename_, options_, fitFonts_))
+      ++numFailed_;
+  }
+
+ private:
+  std::string               filename_;
+  QString                   outFilename_;
+  const Options&            options_;
+  CQGraphViz::FitFontCache* fitFonts_ { nullptr };
+  std::atomic<int>&         numFailed_;
+};
+
+}
+
+//---
+
+int
+main(int argc, char **argv)
+{
+  // no window system needed
+  if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+
+  QGuiApplication app(argc, argv);
+
+  std::vector<std::string> files;
+
+  Options options;
+
+  int numThreads = QThread::idealThreadCount();
+
+  for (int i = 1; i < argc; ++i) {
+    if (argv[i][0] == '-') {
+      auto arg = std::string(&argv[i][1]);
+
+      auto intArg = [&](int &value) {
+        if (i + 1 < argc)
+          value = std::atoi(argv[++i]);
+        else
+          std::cerr << "Missing value for '" << arg << "'\n";
+      };
+
+      if      (arg == "json")
+        options.format = Format::JSON;
+      else if (arg == "dot" || arg == "xdot")
+        options.format = Format::DOT;
+      else if (arg == "png")
+        options.outFormat = OutFormat::PNG;
+      else if (arg == "svg")
+        options.outFormat = OutFormat::SVG;
+      else if (arg == "pdf")
+        options.outFormat = OutFormat::PDF;
+      else if (arg == "o" || arg == "out_dir") {
+        if (i + 1 < argc)
+          options.outDir = argv[++i];
+        else
+          std::cerr << "Missing value for '" << arg << "'\n";
+      }
+      else if (arg == "cache") {
+        if (i + 1 < argc)
+          options.cacheDir = argv[++i];
+        else
+          std::cerr << "Missing value for '" << arg << "'\n";
+      }
+      else if (arg == "width")
+        intArg(options.width);
+      else if (arg == "height")
+        intArg(options.height);
+      else if (arg == "margin")
+        intArg(options.margin);
+      else if (arg == "scale") {
+        if (i + 1 < argc)
+          options.scale = std::max(std::atof(argv[++i]), 1E-3);
+        else
+          std::cerr << "Missing value for '" << arg << "'\n";
+      }
+      else if (arg == "threads")
+        intArg(numThreads);
+      else if (arg == "debug")
+        options.debug = true;
+      else if (arg == "h" || arg == "help") {
+        std::cerr << "CQGraphVizRender [-json|-dot] [-png|-svg|-pdf] [-o <dir>] "
+                     "[-width <w>] [-height <h>] [-scale <s>] [-margin <m>] "
+                     "[-threads <n>] [-cache <dir>] [-debug] <files>\n";
+        return 0;
+      }
+      else
+        std::cerr << "Invalid options '" << arg << "'\n";
+    }
+    else
+      files.push_back(argv[i]);
+  }
+
+  if (files.empty()) {
+    std::cerr << "No input files\n";
+    return 1;
+  }
+
+  if (! QDir().mkpath(options.outDir)) {
+    std::cerr << "Failed to create '" << options.outDir.toStdString() << "'\n";
+    return 1;
+  }
+
+  //---
+
+  CQGraphViz::FitFontCache fitFonts(QGuiApplication::font());
+
+  std::atomic<int> numFailed { 0 };
+
+  QThreadPool pool;
+
+  pool.setMaxThreadCount(std::max(numThreads, 1));
+
+  // unique output names (computed before jobs start)
+  auto outFilenames = outputFilenames(files, options);
+
+  for (size_t i = 0; i < files.size(); ++i)
+    pool.start(new RenderJob(files[i], outFilenames[i], options, &fitFonts, numFailed));
+
+  pool.waitForDone();
+
+  return (numFailed > 0 ? 1 : 0);
+}
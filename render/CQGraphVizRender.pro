@@ -0,0 +1,39 @@
+TEMPLATE = app
+
+QT += gui svg
+
+TARGET = CQGraphVizRender
+
+DEPENDPATH += .
+
+MOC_DIR = .moc
+
+QMAKE_CXXFLAGS += -std=c++17
+
+CONFIG += debug
+
+SOURCES += \
+CQGraphVizRender.cpp \
+
+DESTDIR     = ../bin
+OBJECTS_DIR = ../obj
+LIB_DIR     = ../lib
+
+PRE_TARGETDEPS = \
+$(LIB_DIR)/libCQGraphViz.a \
+
+INCLUDEPATH = \
+. \
+../include \
+
+unix:LIBS += \
+-L$$LIB_DIR \
+-L../../CQGraphViz/lib \
+-L../../CQDot/graphviz/lib \
+-L../../CUtil/lib \
+-L../../CFile/lib \
+-L../../CStrUtil/lib \
+-L../../COS/lib \
+\
+-lCQGraphViz -lCGraphViz \
+-lCFile -lCUtil -lCStrUtil -lCOS
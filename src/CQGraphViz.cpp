@@ -1,11 +1,15 @@
 #include <CQGraphViz.h>
-#include <CJson.h>
+#include <CQGraphVizJson.h>
 #include <CDotParse.h>
 //#include <CStrParse.h>
 
 #include <QPainterPath>
 #include <QRectF>
 
+#include <algorithm>
+#include <iostream>
+#include <string_view>
+
 //---
 
 namespace CQGraphViz {
@@ -16,2029 +20,1379 @@ App()
   root_ = std::make_shared<Object>();
 }
 
-bool
-App::
-processJson(const std::string &filename)
+//---
+
+namespace {
+
+using Points = App::Points;
+
+QString toQString(std::string_view str)
+{
+  return QString::fromUtf8(str.data(), int(str.size()));
+}
+
+bool decodeReal(std::string_view str, double &r)
+{
+  bool ok;
+
+  r = toQString(str).toDouble(&ok);
+
+  return ok;
+}
+
+bool decodePos(std::string_view str, QPointF &p)
 {
-  auto *json = new CJson;
+  auto strs = toQString(str).split(",");
+
+  if (strs.size() != 2)
+    return false;
+
+  bool ok1, ok2;
+
+  auto x = strs[0].toDouble(&ok1);
+  auto y = strs[1].toDouble(&ok2);
+
+  p = QPointF(x, y);
+
+  return (ok1 && ok2);
+}
 
-  CJson::ValueP value;
+bool stringToRect(std::string_view str, QRectF &rect)
+{
+  auto strs = toQString(str).split(",");
 
-  if (! json->loadFile(filename.c_str(), value)) {
-    errorMsg("Parse failed");
+  if (strs.size() != 4)
     return false;
+
+  bool ok1, ok2, ok3, ok4;
+
+  auto x1 = strs[0].toDouble(&ok1);
+  auto y1 = strs[1].toDouble(&ok2);
+  auto x2 = strs[2].toDouble(&ok3);
+  auto y2 = strs[3].toDouble(&ok4);
+
+  rect = QRectF(x1, y1, x2 - x1, y2 - y1);
+
+  return (ok1 && ok2 && ok3 && ok4);
+}
+
+int getHexValue(std::string_view str)
+{
+  static std::string xchars = "0123456789abcdef";
+
+  int hvalue = 0;
+
+  for (auto c : str) {
+    char c1 = char(std::tolower(c));
+
+    auto p = xchars.find(c1);
+
+    hvalue = hvalue*16 + int(p);
   }
 
-  auto decodePoints = [](CJson::Array *array) {
-    std::vector<double> coords;
+  return hvalue;
+}
 
-    for (const auto &point : array->values()) {
-      auto *pointArray = point->cast<CJson::Array>();
+QColor decodeColor(std::string_view str)
+{
+  QColor color;
 
-      for (const auto &xy : pointArray->values()) {
-        auto p = xy->cast<CJson::Number>()->value();
+  // #rrggbbaa
+  if (str.size() == 9) {
+    color = toQString(str.substr(0, 7));
 
-        coords.push_back(p);
-      }
-    }
+    color.setAlpha(getHexValue(str.substr(7)));
+  }
+  else
+    color = toQString(str);
 
-    Points points;
+  return color;
+}
 
-    size_t np = coords.size()/2;
+bool decodeStyle(std::string_view str, StyleData &style)
+{
+  if      (str == "solid") {
+    style.lineStyle = LineStyle::SOLID;
+  }
+  else if (str == "dotted") {
+    style.lineStyle = LineStyle::DOTTED;
+  }
+  else if (str == "dashed") {
+    style.lineStyle = LineStyle::DASHED;
+  }
+  else if (str.substr(0, 13) == "setlinewidth(") {
+    size_t n = str.size();
 
-    for (size_t ip = 0; ip < np; ++ip) {
-      double x = coords[ip*2 + 0];
-      double y = coords[ip*2 + 1];
+    std::string sstr;
 
-      QPointF p(x, y);
+    for (size_t i = 13; i < n && std::isdigit(str[i]); ++i)
+      sstr += str[i];
 
-      points.push_back(p);
-    }
+    if (sstr.empty())
+      return false;
 
-    return points;
-  };
+    style.lineWidth = std::stoi(sstr);
+  }
+  else
+    return false;
 
-  auto pointsToPath = [](const Points &points) {
-    QPainterPath path;
+  return true;
+}
 
-    size_t np = points.size();
+bool decodeAlign(std::string_view str, Qt::Alignment &align)
+{
+  if      (str == "l")
+    align = Qt::AlignLeft;
+  else if (str == "c")
+    align = Qt::AlignHCenter;
+  else if (str == "r")
+    align = Qt::AlignRight;
+  else
+    return false;
 
-    for (size_t ip = 0; ip < np; ++ip) {
-      auto &p = points[ip];
+  return true;
+}
 
-      if (ip == 0)
-        path.moveTo(p);
-      else
-        path.lineTo(p);
-    }
+QPainterPath pointsToPath(const Points &points)
+{
+  QPainterPath path;
 
-    return path;
-  };
+  size_t np = points.size();
 
-  auto pointsToBSpline = [](const Points &points) {
-    QPainterPath path;
+  for (size_t ip = 0; ip < np; ++ip) {
+    auto &p = points[ip];
 
-    size_t np = points.size();
+    if (ip == 0)
+      path.moveTo(p);
+    else
+      path.lineTo(p);
+  }
 
-    for (size_t ip = 0; ip < np; ++ip) {
-      auto &p = points[ip];
+  return path;
+}
 
-      if      (ip == 0)
-        path.moveTo(p);
-      else if (ip < np - 2) {
-        path.cubicTo(p, points[ip + 1], points[ip + 2]);
+QPainterPath pointsToBSpline(const Points &points)
+{
+  QPainterPath path;
 
-        ip += 2;
-      }
-      else
-        path.lineTo(p);
+  size_t np = points.size();
+
+  for (size_t ip = 0; ip < np; ++ip) {
+    auto &p = points[ip];
+
+    if      (ip == 0)
+      path.moveTo(p);
+    else if (ip + 2 < np) {
+      path.cubicTo(p, points[ip + 1], points[ip + 2]);
+
+      ip += 2;
     }
+    else
+      path.lineTo(p);
+  }
 
-    return path;
-  };
+  return path;
+}
 
-  auto decodeRect = [](CJson::Array *array) {
-    std::vector<double> coords;
+QPainterPath rectToEllipse(const QRectF &rect)
+{
+  QPainterPath path;
 
-    for (const auto &point : array->values()) {
-      auto p = point->cast<CJson::Number>()->value();
+  path.addEllipse(rect);
 
-      coords.push_back(p);
-    }
+  return path;
+}
 
-    assert(coords.size() == 4);
+}
 
-    return QRectF(coords[0] - coords[2], coords[1] - coords[3], 2*coords[2], 2*coords[3]);
-  };
+//---
 
-  auto rectToEllipse = [](const QRectF &rect) {
-    QPainterPath path;
+/*!
+ * Applies a sequence of xdot draw operations to an object.
+ *
+ * Each operation is an op code followed by its fields. Color, style and font state
+ * carries over between operations of the same draw attribute, colors are reset once
+ * used by a shape or text.
+ *
+ * ops:
+ *  "cC" : pen/fill color
+ *  "S"  : style
+ *  "F"  : font
+ *  "tT" : text
+ *  "pP" : polygon
+ *  "eE" : ellipse
+ *  "bB" : bspline
+ *  "L"  : polyline
+ */
+class DrawBuilder {
+ public:
+  DrawBuilder(App *app) :
+   app_(app) {
+  }
 
-    path.addEllipse(rect);
+  //! start draw attribute (name used in messages), the root object only takes its
+  //! rect from polylines and ellipses
+  void begin(Object *object, const std::string &name, bool isRoot) {
+    object_ = object;
+    name_   = name;
+    isRoot_ = isRoot;
+    op_     = '\0';
+
+    colorData_ = App::ColorData();
+    styleData_ = StyleData();
+    textData_  = TextData();
+  }
 
-    return path;
-  };
+  void setOp(std::string_view op) {
+    op_ = (op.size() == 1 ? op[0] : '?');
+  }
 
-  auto decodePoint = [](CJson::Array *array) {
-    std::vector<double> coords;
+  void setGrad(std::string_view grad) {
+    if (op_ == 'c' || op_ == 'C')
+      colorData_.grad = std::string(grad);
+    else
+      unhandled("grad");
+  }
 
-    for (const auto &point : array->values()) {
-      auto p = point->cast<CJson::Number>()->value();
+  void setColor(std::string_view str) {
+    auto color = decodeColor(str);
+
+    if      (op_ == 'C')
+      colorData_.bg = color;
+    else if (op_ == 'c')
+      colorData_.fg = color;
+    else
+      unhandled("color");
+  }
 
-      coords.push_back(p);
+  void setStyle(std::string_view style) {
+    if (op_ == 'S') {
+      if (! style.empty() && ! decodeStyle(style, styleData_))
+        app_->errorMsg("Invalid style: " + std::string(style));
     }
+    else
+      unhandled("style");
+  }
 
-    assert(coords.size() == 2);
+  void setFontSize(double size) {
+    if (op_ == 'F')
+      textData_.size = size;
+    else
+      unhandled("size");
+  }
 
-    QPointF p(coords[0], coords[1]);
+  void setFontFace(std::string_view face) {
+    if (op_ == 'F')
+      textData_.face = toQString(face);
+  }
 
-    return p;
-  };
+  void setTextPos(const QPointF &pos) {
+    if (op_ == 't' || op_ == 'T')
+      textData_.pos = pos;
+    else
+      unhandled("pt");
+  }
 
-  auto decodePos = [&](const std::string &s) {
-    auto qstr = QString::fromStdString(s);
+  void setTextAlign(Qt::Alignment align) {
+    if (op_ == 't' || op_ == 'T')
+      textData_.align = align;
+    else
+      unhandled("align");
+  }
 
-    auto strs = qstr.split(",");
+  void setTextWidth(double width) {
+    if (op_ == 't' || op_ == 'T')
+      textData_.width = width;
+    else
+      unhandled("width");
+  }
 
-    if (strs.size() == 2) {
-      bool ok;
+  void setText(std::string_view text) {
+    if (op_ == 't' || op_ == 'T') {
+      textData_.fg   = colorData_.fg;
+      textData_.text = toQString(text);
 
-      auto x = strs[0].toDouble(&ok); assert(ok);
-      auto y = strs[1].toDouble(&ok); assert(ok);
+      object_->addText(textData_);
 
-      return QPointF(x, y);
+      colorData_.reset();
     }
-    else {
-      errorMsg("Unhandled pos: " + s);
-      return QPointF();
+    else
+      unhandled("text");
+  }
+
+  void setPoints(const Points &points) {
+    if      (op_ == 'P' || op_ == 'p') {
+      PathData pathData;
+
+      pathData.bg    = colorData_.bg;
+      pathData.fg    = colorData_.fg;
+      pathData.style = styleData_;
+      pathData.path  = pointsToPath(points);
+
+      pathData.closePath();
+
+      object_->addPath(pathData);
+
+      if (! isRoot_)
+        object_->setRect(pathData.path.boundingRect());
+
+      colorData_.reset();
     }
-  };
+    else if (op_ == 'b') {
+      // filled bspline
+      PathData bspline;
 
-  auto decodeRealString = [](const std::string &s) {
-    auto qstr = QString::fromStdString(s);
+      bspline.bg    = colorData_.bg;
+      bspline.fg    = colorData_.fg;
+      bspline.style = styleData_;
+      bspline.path  = pointsToBSpline(points);
 
-    bool ok;
-    double r = qstr.toDouble(&ok); assert(ok);
+      bspline.closePath();
 
-    return r;
-  };
+      object_->addPath(bspline);
 
-  auto getHexValue = [](const std::string &str) {
-    static std::string xchars = "0123456789abcdef";
+      if (! isRoot_)
+        object_->setRect(bspline.path.boundingRect());
 
-    size_t len = str.size();
+      colorData_.reset();
+    }
+    else if (op_ == 'B' || op_ == 'L') {
+      // unfilled bspline or (open) polyline
+      PathData line;
 
-    int hvalue = 0;
+      line.fg    = colorData_.fg;
+      line.style = styleData_;
+      line.path  = (op_ == 'B' ? pointsToBSpline(points) : pointsToPath(points));
 
-    for (size_t i = 0; i < len; ++i) {
-      char c1 = char(std::tolower(str[i]));
+      object_->addLine(line);
 
-      auto p = xchars.find(c1);
+      if (! isRoot_ || op_ == 'L')
+        object_->setRect(line.path.boundingRect());
 
-      hvalue = hvalue*16 + int(p);
+      colorData_.reset();
     }
+    else
+      unhandled("points for op " + std::string(1, op_));
+  }
 
-    return hvalue;
-  };
+  void setEllipse(const QRectF &rect) {
+    if (op_ == 'E' || op_ == 'e') {
+      PathData ellipse;
 
-  auto decodeColor = [&](const std::string &str) {
-    QColor color;
+      ellipse.bg    = colorData_.bg;
+      ellipse.fg    = colorData_.fg;
+      ellipse.style = styleData_;
+      ellipse.path  = rectToEllipse(rect);
 
-    if (str.size() == 9) {
-      color = QString::fromStdString(str.substr(0, 7));
+      ellipse.closePath();
 
-      auto alpha = getHexValue(str.substr(7));
+      object_->addPath(ellipse);
 
-      color.setAlpha(alpha);
+      object_->setRect(rect);
+
+      colorData_.reset();
     }
     else
-      color = QString::fromStdString(str);
+      unhandled("rect");
+  }
 
-    return color;
-  };
+ private:
+  void unhandled(const std::string &what) const {
+    app_->errorMsg(" " + name_ + " unhandled " + what);
+  }
 
-  auto decodeStyle = [&](const std::string &str, StyleData &style) {
-    if      (str == "solid") {
-      style.lineStyle = LineStyle::SOLID;
-    }
-    else if (str == "dotted") {
-      style.lineStyle = LineStyle::DOTTED;
+ private:
+  App*           app_    { nullptr };
+  Object*        object_ { nullptr };
+  std::string    name_;
+  bool           isRoot_ { false };
+  char           op_     { '\0' };
+  App::ColorData colorData_;
+  StyleData      styleData_;
+  TextData       textData_;
+};
+
+//---
+
+/*!
+ * Builds app objects from streamed 'dot -Tjson' parse events in a single pass.
+ *
+ * Keys are interned to a Key enum by one table lookup and dispatched with a switch
+ * on the current parse state. Known attributes which are not used are skipped.
+ */
+class JsonLoader : public JsonHandler {
+ public:
+  JsonLoader(App *app) :
+   app_(app), draw_(app) {
+    states_.push_back(State::TOP);
+  }
+
+  bool startObject() override {
+    if (skipEvent(1)) return true;
+
+    switch (state()) {
+      case State::TOP:
+        pushState(State::ROOT);
+        break;
+      case State::OBJECTS:
+        object_ = std::make_shared<Object>();
+
+        object_->setType(Object::Type::OBJECT);
+
+        pushState(State::OBJECT);
+        break;
+      case State::EDGES:
+        object_ = std::make_shared<Object>();
+
+        object_->setType(Object::Type::EDGE);
+
+        pushState(State::EDGE);
+        break;
+      case State::DRAW_OPS:
+        pushState(State::DRAW_OP);
+        break;
+      default:
+        return invalidValue(1);
     }
-    else if (str == "dashed") {
-      style.lineStyle = LineStyle::DASHED;
+
+    return true;
+  }
+
+  bool endObject() override {
+    if (skipEvent(-1)) return true;
+
+    switch (state()) {
+      case State::OBJECT:
+        app_->addObject(object_);
+
+        object_.reset();
+        break;
+      case State::EDGE:
+        app_->edges_.push_back(object_);
+
+        object_.reset();
+        break;
+      default:
+        break;
     }
-    else if (str.substr(0, 13) == "setlinewidth(") {
-      size_t n = str.size();
 
-      std::string sstr;
+    popState();
 
-      for (size_t i = 13; i < n && std::isdigit(str[i]); ++i)
-        sstr += str[i];
+    return true;
+  }
 
-      style.lineWidth = std::stoi(sstr);
+  bool startArray() override {
+    if (skipEvent(1)) return true;
+
+    switch (state()) {
+      case State::ROOT:
+        switch (key_) {
+          case Key::OBJECTS: pushState(State::OBJECTS); break;
+          case Key::EDGES  : pushState(State::EDGES  ); break;
+          case Key::DRAW   : beginDraw(app_->root_.get(), "_draw_" , true); break;
+          case Key::LDRAW  : beginDraw(app_->root_.get(), "_ldraw_", true); break;
+          default          : return invalidValue(1);
+        }
+        break;
+      case State::OBJECT:
+        switch (key_) {
+          case Key::DRAW : beginDraw(object_.get(), "objects/_draw_" , false); break;
+          case Key::LDRAW: beginDraw(object_.get(), "objects/_ldraw_", false); break;
+          default        : return invalidValue(1);
+        }
+        break;
+      case State::EDGE:
+        switch (key_) {
+          case Key::DRAW  : beginDraw(object_.get(), "edges/_draw_"  , false); break;
+          case Key::LDRAW : beginDraw(object_.get(), "edges/_ldraw_" , false); break;
+          case Key::HDRAW : beginDraw(object_.get(), "edges/_hdraw_" , false); break;
+          case Key::HLDRAW: beginDraw(object_.get(), "edges/_hldraw_", false); break;
+          case Key::TDRAW : beginDraw(object_.get(), "edges/_tdraw_" , false); break;
+          case Key::TLDRAW: beginDraw(object_.get(), "edges/_tldraw_", false); break;
+          default         : return invalidValue(1);
+        }
+        break;
+      case State::DRAW_OP:
+        switch (key_) {
+          case Key::PT:
+          case Key::POINTS:
+          case Key::RECT:
+            coords_.clear();
+
+            coordsDepth_ = 1;
+
+            pushState(State::COORDS);
+            break;
+          default:
+            return invalidValue(1);
+        }
+        break;
+      case State::COORDS:
+        ++coordsDepth_;
+        break;
+      default:
+        return invalidValue(1);
     }
-    else {
-      errorMsg("Invalid style: " + str);
+
+    return true;
+  }
+
+  bool endArray() override {
+    if (skipEvent(-1)) return true;
+
+    if (state() == State::COORDS) {
+      if (--coordsDepth_ > 0)
+        return true;
+
+      popState();
+
+      addCoords();
     }
-  };
+    else
+      popState();
 
-  auto decodeAlign = [&](const std::string &str) {
-    if      (str == "l")
-      return Qt::AlignLeft;
-    else if (str == "c")
-      return Qt::AlignHCenter;
-    else if (str == "r")
-      return Qt::AlignRight;
-    else {
-      errorMsg("Invalid align: " + str);
-      return Qt::AlignHCenter;
+    return true;
+  }
+
+  bool key(std::string_view name) override {
+    if (skipEvent(0)) return true;
+
+    auto keyData = lookupKey(name);
+
+    key_ = keyData.key;
+
+    // interned key must be handled at this level, otherwise skip value
+    // (quietly for known unused attributes)
+    int         ignore = 0;
+    const char *prefix = "";
+
+    switch (state()) {
+      case State::ROOT:
+        switch (key_) {
+          case Key::BB: case Key::DIRECTED: case Key::LABEL: case Key::NAME:
+          case Key::DRAW: case Key::LDRAW: case Key::OBJECTS: case Key::EDGES:
+            return true;
+          default:
+            break;
+        }
+
+        ignore = ROOT_ATTR;
+        break;
+      case State::OBJECT:
+        switch (key_) {
+          case Key::GVID: case Key::HEIGHT: case Key::WIDTH: case Key::LABEL:
+          case Key::NAME: case Key::POS: case Key::DRAW: case Key::LDRAW:
+            return true;
+          default:
+            break;
+        }
+
+        ignore = OBJECT_ATTR;
+        prefix = "objects ";
+        break;
+      case State::EDGE:
+        switch (key_) {
+          case Key::GVID: case Key::HEAD: case Key::TAIL: case Key::LABEL:
+          case Key::DRAW: case Key::LDRAW: case Key::HDRAW: case Key::HLDRAW:
+          case Key::TDRAW: case Key::TLDRAW:
+            return true;
+          default:
+            break;
+        }
+
+        ignore = EDGE_ATTR;
+        prefix = "edges ";
+        break;
+      case State::DRAW_OP:
+        switch (key_) {
+          case Key::OP: case Key::GRAD: case Key::COLOR: case Key::STYLE:
+          case Key::SIZE: case Key::FACE: case Key::PT: case Key::ALIGN:
+          case Key::WIDTH: case Key::TEXT: case Key::POINTS: case Key::RECT:
+            return true;
+          case Key::P0: case Key::P1: case Key::STOPS:
+            skipValue_ = true;
+            return true;
+          default:
+            break;
+        }
+
+        app_->errorMsg(" " + drawName_ + " unhandled: " + std::string(name));
+
+        skipValue_ = true;
+
+        return true;
+      default:
+        break;
     }
-  };
 
-  auto objToQString = [](const CJson::ValueP &value) {
-    return QString::fromStdString(value->cast<CJson::String>()->value());
-  };
+    if (! (keyData.ignore & ignore))
+      app_->errorMsg(std::string(" ") + prefix + "unhandled: " + std::string(name));
 
-#if 0
-  auto stringToBool = [](const QString &str) {
-    if (str == "true" ) return true;
-    if (str == "false") return false;
-    errorMsg("Unhandled bool : " + str.toStdString());
-    return false;
-  };
-#endif
+    skipValue_ = true;
 
-  auto stringToRect = [](const QString &str) {
-    auto strs = str.split(",");
-    assert(strs.size() == 4);
+    return true;
+  }
 
-    bool ok;
-    auto x1 = strs[0].toDouble(&ok); assert(ok);
-    auto y1 = strs[1].toDouble(&ok); assert(ok);
-    auto x2 = strs[2].toDouble(&ok); assert(ok);
-    auto y2 = strs[3].toDouble(&ok); assert(ok);
+  bool stringValue(std::string_view str) override {
+    if (skipEvent(0)) return true;
 
-    return QRectF(x1, y1, x2 - x1, y2 - y1);
-  };
+    switch (state()) {
+      case State::ROOT: {
+        auto *root = app_->root_.get();
 
-  // ops:
-  // "S"  : style
-  // "t"  : font_style
-  // "pP" : polygon
-  // "T"  : text
-  // "eE" : ellipse
-  // "bB" : bspline
-  // "L"  : polyline
-  // "F"  : font
-
-  if (value->isObject()) {
-    auto *obj = value->cast<CJson::Object>();
-
-    for (const auto &nv : obj->nameValueArray()) {
-      if      (nv.first == "bb") {
-        setBBox(stringToRect(objToQString(nv.second)));
-      }
-      else if (nv.first == "bgcolor") {
-      }
-      else if (nv.first == "center") {
-      }
-      else if (nv.first == "charset") {
-      }
-      else if (nv.first == "color") {
-      }
-      else if (nv.first == "directed") {
-        directed_ = nv.second->toBool();
-      }
-      else if (nv.first == "fontcolor") {
-      }
-      else if (nv.first == "fontname") {
-      }
-      else if (nv.first == "fontsize") {
-      }
-      else if (nv.first == "gradientangle") {
-      }
-      else if (nv.first == "label") {
-        root_->setLabel(objToQString(nv.second));
-      }
-      else if (nv.first == "labeljust") {
-      }
-      else if (nv.first == "lwidth") {
-      }
-      else if (nv.first == "lheight") {
-      }
-      else if (nv.first == "lp") {
-      }
-      else if (nv.first == "margin") {
-      }
-      else if (nv.first == "name") {
-        root_->setName(objToQString(nv.second));
-      }
-      else if (nv.first == "nodesep") {
-      }
-      else if (nv.first == "ordering") {
-      }
-      else if (nv.first == "orientation") {
-      }
-      else if (nv.first == "overlap") {
-      }
-      else if (nv.first == "page") {
-      }
-      else if (nv.first == "rankdir") {
-      }
-      else if (nv.first == "ranksep") {
-      }
-      else if (nv.first == "ratio") {
+        switch (key_) {
+          case Key::BB: {
+            QRectF rect;
+
+            if (stringToRect(str, rect))
+              app_->setBBox(rect);
+            else
+              app_->errorMsg("Invalid bb: " + std::string(str));
+
+            break;
+          }
+          case Key::DIRECTED: app_->directed_ = (str == "true"); break;
+          case Key::LABEL   : root->setLabel(toQString(str)); break;
+          case Key::NAME    : root->setName (toQString(str)); break;
+          default           : return invalidValue(0);
+        }
+
+        break;
       }
-      else if (nv.first == "root") {
+      case State::OBJECT: {
+        switch (key_) {
+          case Key::LABEL : object_->setLabel(toQString(str)); break;
+          case Key::NAME  : object_->setName (toQString(str)); break;
+          case Key::HEIGHT: {
+            double r;
+
+            if (decodeReal(str, r))
+              object_->setHeight(r);
+            else
+              app_->errorMsg("Invalid height: " + std::string(str));
+
+            break;
+          }
+          case Key::WIDTH: {
+            double r;
+
+            if (decodeReal(str, r))
+              object_->setWidth(r);
+            else
+              app_->errorMsg("Invalid width: " + std::string(str));
+
+            break;
+          }
+          case Key::POS: {
+            QPointF p;
+
+            if (decodePos(str, p))
+              object_->setPos(p);
+            else
+              app_->errorMsg("Unhandled pos: " + std::string(str));
+
+            break;
+          }
+          default:
+            return invalidValue(0);
+        }
+
+        break;
       }
-      else if (nv.first == "size") {
+      case State::EDGE: {
+        switch (key_) {
+          case Key::LABEL: object_->setLabel(toQString(str)); break;
+          default        : return invalidValue(0);
+        }
+
+        break;
       }
-      else if (nv.first == "splines") {
+      case State::DRAW_OP: {
+        switch (key_) {
+          case Key::OP   : draw_.setOp      (str); break;
+          case Key::GRAD : draw_.setGrad    (str); break;
+          case Key::COLOR: draw_.setColor   (str); break;
+          case Key::STYLE: draw_.setStyle   (str); break;
+          case Key::FACE : draw_.setFontFace(str); break;
+          case Key::TEXT : draw_.setText    (str); break;
+          case Key::ALIGN: {
+            Qt::Alignment align;
+
+            if (decodeAlign(str, align))
+              draw_.setTextAlign(align);
+            else
+              app_->errorMsg("Invalid align: " + std::string(str));
+
+            break;
+          }
+          default:
+            return invalidValue(0);
+        }
+
+        break;
       }
-      else if (nv.first == "ssize") {
+      default:
+        return invalidValue(0);
+    }
+
+    return true;
+  }
+
+  bool numberValue(double r) override {
+    if (skipEvent(0)) return true;
+
+    switch (state()) {
+      case State::OBJECT: {
+        switch (key_) {
+          case Key::GVID  : object_->setId    (int(r)); break;
+          case Key::HEIGHT: object_->setHeight(r); break;
+          case Key::WIDTH : object_->setWidth (r); break;
+          default         : return invalidValue(0);
+        }
+
+        break;
       }
-      else if (nv.first == "strict") {
+      case State::EDGE: {
+        switch (key_) {
+          case Key::GVID: object_->setId(int(r)); break;
+          case Key::HEAD: { // to
+            int id = int(r);
+
+            auto *obj = app_->findObject(id);
+
+            if (obj)
+              obj->addDestEdge(object_.get());
+
+            object_->setHeadId(id);
+
+            break;
+          }
+          case Key::TAIL: { // from
+            int id = int(r);
+
+            auto *obj = app_->findObject(id);
+
+            if (obj)
+              obj->addSrcEdge(object_.get());
+
+            object_->setTailId(id);
+
+            break;
+          }
+          default:
+            return invalidValue(0);
+        }
+
+        break;
       }
-      else if (nv.first == "style") {
+      case State::DRAW_OP: {
+        switch (key_) {
+          case Key::SIZE : draw_.setFontSize (r); break;
+          case Key::WIDTH: draw_.setTextWidth(r); break;
+          default        : return invalidValue(0);
+        }
+
+        break;
       }
-      else if (nv.first == "truecolor") {
+      case State::COORDS:
+        coords_.push_back(r);
+        break;
+      default:
+        return invalidValue(0);
+    }
+
+    return true;
+  }
+
+  bool booleanValue(bool b) override {
+    if (skipEvent(0)) return true;
+
+    if (state() == State::ROOT && key_ == Key::DIRECTED)
+      app_->directed_ = b;
+    else
+      return invalidValue(0);
+
+    return true;
+  }
+
+  bool nullValue() override {
+    if (skipEvent(0)) return true;
+
+    return invalidValue(0);
+  }
+
+ private:
+  enum class State {
+    TOP,
+    ROOT,
+    OBJECTS,
+    OBJECT,
+    EDGES,
+    EDGE,
+    DRAW_OPS,
+    DRAW_OP,
+    COORDS
+  };
+
+  enum class Key {
+    NONE,
+    BB,
+    DIRECTED,
+    LABEL,
+    NAME,
+    OBJECTS,
+    EDGES,
+    GVID,
+    HEIGHT,
+    WIDTH,
+    POS,
+    HEAD,
+    TAIL,
+    DRAW,
+    LDRAW,
+    HDRAW,
+    HLDRAW,
+    TDRAW,
+    TLDRAW,
+    OP,
+    GRAD,
+    COLOR,
+    P0,
+    P1,
+    STOPS,
+    STYLE,
+    SIZE,
+    FACE,
+    PT,
+    ALIGN,
+    TEXT,
+    POINTS,
+    RECT
+  };
+
+  // levels where key is a known but unused attribute
+  enum {
+    ROOT_ATTR   = (1<<0),
+    OBJECT_ATTR = (1<<1),
+    EDGE_ATTR   = (1<<2)
+  };
+
+  struct KeyData {
+    Key key    { Key::NONE };
+    int ignore { 0 };
+  };
+
+  static KeyData lookupKey(std::string_view name) {
+    using KeyMap = std::unordered_map<std::string_view, KeyData>;
+
+    constexpr int R = ROOT_ATTR, O = OBJECT_ATTR, E = EDGE_ATTR;
+
+    static KeyMap keyMap = {
+      // used keys
+      { "bb"           , { Key::BB      , O } },
+      { "directed"     , { Key::DIRECTED, 0 } },
+      { "label"        , { Key::LABEL   , 0 } },
+      { "name"         , { Key::NAME    , 0 } },
+      { "objects"      , { Key::OBJECTS , 0 } },
+      { "edges"        , { Key::EDGES   , O } },
+      { "_gvid"        , { Key::GVID    , 0 } },
+      { "height"       , { Key::HEIGHT  , 0 } },
+      { "width"        , { Key::WIDTH   , 0 } },
+      { "pos"          , { Key::POS     , E } },
+      { "head"         , { Key::HEAD    , 0 } },
+      { "tail"         , { Key::TAIL    , 0 } },
+      { "_draw_"       , { Key::DRAW    , 0 } },
+      { "_ldraw_"      , { Key::LDRAW   , 0 } },
+      { "_hdraw_"      , { Key::HDRAW   , 0 } },
+      { "_hldraw_"     , { Key::HLDRAW  , 0 } },
+      { "_tdraw_"      , { Key::TDRAW   , 0 } },
+      { "_tldraw_"     , { Key::TLDRAW  , 0 } },
+      { "op"           , { Key::OP      , 0 } },
+      { "grad"         , { Key::GRAD    , 0 } },
+      { "color"        , { Key::COLOR   , R | O | E } },
+      { "p0"           , { Key::P0      , 0 } },
+      { "p1"           , { Key::P1      , 0 } },
+      { "stops"        , { Key::STOPS   , 0 } },
+      { "style"        , { Key::STYLE   , R | O | E } },
+      { "size"         , { Key::SIZE    , R | O } },
+      { "face"         , { Key::FACE    , 0 } },
+      { "pt"           , { Key::PT      , 0 } },
+      { "align"        , { Key::ALIGN   , 0 } },
+      { "text"         , { Key::TEXT    , 0 } },
+      { "points"       , { Key::POINTS  , 0 } },
+      { "rect"         , { Key::RECT    , 0 } },
+      // unused attributes
+      { "arrowhead"    , { Key::NONE, E } },
+      { "arrowsize"    , { Key::NONE, E } },
+      { "arrowtail"    , { Key::NONE, E } },
+      { "bgcolor"      , { Key::NONE, R | O } },
+      { "center"       , { Key::NONE, R | O } },
+      { "charset"      , { Key::NONE, R } },
+      { "colorscheme"  , { Key::NONE, O } },
+      { "dir"          , { Key::NONE, E } },
+      { "distortion"   , { Key::NONE, O } },
+      { "edgeURL"      , { Key::NONE, E } },
+      { "f"            , { Key::NONE, E } },
+      { "fillcolor"    , { Key::NONE, O | E } },
+      { "fixedsize"    , { Key::NONE, O } },
+      { "fname"        , { Key::NONE, O } },
+      { "fontcolor"    , { Key::NONE, R | O | E } },
+      { "fontname"     , { Key::NONE, R | O | E } },
+      { "fontsize"     , { Key::NONE, R | O | E } },
+      { "gradientangle", { Key::NONE, R | O } },
+      { "headclip"     , { Key::NONE, E } },
+      { "headlabel"    , { Key::NONE, E } },
+      { "head_lp"      , { Key::NONE, E } },
+      { "headport"     , { Key::NONE, E } },
+      { "id"           , { Key::NONE, E } },
+      { "kind"         , { Key::NONE, O } },
+      { "labelangle"   , { Key::NONE, E } },
+      { "labeldistance", { Key::NONE, E } },
+      { "labelfontsize", { Key::NONE, E } },
+      { "labeljust"    , { Key::NONE, R } },
+      { "lheight"      , { Key::NONE, R | O } },
+      { "lp"           , { Key::NONE, R | O | E } },
+      { "lwidth"       , { Key::NONE, R | O } },
+      { "margin"       , { Key::NONE, R | O } },
+      { "minlen"       , { Key::NONE, E } },
+      { "nodes"        , { Key::NONE, O } },
+      { "nodesep"      , { Key::NONE, R | O } },
+      { "ordering"     , { Key::NONE, R | O } },
+      { "orientation"  , { Key::NONE, R | O } },
+      { "outline"      , { Key::NONE, O } },
+      { "overlap"      , { Key::NONE, R | O } },
+      { "page"         , { Key::NONE, R | O } },
+      { "peripheries"  , { Key::NONE, O } },
+      { "pname"        , { Key::NONE, O } },
+      { "rank"         , { Key::NONE, O } },
+      { "rankdir"      , { Key::NONE, R | O } },
+      { "ranksep"      , { Key::NONE, R | O } },
+      { "ratio"        , { Key::NONE, R | O } },
+      { "rects"        , { Key::NONE, O } },
+      { "regular"      , { Key::NONE, O } },
+      { "root"         , { Key::NONE, R } },
+      { "samearrowhead", { Key::NONE, E } },
+      { "samearrowtail", { Key::NONE, E } },
+      { "samehead"     , { Key::NONE, E } },
+      { "sametail"     , { Key::NONE, E } },
+      { "shape"        , { Key::NONE, O } },
+      { "sides"        , { Key::NONE, O } },
+      { "skew"         , { Key::NONE, O } },
+      { "splines"      , { Key::NONE, R | O } },
+      { "ssize"        , { Key::NONE, R } },
+      { "strict"       , { Key::NONE, R } },
+      { "subgraphs"    , { Key::NONE, O } },
+      { "subkind"      , { Key::NONE, O } },
+      { "tailclip"     , { Key::NONE, E } },
+      { "taillabel"    , { Key::NONE, E } },
+      { "tailport"     , { Key::NONE, E } },
+      { "tail_lp"      , { Key::NONE, E } },
+      { "tooltip"      , { Key::NONE, O } },
+      { "truecolor"    , { Key::NONE, R } },
+      { "URL"          , { Key::NONE, O } },
+      { "weight"       , { Key::NONE, E } },
+      { "wt"           , { Key::NONE, E } },
+      { "xdotversion"  , { Key::NONE, R } },
+      { "_subgraph_cnt", { Key::NONE, R } },
+    };
+
+    auto p = keyMap.find(name);
+
+    if (p == keyMap.end())
+      return KeyData();
+
+    return (*p).second;
+  }
+
+  State state() const { return states_.back(); }
+
+  void pushState(State state) { states_.push_back(state); }
+
+  void popState() {
+    if (states_.size() > 1)
+      states_.pop_back();
+  }
+
+  void beginDraw(Object *object, const char *name, bool isRoot) {
+    drawName_ = name;
+
+    draw_.begin(object, drawName_, isRoot);
+
+    pushState(State::DRAW_OPS);
+  }
+
+  //! consume event if skipping value (depth is +1 for container start, -1 for end)
+  bool skipEvent(int depth) {
+    if (skipDepth_ > 0) {
+      skipDepth_ += depth;
+      return true;
+    }
+
+    if (skipValue_) {
+      skipValue_ = false;
+      skipDepth_ = std::max(depth, 0);
+      return true;
+    }
+
+    return false;
+  }
+
+  //! report value of unexpected type and skip it
+  bool invalidValue(int depth) {
+    app_->errorMsg(" invalid value");
+
+    skipDepth_ = std::max(depth, 0);
+
+    return true;
+  }
+
+  //! apply collected pt/points/rect coordinates to draw op
+  void addCoords() {
+    auto nc = coords_.size();
+
+    switch (key_) {
+      case Key::PT: {
+        if (nc == 2)
+          draw_.setTextPos(QPointF(coords_[0], coords_[1]));
+        else
+          app_->errorMsg(" " + drawName_ + " invalid pt");
+
+        break;
       }
-      else if (nv.first == "xdotversion") {
+      case Key::POINTS: {
+        points_.clear();
+
+        for (size_t i = 0; i + 1 < nc; i += 2)
+          points_.push_back(QPointF(coords_[i], coords_[i + 1]));
+
+        draw_.setPoints(points_);
+
+        break;
       }
-      else if (nv.first == "_subgraph_cnt") {
+      case Key::RECT: {
+        // center and half size
+        if (nc == 4)
+          draw_.setEllipse(QRectF(coords_[0] - coords_[2], coords_[1] - coords_[3],
+                                  2*coords_[2], 2*coords_[3]));
+        else
+          app_->errorMsg(" " + drawName_ + " invalid rect");
+
+        break;
       }
-      // top level draw
-      else if (nv.first == "_draw_") {
-        std::string op;
-        ColorData   colorData;
-        StyleData   styleData;
-
-        auto *drawArray = nv.second->cast<CJson::Array>();
-
-        for (const auto &objValue : drawArray->values()) {
-          auto *drawObj = objValue->cast<CJson::Object>();
-
-          for (const auto &nv1 : drawObj->nameValueArray()) {
-            //debugMsg("_draw_ : " + nv1.first + " " + *nv1.second);
-
-            if      (nv1.first == "op") {
-              op = nv1.second->cast<CJson::String>()->value();
-            }
-            else if (nv1.first == "grad") {
-              auto grad = nv1.second->cast<CJson::String>()->value();
-
-              if (op == "c" || op == "C")
-                colorData.grad = grad;
-              else
-                errorMsg(" _draw_ unhandled grad");
-            }
-            else if (nv1.first == "color") {
-              auto color = decodeColor(nv1.second->cast<CJson::String>()->value());
-
-              if      (op == "C")
-                colorData.bg = color;
-              else if (op == "c")
-                colorData.fg = color;
-              else
-                errorMsg(" _draw_ unhandled color");
-            }
-            else if (nv1.first == "p0") {
-            }
-            else if (nv1.first == "p1") {
-            }
-            else if (nv1.first == "stops") {
-            }
-            else if (nv1.first == "style") {
-              auto style = nv1.second->cast<CJson::String>()->value();
-
-              if (op == "S") {
-                if (style != "")
-                  decodeStyle(style, styleData);
-              }
-              else
-                errorMsg(" _draw_ unhandled style");
-            }
-            else if (nv1.first == "points") {
-              auto points = decodePoints(nv1.second->cast<CJson::Array>());
-
-              if      (op == "P" || op == "p") {
-                PathData pathData;
-
-                pathData.bg    = colorData.bg;
-                pathData.fg    = colorData.fg;
-                pathData.style = styleData;
-                pathData.path  = pointsToPath(points);
-
-                root_->addPath(pathData);
-
-                colorData.reset();
-              }
-              else if (op == "b" || op == "B") {
-                PathData bspline;
-
-                bspline.fg    = colorData.fg;
-                bspline.style = styleData;
-                bspline.path  = pointsToBSpline(points);
-
-                root_->addLine(bspline);
-
-                colorData.reset();
-              }
-              else if (op == "L") {
-                PathData bspline;
-
-                bspline.fg    = colorData.fg;
-                bspline.style = styleData;
-                bspline.path  = pointsToBSpline(points);
-
-                root_->addLine(bspline);
-
-                root_->setRect(bspline.path.boundingRect());
-
-                colorData.reset();
-              }
-              else
-                errorMsg(" _draw_ unhandled points for op " + op);
-            }
-            else if (nv1.first == "rect") {
-              auto rect = decodeRect(nv1.second->cast<CJson::Array>());
-
-              if (op == "E" || op == "e") {
-                PathData ellipse;
-
-                ellipse.bg    = colorData.bg;
-                ellipse.fg    = colorData.fg;
-                ellipse.style = styleData;
-                ellipse.path  = rectToEllipse(rect);
-
-                root_->addPath(ellipse);
-
-                colorData.reset();
-
-                root_->setRect(rect);
-              }
-              else
-                errorMsg(" _draw_ unhandled rect");
-            }
-            else {
-              errorMsg(" _draw_ unhandled: " + nv1.first);
-            }
-          }
+      default:
+        break;
+    }
+  }
+
+ private:
+  using States = std::vector<State>;
+  using Coords = std::vector<double>;
+
+  App*        app_         { nullptr };
+  States      states_;
+  Key         key_         { Key::NONE };
+  bool        skipValue_   { false };
+  int         skipDepth_   { 0 };
+  ObjectP     object_;
+  DrawBuilder draw_;
+  std::string drawName_;
+  Coords      coords_;
+  int         coordsDepth_ { 0 };
+  Points      points_;
+};
+
+//---
+
+bool
+App::
+processJson(const std::string &filename)
+{
+  if (loadSceneCache(filename, SceneCache::Format::JSON))
+    return true;
+
+  bool cacheable = (objects_.empty() && edges_.empty());
+
+  JsonReader reader;
+  JsonLoader loader(this);
+
+  if (! reader.parseFile(filename, loader)) {
+    errorMsg("Parse failed: " + reader.errorMsg());
+    return false;
+  }
+
+  buildSpatialIndex();
+
+  if (cacheable)
+    saveSceneCache(filename, SceneCache::Format::JSON);
+
+  return true;
+}
+
+//---
+
+/*!
+ * Tokenizer for xdot draw attribute values (_draw_, _ldraw_, ...) as stored in the
+ * dot file, each op is passed to a DrawBuilder.
+ *
+ * ops:
+ *  "E x y w h", "e x y w h" : filled/unfilled ellipse (center, half size)
+ *  "P n x1 y1 ... xn yn"    : filled polygon ("p" unfilled, "L" polyline)
+ *  "B n x1 y1 ... xn yn"    : bspline ("b" filled)
+ *  "T x y j w n -text"      : text (j is -1 left, 0 center, 1 right)
+ *  "t f"                    : font characteristics (ignored)
+ *  "F s n -font"            : font size and name
+ *  "C n -color", "c n -color" : fill/pen color
+ *  "S n -style"             : style
+ *  "I x y w h n -name"      : image (ignored)
+ *
+ * "n -str" is a string of n bytes.
+ */
+class XDotParser {
+ public:
+  XDotParser(DrawBuilder &draw) :
+   draw_(draw) {
+  }
+
+  //! parse raw (dot escaped) attribute value
+  bool parse(const std::string &value) {
+    unescape(value);
+
+    pos_ = 0;
+
+    while (true) {
+      skipSpace();
+
+      if (atEnd())
+        break;
+
+      char c = str_[pos_++];
+
+      auto op = std::string_view(&str_[pos_ - 1], 1);
+
+      switch (c) {
+        case 'E': case 'e': {
+          double x, y, w, h;
+
+          if (! readReal(x) || ! readReal(y) || ! readReal(w) || ! readReal(h))
+            return false;
+
+          draw_.setOp(op);
+
+          draw_.setEllipse(QRectF(x - w, y - h, 2*w, 2*h));
+
+          break;
         }
-      }
-      else if (nv.first == "_ldraw_") {
-        std::string op;
-        ColorData   colorData;
-        TextData    textData;
-        StyleData   styleData;
-
-        auto *drawArray = nv.second->cast<CJson::Array>();
-
-        for (const auto &objValue1 : drawArray->values()) {
-          auto *drawObj1 = objValue1->cast<CJson::Object>();
-
-          for (const auto &nv1 : drawObj1->nameValueArray()) {
-            //debugMsg("_ldraw_ : " + nv1.first + " " + *nv1.second);
-
-            if      (nv1.first == "op") {
-              op = nv1.second->cast<CJson::String>()->value();
-            }
-            else if (nv1.first == "grad") {
-              auto grad = nv1.second->cast<CJson::String>()->value();
-
-              if (op == "c" || op == "C")
-                colorData.grad = grad;
-              else
-                errorMsg(" objects/_ldraw_ unhandled grad");
-            }
-            else if (nv1.first == "color") {
-              auto color = decodeColor(nv1.second->cast<CJson::String>()->value());
-
-              if      (op == "C")
-                colorData.bg = color;
-              else if (op == "c")
-                colorData.fg = color;
-              else
-                errorMsg(" objects/_ldraw_ unhandled color");
-            }
-            else if (nv1.first == "p0") {
-            }
-            else if (nv1.first == "p1") {
-            }
-            else if (nv1.first == "stops") {
-            }
-            else if (nv1.first == "style") {
-              auto style = nv1.second->cast<CJson::String>()->value();
-
-              if (op == "S") {
-                if (style != "")
-                  decodeStyle(style, styleData);
-              }
-              else
-                errorMsg(" objects/_ldraw_ unhandled style");
-            }
-            else if (nv1.first == "size") {
-              auto size = nv1.second->cast<CJson::Number>()->value();
-
-              if (op == "F")
-                textData.size = size;
-              else
-                errorMsg(" objects/_ldraw_ unhandled size");
-            }
-            else if (nv1.first == "face") {
-              auto face = objToQString(nv1.second);
-
-              if (op == "F")
-                textData.face = face;
-            }
-            else if (nv1.first == "pt") {
-              auto pt = decodePoint(nv1.second->cast<CJson::Array>());
-
-              if (op == "t" || op == "T")
-                textData.pos = pt;
-              else
-                errorMsg(" objects/_ldraw_ unhandled pt");
-            }
-            else if (nv1.first == "align") {
-              auto align = decodeAlign(nv1.second->cast<CJson::String>()->value());
-
-              if (op == "t" || op == "T")
-                textData.align = align;
-              else
-                errorMsg(" objects/_ldraw_ unhandled align");
-            }
-            else if (nv1.first == "width") {
-              auto width = nv1.second->cast<CJson::Number>()->value();
-
-              if (op == "t" || op == "T")
-                textData.width = width;
-              else
-                errorMsg(" objects/_ldraw_ unhandled width");
-            }
-            else if (nv1.first == "text") {
-              auto text = nv1.second->cast<CJson::String>()->value();
-
-              if (op == "t" || op == "T") {
-                textData.fg   = colorData.fg;
-                textData.text = QString::fromStdString(text);
-
-                root_->addText(textData);
-
-                colorData.reset();
-              }
-              else
-                errorMsg(" objects/_ldraw_ unhandled text");
-            }
-            else if (nv1.first == "points") {
-              auto points = decodePoints(nv1.second->cast<CJson::Array>());
-
-              if      (op == "P" || op == "p") {
-                PathData pathData;
-
-                pathData.bg    = colorData.bg;
-                pathData.fg    = colorData.fg;
-                pathData.style = styleData;
-                pathData.path  = pointsToPath(points);
-
-                root_->addPath(pathData);
-
-                colorData.reset();
-              }
-              else if (op == "b" || op == "B") {
-                PathData bspline;
-
-                bspline.fg    = colorData.fg;
-                bspline.style = styleData;
-                bspline.path  = pointsToBSpline(points);
-
-                root_->addLine(bspline);
-
-                colorData.reset();
-              }
-              else if (op == "L") {
-                PathData bspline;
-
-                bspline.fg    = colorData.fg;
-                bspline.style = styleData;
-                bspline.path  = pointsToBSpline(points);
-
-                root_->addLine(bspline);
-
-                root_->setRect(bspline.path.boundingRect());
-
-                colorData.reset();
-              }
-              else
-                errorMsg(" objects/_ldraw_ unhandled points for op " + op);
-            }
-            else {
-              errorMsg(" objects/_ldraw_ unhandled: " + nv1.first);
-            }
-          }
+        case 'P': case 'p': case 'L': case 'B': case 'b': {
+          if (! readPoints())
+            return false;
+
+          draw_.setOp(op);
+
+          draw_.setPoints(points_);
+
+          break;
         }
-      }
-      else if (nv.first == "objects") {
-        //debugMsg("Objects");
-
-        auto *objArray = nv.second->cast<CJson::Array>();
-        assert(objArray);
-
-        for (const auto &objValue : objArray->values()) {
-          auto *obj1 = objValue->cast<CJson::Object>();
-          assert(obj1);
-
-          auto object = std::make_shared<Object>();
-
-          object->setType(Object::Type::OBJECT);
-
-          for (const auto &nv1 : obj1->nameValueArray()) {
-            if      (nv1.first == "_gvid") {
-              object->setId(int(nv1.second->cast<CJson::Number>()->value()));
-            }
-            else if (nv1.first == "bb") {
-            }
-            else if (nv1.first == "bgcolor") {
-            }
-            else if (nv1.first == "center") {
-            }
-            else if (nv1.first == "color") {
-            }
-            else if (nv1.first == "colorscheme") {
-            }
-            else if (nv1.first == "distortion") {
-            }
-            else if (nv1.first == "edges") {
-            }
-            else if (nv1.first == "fillcolor") {
-            }
-            else if (nv1.first == "fixedsize") {
-            }
-            else if (nv1.first == "fontcolor") {
-            }
-            else if (nv1.first == "fname") {
-            }
-            else if (nv1.first == "fontname") {
-            }
-            else if (nv1.first == "fontsize") {
-            }
-            else if (nv1.first == "gradientangle") {
-            }
-            else if (nv1.first == "height") {
-              object->setHeight(decodeRealString(nv1.second->cast<CJson::String>()->value()));
-            }
-            else if (nv1.first == "kind") {
-            }
-            else if (nv1.first == "label") {
-              object->setLabel(objToQString(nv1.second));
-            }
-            else if (nv1.first == "lheight") {
-            }
-            else if (nv1.first == "lp") {
-            }
-            else if (nv1.first == "lwidth") {
-            }
-            else if (nv1.first == "margin") {
-            }
-            else if (nv1.first == "name") {
-              object->setName(objToQString(nv1.second));
-            }
-            else if (nv1.first == "nodes") {
-            }
-            else if (nv1.first == "nodesep") {
-            }
-            else if (nv1.first == "ordering") {
-            }
-            else if (nv1.first == "orientation") {
-            }
-            else if (nv1.first == "outline") {
-            }
-            else if (nv1.first == "overlap") {
-            }
-            else if (nv1.first == "page") {
-            }
-            else if (nv1.first == "peripheries") {
-            }
-            else if (nv1.first == "pname") {
-            }
-            else if (nv1.first == "pos") {
-              object->setPos(decodePos(nv1.second->cast<CJson::String>()->value()));
-            }
-            else if (nv1.first == "rank") {
-            }
-            else if (nv1.first == "ranksep") {
-            }
-            else if (nv1.first == "rankdir") {
-            }
-            else if (nv1.first == "ratio") {
-            }
-            else if (nv1.first == "rects") {
-            }
-            else if (nv1.first == "regular") {
-            }
-            else if (nv1.first == "shape") {
-            }
-            else if (nv1.first == "sides") {
-            }
-            else if (nv1.first == "size") {
-            }
-            else if (nv1.first == "subkind") {
-            }
-            else if (nv1.first == "skew") {
-            }
-            else if (nv1.first == "splines") {
-            }
-            else if (nv1.first == "style") {
-            }
-            else if (nv1.first == "subgraphs") {
-            }
-            else if (nv1.first == "tooltip") {
-            }
-            else if (nv1.first == "URL") {
-            }
-            else if (nv1.first == "width") {
-              object->setWidth(decodeRealString(nv1.second->cast<CJson::String>()->value()));
-            }
-            else if (nv1.first == "_draw_") {
-              std::string op;
-              ColorData   colorData;
-              StyleData   styleData;
-
-              auto *drawArray1 = nv1.second->cast<CJson::Array>();
-
-              for (const auto &objValue1 : drawArray1->values()) {
-                auto *drawObj1 = objValue1->cast<CJson::Object>();
-
-                for (const auto &nv2 : drawObj1->nameValueArray()) {
-                  //debugMsg("objects/_draw_ : " + nv2.first + " " + *nv2.second);
-
-                  if      (nv2.first == "op") {
-                    op = nv2.second->cast<CJson::String>()->value();
-                  }
-                  else if (nv2.first == "grad") {
-                    auto grad = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "c" || op == "C")
-                      colorData.grad = grad;
-                    else
-                      errorMsg(" objects/_draw_ unhandled grad");
-                  }
-                  else if (nv2.first == "color") {
-                    auto color = decodeColor(nv2.second->cast<CJson::String>()->value());
-
-                    if      (op == "C")
-                      colorData.bg = color;
-                    else if (op == "c")
-                      colorData.fg = color;
-                    else
-                      errorMsg(" objects/_draw_ unhandled color");
-                  }
-                  else if (nv2.first == "p0") {
-                  }
-                  else if (nv2.first == "p1") {
-                  }
-                  else if (nv2.first == "stops") {
-                  }
-                  else if (nv2.first == "style") {
-                    auto style = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "S") {
-                      if (style != "")
-                        decodeStyle(style, styleData);
-                    }
-                    else
-                      errorMsg(" objects/_draw_ unhandled style");
-                  }
-                  else if (nv2.first == "points") {
-                    auto points = decodePoints(nv2.second->cast<CJson::Array>());
-
-                    if      (op == "P" || op == "p") {
-                      PathData pathData;
-
-                      pathData.bg    = colorData.bg;
-                      pathData.fg    = colorData.fg;
-                      pathData.style = styleData;
-                      pathData.path  = pointsToPath(points);
-
-                      object->addPath(pathData);
-
-                      object->setRect(pathData.path.boundingRect());
-
-                      colorData.reset();
-                    }
-                    else if (op == "b" || op == "B") {
-                      PathData bspline;
-
-                      bspline.fg    = colorData.fg;
-                      bspline.style = styleData;
-                      bspline.path  = pointsToBSpline(points);
-
-                      object->addLine(bspline);
-
-                      object->setRect(bspline.path.boundingRect());
-
-                      colorData.reset();
-                    }
-                    else if (op == "L") {
-                      PathData bspline;
-
-                      bspline.fg    = colorData.fg;
-                      bspline.style = styleData;
-                      bspline.path  = pointsToBSpline(points);
-
-                      object->addLine(bspline);
-
-                      object->setRect(bspline.path.boundingRect());
-
-                      colorData.reset();
-                    }
-                    else
-                      errorMsg(" objects/_draw_ unhandled points for op " + op);
-                  }
-                  else if (nv2.first == "rect") {
-                    auto rect = decodeRect(nv2.second->cast<CJson::Array>());
-
-                    if (op == "E" || op == "e") {
-                      PathData ellipse;
-
-                      ellipse.bg    = colorData.bg;
-                      ellipse.fg    = colorData.fg;
-                      ellipse.style = styleData;
-                      ellipse.path  = rectToEllipse(rect);
-
-                      object->addPath(ellipse);
-
-                      object->setRect(rect);
-
-                      colorData.reset();
-                    }
-                    else
-                      errorMsg(" objects/_draw_ unhandled rect");
-                  }
-                  else {
-                    errorMsg(" objects/_draw_ unhandled: " + nv2.first);
-                  }
-                }
-              }
-            }
-            else if (nv1.first == "_ldraw_") {
-              std::string op;
-              ColorData   colorData;
-              TextData    textData;
-              StyleData   styleData;
-
-              auto *drawArray1 = nv1.second->cast<CJson::Array>();
-
-              for (const auto &objValue1 : drawArray1->values()) {
-                auto *drawObj1 = objValue1->cast<CJson::Object>();
-
-                for (const auto &nv2 : drawObj1->nameValueArray()) {
-                  //debugMsg("_ldraw_ : " + nv2.first + " " + *nv2.second);
-
-                  if      (nv2.first == "op") {
-                    op = nv2.second->cast<CJson::String>()->value();
-                  }
-                  else if (nv2.first == "grad") {
-                    auto grad = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "c" || op == "C")
-                      colorData.grad = grad;
-                    else
-                      errorMsg(" objects/_ldraw_ unhandled grad");
-                  }
-                  else if (nv2.first == "color") {
-                    auto color = decodeColor(nv2.second->cast<CJson::String>()->value());
-
-                    if      (op == "C")
-                      colorData.bg = color;
-                    else if (op == "c")
-                      colorData.fg = color;
-                    else
-                      errorMsg(" objects/_ldraw_ unhandled color");
-                  }
-                  else if (nv2.first == "p0") {
-                  }
-                  else if (nv2.first == "p1") {
-                  }
-                  else if (nv2.first == "stops") {
-                  }
-                  else if (nv2.first == "style") {
-                    auto style = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "S") {
-                      if (style != "")
-                        decodeStyle(style, styleData);
-                    }
-                    else
-                      errorMsg(" objects/_ldraw_ unhandled style");
-                  }
-                  else if (nv2.first == "size") {
-                    auto size = nv2.second->cast<CJson::Number>()->value();
-
-                    if (op == "F")
-                      textData.size = size;
-                    else
-                      errorMsg(" objects/_ldraw_ unhandled size");
-                  }
-                  else if (nv2.first == "face") {
-                    auto face = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "F")
-                      textData.face = QString::fromStdString(face);
-                  }
-                  else if (nv2.first == "pt") {
-                    auto pt = decodePoint(nv2.second->cast<CJson::Array>());
-
-                    if (op == "t" || op == "T")
-                      textData.pos = pt;
-                    else
-                      errorMsg(" objects/_ldraw_ unhandled pt");
-                  }
-                  else if (nv2.first == "align") {
-                    auto align = decodeAlign(nv2.second->cast<CJson::String>()->value());
-
-                    if (op == "t" || op == "T")
-                      textData.align = align;
-                    else
-                      errorMsg(" objects/_ldraw_ unhandled align");
-                  }
-                  else if (nv2.first == "width") {
-                    auto width = nv2.second->cast<CJson::Number>()->value();
-
-                    if (op == "t" || op == "T")
-                      textData.width = width;
-                    else
-                      errorMsg(" objects/_ldraw_ unhandled width");
-                  }
-                  else if (nv2.first == "text") {
-                    auto text = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "t" || op == "T") {
-                      textData.fg   = colorData.fg;
-                      textData.text = QString::fromStdString(text);
-
-                      object->addText(textData);
-
-                      colorData.reset();
-                    }
-                    else
-                      errorMsg(" objects/_ldraw_ unhandled text");
-                  }
-                  else if (nv2.first == "points") {
-                    auto points = decodePoints(nv2.second->cast<CJson::Array>());
-
-                    if      (op == "P" || op == "p") {
-                      PathData pathData;
-
-                      pathData.bg    = colorData.bg;
-                      pathData.fg    = colorData.fg;
-                      pathData.style = styleData;
-                      pathData.path  = pointsToPath(points);
-
-                      object->addPath(pathData);
-
-                      object->setRect(pathData.path.boundingRect());
-
-                      colorData.reset();
-                    }
-                    else if (op == "b" || op == "B") {
-                      PathData bspline;
-
-                      bspline.fg    = colorData.fg;
-                      bspline.style = styleData;
-                      bspline.path  = pointsToBSpline(points);
-
-                      object->addLine(bspline);
-
-                      object->setRect(bspline.path.boundingRect());
-
-                      colorData.reset();
-                    }
-                    else if (op == "L") {
-                      PathData bspline;
-
-                      bspline.fg    = colorData.fg;
-                      bspline.style = styleData;
-                      bspline.path  = pointsToBSpline(points);
-
-                      object->addLine(bspline);
-
-                      object->setRect(bspline.path.boundingRect());
-
-                      colorData.reset();
-                    }
-                    else
-                      errorMsg(" objects/_ldraw_ unhandled points for op " + op);
-                  }
-                  else {
-                    errorMsg(" objects/_ldraw_ unhandled: " + nv2.first);
-                  }
-                }
-              }
-            }
-            else {
-              errorMsg(" objects unhandled: " + nv1.first);
-            }
-          }
+        case 'T': {
+          double x, y, j, w;
+
+          std::string_view text;
+
+          if (! readReal(x) || ! readReal(y) || ! readReal(j) || ! readReal(w) ||
+              ! readString(text))
+            return false;
+
+          draw_.setOp(op);
+
+          draw_.setTextPos  (QPointF(x, y));
+          draw_.setTextAlign(j < 0 ? Qt::AlignLeft : (j > 0 ? Qt::AlignRight : Qt::AlignHCenter));
+          draw_.setTextWidth(w);
+          draw_.setText     (text);
 
-          objects_.push_back(object);
+          break;
         }
-      }
-      else if (nv.first == "edges") {
-        //debugMsg("Edges");
-
-        auto *edgeArray = nv.second->cast<CJson::Array>();
-        assert(edgeArray);
-
-        for (const auto &edgeValue : edgeArray->values()) {
-          auto *obj1 = edgeValue->cast<CJson::Object>();
-          assert(obj1);
-
-          auto edge = std::make_shared<Object>();
-
-          edge->setType(Object::Type::EDGE);
-
-          for (const auto &nv1 : obj1->nameValueArray()) {
-            if      (nv1.first == "_gvid") {
-              edge->setId(int(nv1.second->cast<CJson::Number>()->value()));
-            }
-            else if (nv1.first == "arrowhead") {
-            }
-            else if (nv1.first == "arrowsize") {
-            }
-            else if (nv1.first == "arrowtail") {
-            }
-            else if (nv1.first == "color") {
-            }
-            else if (nv1.first == "dir") {
-            }
-            else if (nv1.first == "edgeURL") {
-            }
-            else if (nv1.first == "f") {
-            }
-            else if (nv1.first == "fillcolor") {
-            }
-            else if (nv1.first == "fontcolor") {
-            }
-            else if (nv1.first == "fontname") {
-            }
-            else if (nv1.first == "fontsize") {
-            }
-            else if (nv1.first == "head") { // to
-              int id = int(nv1.second->cast<CJson::Number>()->value());
-
-              auto *obj = findObject(id);
-
-              if (obj)
-                obj->addDestEdge(edge.get());
-
-              edge->setHeadId(id);
-            }
-            else if (nv1.first == "headclip") {
-            }
-            else if (nv1.first == "headlabel") {
-            }
-            else if (nv1.first == "head_lp") {
-            }
-            else if (nv1.first == "headport") {
-            }
-            else if (nv1.first == "id") {
-            }
-            else if (nv1.first == "label") {
-              edge->setLabel(objToQString(nv1.second));
-            }
-            else if (nv1.first == "labelangle") {
-            }
-            else if (nv1.first == "labeldistance") {
-            }
-            else if (nv1.first == "labelfontsize") {
-            }
-            else if (nv1.first == "lp") {
-            }
-            else if (nv1.first == "minlen") {
-            }
-            else if (nv1.first == "pos") {
-              //edge->setPos(decodePos(nv1.second->cast<CJson::String>()->value()));
-            }
-            else if (nv1.first == "samearrowhead") {
-            }
-            else if (nv1.first == "samearrowtail") {
-            }
-            else if (nv1.first == "samehead") {
-            }
-            else if (nv1.first == "sametail") {
-            }
-            else if (nv1.first == "style") {
-            }
-            else if (nv1.first == "tail") { // from
-              int id = int(nv1.second->cast<CJson::Number>()->value());
-
-              auto *obj = findObject(id);
-
-              if (obj)
-                obj->addSrcEdge(edge.get());
-
-              edge->setTailId(id);
-            }
-            else if (nv1.first == "tailclip") {
-            }
-            else if (nv1.first == "taillabel") {
-            }
-            else if (nv1.first == "tailport") {
-            }
-            else if (nv1.first == "tail_lp") {
-            }
-            else if (nv1.first == "weight") {
-            }
-            else if (nv1.first == "wt") {
-            }
-            else if (nv1.first == "_draw_") {
-              std::string op;
-              ColorData   colorData;
-              StyleData   styleData;
-
-              auto *drawArray1 = nv1.second->cast<CJson::Array>();
-
-              for (const auto &objValue1 : drawArray1->values()) {
-                auto *drawObj1 = objValue1->cast<CJson::Object>();
-
-                for (const auto &nv2 : drawObj1->nameValueArray()) {
-                  //debugMsg("edges/_draw_: " + nv2.first + *nv2.second);
-
-                  if      (nv2.first == "op") {
-                    op = nv2.second->cast<CJson::String>()->value();
-                  }
-                  else if (nv2.first == "grad") {
-                    auto grad = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "c" || op == "C")
-                      colorData.grad = grad;
-                    else
-                      errorMsg(" edges/_draw_ unhandled grad");
-                  }
-                  else if (nv2.first == "color") {
-                    auto color = decodeColor(nv2.second->cast<CJson::String>()->value());
-
-                    if      (op == "C")
-                      colorData.bg = color;
-                    else if (op == "c")
-                      colorData.fg = color;
-                    else
-                      errorMsg(" edges/_draw_ unhandled color");
-                  }
-                  else if (nv2.first == "p0") {
-                  }
-                  else if (nv2.first == "p1") {
-                  }
-                  else if (nv2.first == "stops") {
-                  }
-                  else if (nv2.first == "style") {
-                    auto style = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "S") {
-                      if (style != "")
-                        decodeStyle(style, styleData);
-                    }
-                    else
-                      errorMsg(" edges/_draw_ unhandled style");
-                  }
-                  else if (nv2.first == "points") {
-                    auto points = decodePoints(nv2.second->cast<CJson::Array>());
-
-                    if      (op == "P" || op == "p") {
-                      PathData pathData;
-
-                      pathData.bg    = colorData.bg;
-                      pathData.fg    = colorData.fg;
-                      pathData.style = styleData;
-                      pathData.path  = pointsToPath(points);
-
-                      edge->addPath(pathData);
-
-                      edge->setRect(pathData.path.boundingRect());
-
-                      colorData.reset();
-                    }
-                    else if (op == "b" || op == "B") {
-                      PathData bspline;
-
-                      bspline.fg    = colorData.fg;
-                      bspline.style = styleData;
-                      bspline.path  = pointsToBSpline(points);
-
-                      edge->addLine(bspline);
-
-                      edge->setRect(bspline.path.boundingRect());
-
-                      colorData.reset();
-                    }
-                    else if (op == "L") {
-                      PathData bspline;
-
-                      bspline.fg    = colorData.fg;
-                      bspline.style = styleData;
-                      bspline.path  = pointsToBSpline(points);
-
-                      edge->addLine(bspline);
-
-                      edge->setRect(bspline.path.boundingRect());
-
-                      colorData.reset();
-                    }
-                    else
-                      errorMsg(" edges/_draw_ unhandled points for op " + op);
-                  }
-                  else if (nv2.first == "rect") {
-                    auto rect = decodeRect(nv2.second->cast<CJson::Array>());
-
-                    if (op == "E" || op == "e") {
-                      PathData ellipse;
-
-                      ellipse.bg    = colorData.bg;
-                      ellipse.fg    = colorData.fg;
-                      ellipse.style = styleData;
-                      ellipse.path  = rectToEllipse(rect);
-
-                      edge->addPath(ellipse);
-
-                      edge->setRect(rect);
-
-                      colorData.reset();
-                    }
-                    else
-                      errorMsg(" edges/_draw_ unhandled rect");
-                  }
-                  else {
-                    errorMsg(" edges/_draw_ unhandled: " + nv2.first);
-                  }
-                }
-              }
-            }
-            else if (nv1.first == "_hdraw_") {
-              std::string op;
-              ColorData   colorData;
-              StyleData   styleData;
-
-              auto *drawArray1 = nv1.second->cast<CJson::Array>();
-
-              for (const auto &objValue1 : drawArray1->values()) {
-                auto *drawObj1 = objValue1->cast<CJson::Object>();
-
-                for (const auto &nv2 : drawObj1->nameValueArray()) {
-                  //debugMsg("edges/_hdraw_ : " + nv2.first + " " + *nv2.second);
-
-                  if      (nv2.first == "op") {
-                    op = nv2.second->cast<CJson::String>()->value();
-                  }
-                  else if (nv2.first == "grad") {
-                    auto grad = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "c" || op == "C")
-                      colorData.grad = grad;
-                    else
-                      errorMsg(" edges/_hdraw_ unhandled grad");
-                  }
-                  else if (nv2.first == "color") {
-                    auto color = decodeColor(nv2.second->cast<CJson::String>()->value());
-
-                    if      (op == "C")
-                      colorData.bg = color;
-                    else if (op == "c")
-                      colorData.fg = color;
-                    else
-                      errorMsg(" edges/_hdraw_ unhandled color");
-                  }
-                  else if (nv2.first == "p0") {
-                  }
-                  else if (nv2.first == "p1") {
-                  }
-                  else if (nv2.first == "stops") {
-                  }
-                  else if (nv2.first == "style") {
-                    auto style = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "S") {
-                      if (style != "")
-                        decodeStyle(style, styleData);
-                    }
-                    else
-                      errorMsg(" edges/_hdraw_ unhandled style");
-                  }
-                  else if (nv2.first == "points") {
-                    auto points = decodePoints(nv2.second->cast<CJson::Array>());
-
-                    if      (op == "P" || op == "p") {
-                      PathData pathData;
-
-                      pathData.bg    = colorData.bg;
-                      pathData.fg    = colorData.fg;
-                      pathData.style = styleData;
-                      pathData.path  = pointsToPath(points);
-
-                      edge->addPath(pathData);
-
-                      edge->setRect(pathData.path.boundingRect());
-
-                      colorData.reset();
-                    }
-                    else if (op == "b" || op == "B") {
-                      PathData bspline;
-
-                      bspline.fg    = colorData.fg;
-                      bspline.style = styleData;
-                      bspline.path  = pointsToBSpline(points);
-
-                      edge->addLine(bspline);
-
-                      edge->setRect(bspline.path.boundingRect());
-
-                      colorData.reset();
-                    }
-                    else if (op == "L") {
-                      PathData bspline;
-
-                      bspline.fg    = colorData.fg;
-                      bspline.style = styleData;
-                      bspline.path  = pointsToBSpline(points);
-
-                      edge->addLine(bspline);
-
-                      edge->setRect(bspline.path.boundingRect());
-
-                      colorData.reset();
-                    }
-                    else
-                      errorMsg(" edges/_hdraw_ unhandled points for op " + op);
-                  }
-                  else if (nv2.first == "rect") {
-                    auto rect = decodeRect(nv2.second->cast<CJson::Array>());
-
-                    if (op == "E" || op == "e") {
-                      PathData ellipse;
-
-                      ellipse.bg    = colorData.bg;
-                      ellipse.fg    = colorData.fg;
-                      ellipse.style = styleData;
-                      ellipse.path  = rectToEllipse(rect);
-
-                      edge->addPath(ellipse);
-
-                      edge->setRect(rect);
-
-                      colorData.reset();
-                    }
-                    else
-                      errorMsg(" edges/_draw_ unhandled rect");
-                  }
-                  else {
-                    errorMsg(" edges/_hdraw_ unhandled: " + nv2.first);
-                  }
-                }
-              }
-            }
-            else if (nv1.first == "_ldraw_") {
-              std::string op;
-              ColorData   colorData;
-              TextData    textData;
-              StyleData   styleData;
-
-              auto *drawArray1 = nv1.second->cast<CJson::Array>();
-
-              for (const auto &objValue1 : drawArray1->values()) {
-                auto *drawObj1 = objValue1->cast<CJson::Object>();
-
-                for (const auto &nv2 : drawObj1->nameValueArray()) {
-                  //debugMsg("objects/_ldraw_ : " + nv2.first + " " + *nv2.second);
-
-                  if      (nv2.first == "op") {
-                    op = nv2.second->cast<CJson::String>()->value();
-                  }
-                  else if (nv2.first == "grad") {
-                    auto grad = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "c" || op == "C")
-                      colorData.grad = grad;
-                    else
-                      errorMsg(" edges/_ldraw_ unhandled grad");
-                  }
-                  else if (nv2.first == "color") {
-                    auto color = decodeColor(nv2.second->cast<CJson::String>()->value());
-
-                    if      (op == "C")
-                      colorData.bg = color;
-                    else if (op == "c")
-                      colorData.fg = color;
-                    else
-                      errorMsg(" edges/_ldraw_ unhandled color");
-                  }
-                  else if (nv2.first == "p0") {
-                  }
-                  else if (nv2.first == "p1") {
-                  }
-                  else if (nv2.first == "stops") {
-                  }
-                  else if (nv2.first == "style") {
-                    auto style = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "S") {
-                      if (style != "")
-                        decodeStyle(style, styleData);
-                    }
-                    else
-                      errorMsg(" edges/_ldraw_ unhandled style");
-                  }
-                  else if (nv2.first == "size") {
-                    auto size = nv2.second->cast<CJson::Number>()->value();
-
-                    if (op == "F")
-                      textData.size = size;
-                    else
-                      errorMsg(" edges/_ldraw_ unhandled size");
-                  }
-                  else if (nv2.first == "face") {
-                    auto face = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "F")
-                      textData.face = QString::fromStdString(face);
-                  }
-                  else if (nv2.first == "pt") {
-                    auto pt = decodePoint(nv2.second->cast<CJson::Array>());
-
-                    if (op == "t" || op == "T")
-                      textData.pos = pt;
-                    else
-                      errorMsg(" edges/_ldraw_ unhandled pt");
-                  }
-                  else if (nv2.first == "align") {
-                    auto align = decodeAlign(nv2.second->cast<CJson::String>()->value());
-
-                    if (op == "t" || op == "T")
-                      textData.align = align;
-                    else
-                      errorMsg(" edges/_ldraw_ unhandled align");
-                  }
-                  else if (nv2.first == "width") {
-                    auto width = nv2.second->cast<CJson::Number>()->value();
-
-                    if (op == "t" || op == "T")
-                      textData.width = width;
-                    else
-                      errorMsg(" edges/_ldraw_ unhandled width");
-                  }
-                  else if (nv2.first == "text") {
-                    auto text = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "t" || op == "T") {
-                      textData.fg   = colorData.fg;
-                      textData.text = QString::fromStdString(text);
-
-                      edge->addText(textData);
-
-                      colorData.reset();
-                    }
-                    else
-                      errorMsg(" edges/_ldraw_ unhandled text");
-                  }
-                  else if (nv2.first == "points") {
-                    auto points = decodePoints(nv2.second->cast<CJson::Array>());
-
-                    if      (op == "P" || op == "p") {
-                      PathData pathData;
-
-                      pathData.bg    = colorData.bg;
-                      pathData.fg    = colorData.fg;
-                      pathData.style = styleData;
-                      pathData.path  = pointsToPath(points);
-
-                      edge->setRect(pathData.path.boundingRect());
-
-                      edge->addPath(pathData);
-
-                      colorData.reset();
-                    }
-                    else if (op == "b" || op == "B") {
-                      PathData bspline;
-
-                      bspline.fg    = colorData.fg;
-                      bspline.style = styleData;
-                      bspline.path  = pointsToBSpline(points);
-
-                      edge->addLine(bspline);
-
-                      edge->setRect(bspline.path.boundingRect());
-
-                      colorData.reset();
-                    }
-                    else if (op == "L") {
-                      PathData bspline;
-
-                      bspline.fg    = colorData.fg;
-                      bspline.style = styleData;
-                      bspline.path  = pointsToBSpline(points);
-
-                      edge->addLine(bspline);
-
-                      edge->setRect(bspline.path.boundingRect());
-
-                      colorData.reset();
-                    }
-                    else
-                      errorMsg(" edges/_ldraw_ unhandled points for op " + op);
-                  }
-                  else {
-                    errorMsg(" edges/_ldraw_ unhandled: " + nv2.first);
-                  }
-                }
-              }
-            }
-            else if (nv1.first == "_hldraw_") {
-              std::string op;
-              ColorData   colorData;
-              TextData    textData;
-              StyleData   styleData;
-
-              auto *drawArray1 = nv1.second->cast<CJson::Array>();
-
-              for (const auto &objValue1 : drawArray1->values()) {
-                auto *drawObj1 = objValue1->cast<CJson::Object>();
-
-                for (const auto &nv2 : drawObj1->nameValueArray()) {
-                  //debugMsg("objects/_hldraw_ : " + nv2.first + " " + *nv2.second);
-
-                  if      (nv2.first == "op") {
-                    op = nv2.second->cast<CJson::String>()->value();
-                  }
-                  else if (nv2.first == "grad") {
-                    auto grad = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "c" || op == "C")
-                      colorData.grad = grad;
-                    else
-                      errorMsg(" edges/_hldraw_ unhandled grad");
-                  }
-                  else if (nv2.first == "color") {
-                    auto color = decodeColor(nv2.second->cast<CJson::String>()->value());
-
-                    if      (op == "C")
-                      colorData.bg = color;
-                    else if (op == "c")
-                      colorData.fg = color;
-                    else
-                      errorMsg(" edges/_hldraw_ unhandled color");
-                  }
-                  else if (nv2.first == "p0") {
-                  }
-                  else if (nv2.first == "p1") {
-                  }
-                  else if (nv2.first == "stops") {
-                  }
-                  else if (nv2.first == "style") {
-                    auto style = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "S") {
-                      if (style != "")
-                        decodeStyle(style, styleData);
-                    }
-                    else
-                      errorMsg(" edges/_hldraw_ unhandled style");
-                  }
-                  else if (nv2.first == "size") {
-                    auto size = nv2.second->cast<CJson::Number>()->value();
-
-                    if (op == "F")
-                      textData.size = size;
-                    else
-                      errorMsg(" edges/_hldraw_ unhandled size");
-                  }
-                  else if (nv2.first == "face") {
-                    auto face = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "F")
-                      textData.face = QString::fromStdString(face);
-                  }
-                  else if (nv2.first == "pt") {
-                    auto pt = decodePoint(nv2.second->cast<CJson::Array>());
-
-                    if (op == "t" || op == "T")
-                      textData.pos = pt;
-                    else
-                      errorMsg(" edges/_hldraw_ unhandled pt");
-                  }
-                  else if (nv2.first == "align") {
-                    auto align = decodeAlign(nv2.second->cast<CJson::String>()->value());
-
-                    if (op == "t" || op == "T")
-                      textData.align = align;
-                    else
-                      errorMsg(" edges/_hldraw_ unhandled align");
-                  }
-                  else if (nv2.first == "width") {
-                    auto width = nv2.second->cast<CJson::Number>()->value();
-
-                    if (op == "t" || op == "T")
-                      textData.width = width;
-                    else
-                      errorMsg(" edges/_hldraw_ unhandled width");
-                  }
-                  else if (nv2.first == "text") {
-                    auto text = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "t" || op == "T") {
-                      textData.fg   = colorData.fg;
-                      textData.text = QString::fromStdString(text);
-
-                      edge->addText(textData);
-
-                      colorData.reset();
-                    }
-                    else
-                      errorMsg(" edges/_hldraw_ unhandled text");
-                  }
-                  else if (nv2.first == "points") {
-                    auto points = decodePoints(nv2.second->cast<CJson::Array>());
-
-                    if      (op == "P" || op == "p") {
-                      PathData pathData;
-
-                      pathData.bg    = colorData.bg;
-                      pathData.fg    = colorData.fg;
-                      pathData.style = styleData;
-                      pathData.path  = pointsToPath(points);
-
-                      edge->setRect(pathData.path.boundingRect());
-
-                      edge->addPath(pathData);
-
-                      colorData.reset();
-                    }
-                    else if (op == "b" || op == "B") {
-                      PathData bspline;
-
-                      bspline.fg    = colorData.fg;
-                      bspline.style = styleData;
-                      bspline.path  = pointsToBSpline(points);
-
-                      edge->addLine(bspline);
-
-                      edge->setRect(bspline.path.boundingRect());
-
-                      colorData.reset();
-                    }
-                    else if (op == "L") {
-                      PathData bspline;
-
-                      bspline.fg    = colorData.fg;
-                      bspline.style = styleData;
-                      bspline.path  = pointsToBSpline(points);
-
-                      edge->addLine(bspline);
-
-                      edge->setRect(bspline.path.boundingRect());
-
-                      colorData.reset();
-                    }
-                    else
-                      errorMsg(" edges/_hldraw_ unhandled points for op " + op);
-                  }
-                  else {
-                    errorMsg(" edges/_hldraw_ unhandled: " + nv2.first);
-                  }
-                }
-              }
-            }
-            else if (nv1.first == "_tdraw_") {
-              std::string op;
-              ColorData   colorData;
-              TextData    textData;
-              StyleData   styleData;
-
-              auto *drawArray1 = nv1.second->cast<CJson::Array>();
-
-              for (const auto &objValue1 : drawArray1->values()) {
-                auto *drawObj1 = objValue1->cast<CJson::Object>();
-
-                for (const auto &nv2 : drawObj1->nameValueArray()) {
-                  //debugMsg("objects/_tdraw_ : " + nv2.first + " " << *nv2.second);
-
-                  if      (nv2.first == "op") {
-                    op = nv2.second->cast<CJson::String>()->value();
-                  }
-                  else if (nv2.first == "grad") {
-                    auto grad = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "c" || op == "C")
-                      colorData.grad = grad;
-                    else
-                      errorMsg(" edges/_tdraw_ unhandled grad");
-                  }
-                  else if (nv2.first == "color") {
-                    auto color = decodeColor(nv2.second->cast<CJson::String>()->value());
-
-                    if      (op == "C")
-                      colorData.bg = color;
-                    else if (op == "c")
-                      colorData.fg = color;
-                    else
-                      errorMsg(" edges/_tdraw_ unhandled color");
-                  }
-                  else if (nv2.first == "p0") {
-                  }
-                  else if (nv2.first == "p1") {
-                  }
-                  else if (nv2.first == "stops") {
-                  }
-                  else if (nv2.first == "style") {
-                    auto style = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "S") {
-                      if (style != "")
-                        decodeStyle(style, styleData);
-                    }
-                    else
-                      errorMsg(" edges/_tdraw_ unhandled style");
-                  }
-                  else if (nv2.first == "size") {
-                    auto size = nv2.second->cast<CJson::Number>()->value();
-
-                    if (op == "F")
-                      textData.size = size;
-                    else
-                      errorMsg(" edges/_tdraw_ unhandled size");
-                  }
-                  else if (nv2.first == "face") {
-                    auto face = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "F")
-                      textData.face = QString::fromStdString(face);
-                  }
-                  else if (nv2.first == "pt") {
-                    auto pt = decodePoint(nv2.second->cast<CJson::Array>());
-
-                    if (op == "t" || op == "T")
-                      textData.pos = pt;
-                    else
-                      errorMsg(" edges/_tdraw_ unhandled pt");
-                  }
-                  else if (nv2.first == "align") {
-                    auto align = decodeAlign(nv2.second->cast<CJson::String>()->value());
-
-                    if (op == "t" || op == "T")
-                      textData.align = align;
-                    else
-                      errorMsg(" edges/_tdraw_ unhandled align");
-                  }
-                  else if (nv2.first == "width") {
-                    auto width = nv2.second->cast<CJson::Number>()->value();
-
-                    if (op == "t" || op == "T")
-                      textData.width = width;
-                    else
-                      errorMsg(" edges/_tdraw_ unhandled width");
-                  }
-                  else if (nv2.first == "text") {
-                    auto text = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "t" || op == "T") {
-                      textData.fg   = colorData.fg;
-                      textData.text = QString::fromStdString(text);
-
-                      edge->addText(textData);
-
-                      colorData.reset();
-                    }
-                    else
-                      errorMsg(" edges/_tdraw_ unhandled text");
-                  }
-                  else if (nv2.first == "points") {
-                    auto points = decodePoints(nv2.second->cast<CJson::Array>());
-
-                    if      (op == "P" || op == "p") {
-                      PathData pathData;
-
-                      pathData.bg    = colorData.bg;
-                      pathData.fg    = colorData.fg;
-                      pathData.style = styleData;
-                      pathData.path  = pointsToPath(points);
-
-                      edge->setRect(pathData.path.boundingRect());
-
-                      edge->addPath(pathData);
-
-                      colorData.reset();
-                    }
-                    else if (op == "b" || op == "B") {
-                      PathData bspline;
-
-                      bspline.fg    = colorData.fg;
-                      bspline.style = styleData;
-                      bspline.path  = pointsToBSpline(points);
-
-                      edge->addLine(bspline);
-
-                      edge->setRect(bspline.path.boundingRect());
-
-                      colorData.reset();
-                    }
-                    else if (op == "L") {
-                      PathData bspline;
-
-                      bspline.fg    = colorData.fg;
-                      bspline.style = styleData;
-                      bspline.path  = pointsToBSpline(points);
-
-                      edge->addLine(bspline);
-
-                      edge->setRect(bspline.path.boundingRect());
-
-                      colorData.reset();
-                    }
-                    else
-                      errorMsg(" edges/_tdraw_ unhandled points for op " + op);
-                  }
-                  else if (nv2.first == "rect") {
-                    auto rect = decodeRect(nv2.second->cast<CJson::Array>());
-
-                    if (op == "E" || op == "e") {
-                      PathData ellipse;
-
-                      ellipse.bg    = colorData.bg;
-                      ellipse.fg    = colorData.fg;
-                      ellipse.style = styleData;
-                      ellipse.path  = rectToEllipse(rect);
-
-                      edge->addPath(ellipse);
-
-                      edge->setRect(rect);
-
-                      colorData.reset();
-                    }
-                    else
-                      errorMsg(" edges/_tdraw_ unhandled rect");
-                  }
-                  else {
-                    errorMsg(" edges/_tdraw_ unhandled: " + nv2.first);
-                  }
-                }
-              }
-            }
-            else if (nv1.first == "_tldraw_") {
-              std::string op;
-              ColorData   colorData;
-              TextData    textData;
-              StyleData   styleData;
-
-              auto *drawArray1 = nv1.second->cast<CJson::Array>();
-
-              for (const auto &objValue1 : drawArray1->values()) {
-                auto *drawObj1 = objValue1->cast<CJson::Object>();
-
-                for (const auto &nv2 : drawObj1->nameValueArray()) {
-                  //debugMsg("objects/_tldraw_ : " + nv2.first + " " + *nv2.second);
-
-                  if      (nv2.first == "op") {
-                    op = nv2.second->cast<CJson::String>()->value();
-                  }
-                  else if (nv2.first == "grad") {
-                    auto grad = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "c" || op == "C")
-                      colorData.grad = grad;
-                    else
-                      errorMsg(" edges/_tldraw_ unhandled grad");
-                  }
-                  else if (nv2.first == "color") {
-                    auto color = decodeColor(nv2.second->cast<CJson::String>()->value());
-
-                    if      (op == "C")
-                      colorData.bg = color;
-                    else if (op == "c")
-                      colorData.fg = color;
-                    else
-                      errorMsg(" edges/_tldraw_ unhandled color");
-                  }
-                  else if (nv2.first == "p0") {
-                  }
-                  else if (nv2.first == "p1") {
-                  }
-                  else if (nv2.first == "stops") {
-                  }
-                  else if (nv2.first == "style") {
-                    auto style = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "S") {
-                      if (style != "")
-                        decodeStyle(style, styleData);
-                    }
-                    else
-                      errorMsg(" edges/_tldraw_ unhandled style");
-                  }
-                  else if (nv2.first == "size") {
-                    auto size = nv2.second->cast<CJson::Number>()->value();
-
-                    if (op == "F")
-                      textData.size = size;
-                    else
-                      errorMsg(" edges/_tldraw_ unhandled size");
-                  }
-                  else if (nv2.first == "face") {
-                    auto face = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "F")
-                      textData.face = QString::fromStdString(face);
-                  }
-                  else if (nv2.first == "pt") {
-                    auto pt = decodePoint(nv2.second->cast<CJson::Array>());
-
-                    if (op == "t" || op == "T")
-                      textData.pos = pt;
-                    else
-                      errorMsg(" edges/_tldraw_ unhandled pt");
-                  }
-                  else if (nv2.first == "align") {
-                    auto align = decodeAlign(nv2.second->cast<CJson::String>()->value());
-
-                    if (op == "t" || op == "T")
-                      textData.align = align;
-                    else
-                      errorMsg(" edges/_tldraw_ unhandled align");
-                  }
-                  else if (nv2.first == "width") {
-                    auto width = nv2.second->cast<CJson::Number>()->value();
-
-                    if (op == "t" || op == "T")
-                      textData.width = width;
-                    else
-                      errorMsg(" edges/_tldraw_ unhandled width");
-                  }
-                  else if (nv2.first == "text") {
-                    auto text = nv2.second->cast<CJson::String>()->value();
-
-                    if (op == "t" || op == "T") {
-                      textData.fg   = colorData.fg;
-                      textData.text = QString::fromStdString(text);
-
-                      edge->addText(textData);
-
-                      colorData.reset();
-                    }
-                    else
-                      errorMsg(" edges/_tldraw_ unhandled text");
-                  }
-                  else if (nv2.first == "points") {
-                    auto points = decodePoints(nv2.second->cast<CJson::Array>());
-
-                    if      (op == "P" || op == "p") {
-                      PathData pathData;
-
-                      pathData.bg    = colorData.bg;
-                      pathData.fg    = colorData.fg;
-                      pathData.style = styleData;
-                      pathData.path  = pointsToPath(points);
-
-                      edge->setRect(pathData.path.boundingRect());
-
-                      edge->addPath(pathData);
-
-                      colorData.reset();
-                    }
-                    else if (op == "b" || op == "B") {
-                      PathData bspline;
-
-                      bspline.fg    = colorData.fg;
-                      bspline.style = styleData;
-                      bspline.path  = pointsToBSpline(points);
-
-                      edge->addLine(bspline);
-
-                      edge->setRect(bspline.path.boundingRect());
-
-                      colorData.reset();
-                    }
-                    else if (op == "L") {
-                      PathData bspline;
-
-                      bspline.fg    = colorData.fg;
-                      bspline.style = styleData;
-                      bspline.path  = pointsToBSpline(points);
-
-                      edge->addLine(bspline);
-
-                      edge->setRect(bspline.path.boundingRect());
-
-                      colorData.reset();
-                    }
-                    else
-                      errorMsg(" edges/_tldraw_ unhandled points for op " + op);
-                  }
-                  else {
-                    errorMsg(" edges/_tldraw_ unhandled: " + nv2.first);
-                  }
-                }
-              }
-            }
-            else {
-              errorMsg(" edges unhandled: " + nv1.first);
-            }
-          }
+        case 't': {
+          double flags;
+
+          if (! readReal(flags))
+            return false;
+
+          break;
+        }
+        case 'F': {
+          double size;
+
+          std::string_view face;
+
+          if (! readReal(size) || ! readString(face))
+            return false;
+
+          draw_.setOp(op);
+
+          draw_.setFontSize(size);
+          draw_.setFontFace(face);
+
+          break;
+        }
+        case 'C': case 'c': {
+          std::string_view color;
+
+          if (! readString(color))
+            return false;
+
+          draw_.setOp(op);
+
+          // gradients are "[...]" (linear) or "(...)" (radial)
+          if      (! color.empty() && color[0] == '[')
+            draw_.setGrad("linear");
+          else if (! color.empty() && color[0] == '(')
+            draw_.setGrad("radial");
+          else
+            draw_.setColor(color);
+
+          break;
+        }
+        case 'S': {
+          std::string_view style;
+
+          if (! readString(style))
+            return false;
+
+          draw_.setOp(op);
+
+          draw_.setStyle(style);
+
+          break;
+        }
+        case 'I': {
+          double x, y, w, h;
+
+          std::string_view name;
 
-          edges_.push_back(edge);
+          if (! readReal(x) || ! readReal(y) || ! readReal(w) || ! readReal(h) ||
+              ! readString(name))
+            return false;
+
+          break;
         }
+        default:
+          return false;
       }
-      else {
-        errorMsg(" unhandled: " + nv.first);
+    }
+
+    return true;
+  }
+
+ private:
+  //! remove dot escapes (line continuation and quote)
+  void unescape(const std::string &value) {
+    str_.clear();
+
+    size_t n = value.size();
+
+    for (size_t i = 0; i < n; ++i) {
+      char c = value[i];
+
+      if (c == '\\' && i + 1 < n) {
+        char c1 = value[i + 1];
+
+        if      (c1 == '\n') { ++i; continue; }
+        else if (c1 == '\r') { i += (i + 2 < n && value[i + 2] == '\n' ? 2 : 1); continue; }
+        else if (c1 == '"' ) { ++i; c = '"'; }
       }
+
+      str_ += c;
     }
   }
-  else {
-    //debugMsg(*value);
+
+  bool atEnd() const { return pos_ >= str_.size(); }
+
+  void skipSpace() {
+    while (! atEnd() && std::isspace(static_cast<unsigned char>(str_[pos_])))
+      ++pos_;
   }
 
-  return true;
-}
+  bool readReal(double &r) {
+    skipSpace();
+
+    if (atEnd())
+      return false;
+
+    const char *start = str_.c_str() + pos_;
+    char       *end;
+
+    r = strtod(start, &end);
+
+    if (end == start)
+      return false;
+
+    pos_ += size_t(end - start);
+
+    return true;
+  }
+
+  bool readPoints() {
+    double n;
+
+    if (! readReal(n) || n < 0)
+      return false;
+
+    auto np = size_t(n);
+
+    points_.resize(np);
+
+    for (size_t i = 0; i < np; ++i) {
+      double x, y;
+
+      if (! readReal(x) || ! readReal(y))
+        return false;
+
+      points_[i] = QPointF(x, y);
+    }
+
+    return true;
+  }
+
+  //! read "n -str" (n bytes)
+  bool readString(std::string_view &s) {
+    double n;
+
+    if (! readReal(n) || n < 0)
+      return false;
+
+    skipSpace();
+
+    if (atEnd() || str_[pos_] != '-')
+      return false;
+
+    ++pos_;
+
+    auto len = std::min(size_t(n), str_.size() - pos_);
+
+    s = std::string_view(&str_[pos_], len);
+
+    pos_ += len;
+
+    return true;
+  }
+
+ private:
+  DrawBuilder& draw_;
+  std::string  str_;      // unescaped value (reused)
+  size_t       pos_ { 0 };
+  Points       points_;   // reused
+};
+
+//---
 
 bool
 App::
 processDot(const std::string &filename)
 {
+  if (loadSceneCache(filename, SceneCache::Format::DOT))
+    return true;
+
+  bool cacheable = (objects_.empty() && edges_.empty());
+
   CDotParse::Parse parse(filename);
 
   if (! parse.parse()) {
@@ -2048,6 +1402,23 @@ processDot(const std::string &filename)
 
   //---
 
+  // decode xdot draw attributes (if any) into object paths/texts
+  DrawBuilder draw(this);
+  XDotParser  xdot(draw);
+
+  auto addDraw = [&](Object *object, const CDotParse::Attributes &attributes,
+                     const char *name, bool isRoot) {
+    const auto &value = attributes.getStringRef(name);
+    if (value.empty()) return;
+
+    draw.begin(object, name, isRoot);
+
+    if (! xdot.parse(value))
+      errorMsg(std::string("Invalid ") + name + ": " + value);
+  };
+
+  //---
+
   int objId = 0;
 
   for (const auto &ng : parse.graphs()) {
@@ -2078,6 +1449,9 @@ processDot(const std::string &filename)
       setBBox(bbox);
     }
 
+    addDraw(root_.get(), attributes, "_draw_" , true);
+    addDraw(root_.get(), attributes, "_ldraw_", true);
+
     bool ok;
     auto fontSize = attributes.getReal("fontsize", ok); // font size in points
     if (! ok) fontSize = -1;
@@ -2131,7 +1505,10 @@ processDot(const std::string &filename)
 
       object->setRect(QRectF(pos.x() - w/2.0, pos.y() - h/2.0, w, h));
 
-      objects_.push_back(object);
+      addDraw(object.get(), attributes, "_draw_" , false);
+      addDraw(object.get(), attributes, "_ldraw_", false);
+
+      addObject(object);
 
       //std::cerr << "Add Node " << object->name().toStdString() << " (" << object->id() << ")\n";
     };
@@ -2159,45 +1536,56 @@ processDot(const std::string &filename)
     }
   }
 
+  // each edge is stored in its from node's graph
   for (const auto &ng : parse.graphs()) {
     auto graph = ng.second;
 
-    auto subGraphs = graph->subGraphs();
+    for (const auto &edge : graph->edges()) {
+      auto *fromNode = edge->fromNode();
+      auto *toNode   = edge->toNode();
 
-    for (const auto &subGraph : subGraphs) {
-      for (const auto &edge : subGraph->edges()) {
-        auto *fromNode = edge->fromNode();
-        auto *toNode   = edge->toNode();
+      auto *from = findObject(QString::fromStdString(fromNode->name()));
+      auto *to   = findObject(QString::fromStdString(toNode  ->name()));
+
+      if (! from || ! to) {
+        //std::cerr << "No from/to\n";
+        continue;
+      }
 
-        auto *from = findObject(QString::fromStdString(fromNode->name()));
-        auto *to   = findObject(QString::fromStdString(toNode  ->name()));
+      auto edgeObj = std::make_shared<Object>();
 
-        if (! from || ! to) {
-          //std::cerr << "No from/to\n";
-          continue;
-        }
+      edgeObj->setType(Object::Type::EDGE);
 
-        auto edgeObj = std::make_shared<Object>();
+      edgeObj->setId(++objId);
 
-        edgeObj->setType(Object::Type::EDGE);
+      from->addDestEdge(edgeObj.get());
+      to  ->addSrcEdge (edgeObj.get());
 
-        edgeObj->setId(++objId);
+      edgeObj->setHeadId(from->id());
+      edgeObj->setTailId(to  ->id());
 
-        from->addDestEdge(edgeObj.get());
-        to  ->addSrcEdge (edgeObj.get());
+      auto &attributes = edge->attributes();
 
-        edgeObj->setHeadId(from->id());
-        edgeObj->setTailId(to  ->id());
+      addDraw(edgeObj.get(), attributes, "_draw_"  , false);
+      addDraw(edgeObj.get(), attributes, "_ldraw_" , false);
+      addDraw(edgeObj.get(), attributes, "_hdraw_" , false);
+      addDraw(edgeObj.get(), attributes, "_tdraw_" , false);
+      addDraw(edgeObj.get(), attributes, "_hldraw_", false);
+      addDraw(edgeObj.get(), attributes, "_tldraw_", false);
 
-        edges_.push_back(edgeObj);
+      edges_.push_back(edgeObj);
 
-        //std::cerr << "Add Edge (" << edgeObj->id() << ") : " <<
-        //             from->name().toStdString() << " (" << from->id() << ") -> " <<
-        //             to  ->name().toStdString() << " (" << to  ->id() << ")\n";
-      }
+      //std::cerr << "Add Edge (" << edgeObj->id() << ") : " <<
+      //             from->name().toStdString() << " (" << from->id() << ") -> " <<
+      //             to  ->name().toStdString() << " (" << to  ->id() << ")\n";
     }
   }
 
+  buildSpatialIndex();
+
+  if (cacheable)
+    saveSceneCache(filename, SceneCache::Format::DOT);
+
   return true;
 }
 
@@ -2706,7 +2094,7 @@ processDot1(const std::string &filename)
     object->setWidth(w);
     object->setHeight(h);
 
-    objects_.push_back(object);
+    addObject(object);
   }
 
   for (const auto &edge : digraph.edges) {
@@ -2739,26 +2127,115 @@ processDot1(const std::string &filename)
 }
 #endif
 
-Object *
+void
+App::
+addObject(const ObjectP &object)
+{
+  objects_.push_back(object);
+
+  // first object with id/name wins
+  idObjects_.emplace(object->id(), object.get());
+
+  if (! nameObjects_.contains(object->name()))
+    nameObjects_.insert(object->name(), object.get());
+}
+
+void
 App::
-findObject(int id)
+buildSpatialIndex()
 {
-  for (auto &object : objects_)
-    if (object->id() == id)
-      return object.get();
+  spatialIndex_.clear();
+
+  for (const auto &object : objects_)
+    spatialIndex_.add(object.get(), objectDrawRect(object.get()));
+
+  for (const auto &edge : edges_)
+    spatialIndex_.add(edge.get(), objectDrawRect(edge.get()));
 
-  return nullptr;
+  spatialIndex_.build();
+}
+
+bool
+App::
+loadSceneCache(const std::string &filename, SceneCache::Format format)
+{
+  if (cacheDir_ == "" || ! objects_.empty() || ! edges_.empty())
+    return false;
+
+  SceneCache cache(this);
+
+  if (! cache.load(SceneCache::cacheFilename(cacheDir_, filename), filename, format)) {
+    // missing or out of date cache is not an error
+    if (cache.errorMsg() != "")
+      errorMsg(cache.errorMsg());
+
+    return false;
+  }
+
+  return true;
+}
+
+void
+App::
+saveSceneCache(const std::string &filename, SceneCache::Format format)
+{
+  if (cacheDir_ == "")
+    return;
+
+  SceneCache cache(this);
+
+  if (! cache.save(SceneCache::cacheFilename(cacheDir_, filename), filename, format))
+    errorMsg(cache.errorMsg());
+}
+
+QRectF
+App::
+objectRect(const Object *object) const
+{
+  if (! object->rect().isNull())
+    return object->rect();
+
+  // edges without drawn paths use line between end objects
+  if (object->type() == Object::Type::EDGE) {
+    auto *headObj = findObject(object->headId());
+    auto *tailObj = findObject(object->tailId());
+
+    if (headObj && tailObj)
+      return QRectF(headObj->pos(), tailObj->pos()).normalized();
+  }
+
+  return QRectF(object->pos(), object->pos());
+}
+
+QRectF
+App::
+objectDrawRect(const Object *object) const
+{
+  auto rect = objectRect(object);
+
+  // text pos is baseline start/center/end so allow width and size either side
+  // (edge labels are outside edge rect)
+  for (const auto &text : object->texts())
+    rect = rect.united(QRectF(text.pos.x() - text.width, text.pos.y() - text.size,
+                              2*text.width, 2*text.size));
+
+  return rect;
 }
 
 Object *
 App::
-findObject(const QString &name)
+findObject(int id) const
 {
-  for (auto &object : objects_)
-    if (object->name() == name)
-      return object.get();
+  auto p = idObjects_.find(id);
+
+  return (p != idObjects_.end() ? (*p).second : nullptr);
+}
 
-  return nullptr;
+Object *
+App::
+findObject(const QString &name) const
+{
+  return nameObjects_.value(name, nullptr);
 }
 
 void
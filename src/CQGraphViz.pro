@@ -14,9 +14,19 @@ MOC_DIR = .moc
 
 SOURCES += \
 CQGraphViz.cpp \
+CQGraphVizJson.cpp \
+CQGraphVizSpatialIndex.cpp \
+CQGraphVizRenderer.cpp \
+CQGraphVizTileRenderer.cpp \
+CQGraphVizSceneCache.cpp \
 
 HEADERS += \
 ../include/CQGraphViz.h \
+../include/CQGraphVizJson.h \
+../include/CQGraphVizSpatialIndex.h \
+../include/CQGraphVizRenderer.h \
+../include/CQGraphVizTileRenderer.h \
+../include/CQGraphVizSceneCache.h \
 
 OBJECTS_DIR = ../obj
 
@@ -24,7 +34,6 @@ DESTDIR = ../lib
 
 INCLUDEPATH += \
 ../include \
-../../CJson/include \
 ../../CFile/include \
 ../../CStrUtil/include \
 ../graphviz/include \
@@ -0,0 +1,422 @@
+#include <CQGraphVizJson.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace CQGraphViz {
+
+JsonReader::
+JsonReader(size_t bufferSize) :
+ buffer_(bufferSize)
+{
+}
+
+JsonReader::
+~JsonReader()
+{
+  if (fp_)
+    fclose(fp_);
+}
+
+bool
+JsonReader::
+parseFile(const std::string &filename, JsonHandler &handler)
+{
+  errorMsg_.clear();
+
+  fp_ = fopen(filename.c_str(), "rb");
+
+  if (! fp_)
+    return error("Failed to open " + filename);
+
+  pos_     = 0;
+  len_     = 0;
+  lineNum_ = 1;
+  state_   = State::VALUE;
+
+  stack_.clear();
+
+  bool rc = parse(handler);
+
+  fclose(fp_);
+
+  fp_ = nullptr;
+
+  return rc;
+}
+
+bool
+JsonReader::
+parse(JsonHandler &handler)
+{
+  while (true) {
+    int c = skipSpace();
+
+    switch (state_) {
+      case State::VALUE: {
+        if (c == EOF)
+          return error("Unexpected end of file");
+
+        if (! parseValue(c, handler))
+          return false;
+
+        break;
+      }
+      case State::FIRST_VALUE: {
+        if (c == ']') {
+          (void) getChar();
+
+          stack_.pop_back();
+
+          if (! handler.endArray())
+            return false;
+
+          state_ = State::AFTER_VALUE;
+        }
+        else {
+          state_ = State::VALUE;
+        }
+
+        break;
+      }
+      case State::FIRST_KEY: {
+        if (c == '}') {
+          (void) getChar();
+
+          stack_.pop_back();
+
+          if (! handler.endObject())
+            return false;
+
+          state_ = State::AFTER_VALUE;
+        }
+        else {
+          state_ = State::KEY;
+        }
+
+        break;
+      }
+      case State::KEY: {
+        if (c != '"')
+          return error("Expected key string");
+
+        (void) getChar();
+
+        if (! readString())
+          return false;
+
+        if (skipSpace() != ':')
+          return error("Expected ':' after key");
+
+        (void) getChar();
+
+        if (! handler.key(str_))
+          return false;
+
+        state_ = State::VALUE;
+
+        break;
+      }
+      case State::AFTER_VALUE: {
+        if (stack_.empty()) {
+          if (c != EOF)
+            return error("Extra characters after value");
+
+          return true;
+        }
+
+        (void) getChar();
+
+        char container = stack_.back();
+
+        if      (c == ',') {
+          state_ = (container == '{' ? State::KEY : State::VALUE);
+        }
+        else if (c == '}' && container == '{') {
+          stack_.pop_back();
+
+          if (! handler.endObject())
+            return false;
+        }
+        else if (c == ']' && container == '[') {
+          stack_.pop_back();
+
+          if (! handler.endArray())
+            return false;
+        }
+        else
+          return error("Expected ',' or end of container");
+
+        break;
+      }
+    }
+  }
+}
+
+bool
+JsonReader::
+parseValue(int c, JsonHandler &handler)
+{
+  state_ = State::AFTER_VALUE;
+
+  if      (c == '{') {
+    (void) getChar();
+
+    stack_.push_back('{');
+
+    state_ = State::FIRST_KEY;
+
+    return handler.startObject();
+  }
+  else if (c == '[') {
+    (void) getChar();
+
+    stack_.push_back('[');
+
+    state_ = State::FIRST_VALUE;
+
+    return handler.startArray();
+  }
+  else if (c == '"') {
+    (void) getChar();
+
+    if (! readString())
+      return false;
+
+    return handler.stringValue(str_);
+  }
+  else if (c == '-' || (c >= '0' && c <= '9')) {
+    double r;
+
+    if (! readNumber(c, r))
+      return false;
+
+    return handler.numberValue(r);
+  }
+  else if (c == 't') {
+    if (! readLiteral("true"))
+      return false;
+
+    return handler.booleanValue(true);
+  }
+  else if (c == 'f') {
+    if (! readLiteral("false"))
+      return false;
+
+    return handler.booleanValue(false);
+  }
+  else if (c == 'n') {
+    if (! readLiteral("null"))
+      return false;
+
+    return handler.nullValue();
+  }
+  else
+    return error(std::string("Unexpected character '") + char(c) + "'");
+}
+
+bool
+JsonReader::
+readString()
+{
+  // opening quote already read
+  str_.clear();
+
+  while (true) {
+    // copy run of plain characters from buffer
+    if (pos_ >= len_ && ! fill())
+      return error("Unterminated string");
+
+    size_t start = pos_;
+
+    while (pos_ < len_) {
+      char c = buffer_[pos_];
+
+      if (c == '"' || c == '\\' || c == '\n')
+        break;
+
+      ++pos_;
+    }
+
+    str_.append(&buffer_[start], pos_ - start);
+
+    if (pos_ >= len_)
+      continue;
+
+    int c = getChar();
+
+    if      (c == '"') {
+      return true;
+    }
+    else if (c == '\n') {
+      str_ += '\n';
+    }
+    else {
+      int c1 = getChar();
+
+      switch (c1) {
+        case '"' : str_ += '"' ; break;
+        case '\\': str_ += '\\'; break;
+        case '/' : str_ += '/' ; break;
+        case 'b' : str_ += '\b'; break;
+        case 'f' : str_ += '\f'; break;
+        case 'n' : str_ += '\n'; break;
+        case 'r' : str_ += '\r'; break;
+        case 't' : str_ += '\t'; break;
+        case 'u' : {
+          unsigned int code;
+
+          if (! readHex(code))
+            return false;
+
+          // combine surrogate pair
+          if (code >= 0xD800 && code <= 0xDBFF && peekChar() == '\\') {
+            (void) getChar();
+
+            unsigned int code1;
+
+            if (getChar() != 'u' || ! readHex(code1))
+              return error("Invalid surrogate pair");
+
+            if (code1 >= 0xDC00 && code1 <= 0xDFFF)
+              code = 0x10000 + ((code - 0xD800) << 10) + (code1 - 0xDC00);
+            else {
+              addUtf8(code);
+
+              code = code1;
+            }
+          }
+
+          addUtf8(code);
+
+          break;
+        }
+        default:
+          return error("Invalid string escape");
+      }
+    }
+  }
+}
+
+bool
+JsonReader::
+readNumber(int c, double &r)
+{
+  char buffer[64];
+
+  size_t len = 0;
+
+  while (c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E' || (c >= '0' && c <= '9')) {
+    if (len >= sizeof(buffer) - 1)
+      return error("Number too long");
+
+    buffer[len++] = char(getChar());
+
+    c = peekChar();
+  }
+
+  buffer[len] = '\0';
+
+  char *end;
+
+  r = strtod(buffer, &end);
+
+  if (end != buffer + len)
+    return error(std::string("Invalid number '") + buffer + "'");
+
+  return true;
+}
+
+bool
+JsonReader::
+readLiteral(const char *str)
+{
+  for (const char *s = str; *s; ++s) {
+    if (getChar() != *s)
+      return error(std::string("Expected '") + str + "'");
+  }
+
+  return true;
+}
+
+bool
+JsonReader::
+readHex(unsigned int &code)
+{
+  code = 0;
+
+  for (int i = 0; i < 4; ++i) {
+    int c = getChar();
+
+    code <<= 4;
+
+    if      (c >= '0' && c <= '9') code |= unsigned(c - '0');
+    else if (c >= 'a' && c <= 'f') code |= unsigned(c - 'a' + 10);
+    else if (c >= 'A' && c <= 'F') code |= unsigned(c - 'A' + 10);
+    else return error("Invalid unicode escape");
+  }
+
+  return true;
+}
+
+void
+JsonReader::
+addUtf8(unsigned int code)
+{
+  if      (code < 0x80) {
+    str_ += char(code);
+  }
+  else if (code < 0x800) {
+    str_ += char(0xC0 | (code >> 6));
+    str_ += char(0x80 | (code & 0x3F));
+  }
+  else if (code < 0x10000) {
+    str_ += char(0xE0 | (code >> 12));
+    str_ += char(0x80 | ((code >> 6) & 0x3F));
+    str_ += char(0x80 | (code & 0x3F));
+  }
+  else {
+    str_ += char(0xF0 | (code >> 18));
+    str_ += char(0x80 | ((code >> 12) & 0x3F));
+    str_ += char(0x80 | ((code >> 6) & 0x3F));
+    str_ += char(0x80 | (code & 0x3F));
+  }
+}
+
+int
+JsonReader::
+skipSpace()
+{
+  while (true) {
+    int c = peekChar();
+
+    if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+      return c;
+
+    (void) getChar();
+  }
+}
+
+bool
+JsonReader::
+fill()
+{
+  if (! fp_)
+    return false;
+
+  pos_ = 0;
+  len_ = fread(buffer_.data(), 1, buffer_.size(), fp_);
+
+  return (len_ > 0);
+}
+
+bool
+JsonReader::
+error(const std::string &msg)
+{
+  errorMsg_ = msg + " (line " + std::to_string(lineNum_) + ")";
+
+  return false;
+}
+
+}
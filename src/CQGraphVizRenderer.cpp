@@ -0,0 +1,475 @@
+#include <CQGraphVizRenderer.h>
+#include <CQGraphViz.h>
+
+#include <QPainter>
+#include <QFontMetricsF>
+
+#include <algorithm>
+#include <cmath>
+
+namespace CQGraphViz {
+
+FitFontCache::
+FitFontCache(const QFont &font) :
+ font_(font)
+{
+}
+
+QFont
+FitFontCache::
+font() const
+{
+  QMutexLocker locker(&lock_);
+
+  return font_;
+}
+
+void
+FitFontCache::
+setFont(const QFont &f)
+{
+  QMutexLocker locker(&lock_);
+
+  font_ = f;
+}
+
+int
+FitFontCache::
+maxSize() const
+{
+  QMutexLocker locker(&lock_);
+
+  return maxSize_;
+}
+
+void
+FitFontCache::
+setMaxSize(int n)
+{
+  QMutexLocker locker(&lock_);
+
+  maxSize_ = std::max(n, 1);
+
+  while (int(useList_.size()) > maxSize_) {
+    fitFonts_.remove(useList_.back());
+
+    useList_.pop_back();
+  }
+}
+
+int
+FitFontCache::
+size() const
+{
+  QMutexLocker locker(&lock_);
+
+  return fitFonts_.size();
+}
+
+void
+FitFontCache::
+clear()
+{
+  QMutexLocker locker(&lock_);
+
+  fitFonts_.clear();
+  useList_ .clear();
+}
+
+FitFontCache::FitFont
+FitFontCache::
+fitFont(const QSizeF &size, const QString &text)
+{
+  return fitFont(font(), size, text);
+}
+
+FitFontCache::FitFont
+FitFontCache::
+fitFont(const QFont &font, const QSizeF &size, const QString &text)
+{
+  // bucket by whole pixel size
+  auto key = FitFontKey(font, text, qRound(size.width()), qRound(size.height()));
+
+  {
+    QMutexLocker locker(&lock_);
+
+    auto p = fitFonts_.find(key);
+
+    if (p != fitFonts_.end()) {
+      useList_.splice(useList_.begin(), useList_, p.value().use);
+
+      return p.value().fitFont;
+    }
+  }
+
+  //---
+
+  // iterate point size until text fits rect (unlocked, another thread may add same key)
+  auto f = font;
+
+  double w = size.width ();
+  double h = size.height();
+
+  for (int i = 0; i < 8; ++i) {
+    QFontMetricsF fm(f);
+
+    auto tw = fm.horizontalAdvance(text);
+    auto th = fm.height();
+
+    auto s = std::min(w/tw, h/th);
+
+    f.setPointSizeF(s*f.pointSizeF());
+  }
+
+  QFontMetricsF fm(f);
+
+  FitFont fitFont;
+
+  fitFont.font = f;
+  fitFont.dy   = (fm.ascent() - fm.descent())/2.0;
+
+  //---
+
+  QMutexLocker locker(&lock_);
+
+  if (fitFonts_.contains(key))
+    return fitFont;
+
+  useList_.push_front(key);
+
+  FitFontEntry entry;
+
+  entry.fitFont = fitFont;
+  entry.use     = useList_.begin();
+
+  fitFonts_.insert(key, entry);
+
+  // drop least recently used
+  while (int(useList_.size()) > maxSize_) {
+    fitFonts_.remove(useList_.back());
+
+    useList_.pop_back();
+  }
+
+  return fitFont;
+}
+
+//---
+
+Renderer::
+Renderer(const App *app) :
+ app_(app)
+{
+}
+
+void
+Renderer::
+setTransform(const QTransform &t)
+{
+  // fitted fonts are cached by pixel rect size so drop them when scale changes
+  if (t.m11() != transform_.m11() || t.m22() != transform_.m22())
+    fitFonts_.clear();
+
+  transform_ = t;
+
+  scale_ = std::abs(transform_.m11());
+}
+
+void
+Renderer::
+setFont(const QFont &f)
+{
+  fitFonts_.setFont(f);
+
+  font_ = f;
+}
+
+void
+Renderer::
+draw(QPainter *painter, const QRectF &pixelRect)
+{
+  painter->fillRect(windowToPixel(app_->bbox()).normalized(), QBrush(QColor(255, 255, 255)));
+
+  //---
+
+  // only draw objects and edges overlapping pixel rect (index returns objects
+  // then edges in load order)
+  auto visibleRect = transform_.inverted().mapRect(pixelRect).normalized();
+
+  app_->spatialIndex().objectsIn(visibleRect, visibleObjects_);
+
+  const auto *root = app_->root().get();
+
+  drawObject(painter, root);
+
+  for (const auto *object : visibleObjects_)
+    drawObject(painter, object);
+
+  drawObjectText(painter, root);
+
+  for (const auto *object : visibleObjects_)
+    drawObjectText(painter, object);
+}
+
+void
+Renderer::
+drawObject(QPainter *painter, const Object *object)
+{
+  bool isEdge = (object->type() == Object::Type::EDGE);
+  bool inside = (highlight_ && object->isInside());
+
+  if (! object->paths().empty() || ! object->lines().empty()) {
+    // draw tiny node as rect in its (first) color
+    if (! isEdge && object != app_->root().get()) {
+      const auto &rect = object->rect();
+
+      if (std::max(rect.width(), rect.height())*scale_ < minShapePixels_) {
+        auto c = (! object->paths().empty() ? object->paths()[0].fg : object->lines()[0].fg);
+
+        if (inside || c.alpha() == 0)
+          c = (inside ? QColor(Qt::red) : QColor(Qt::black));
+
+        painter->fillRect(windowToPixel(rect).normalized(), c);
+
+        return;
+      }
+    }
+
+    // paths are drawn in window coordinates under the transform so pen widths
+    // are window widths unless cosmetic (pixel)
+    auto saveTransform = painter->transform();
+
+    painter->setTransform(transform_, /*combine*/true);
+
+    for (const auto &path : object->paths()) {
+      if (! inside) {
+        painter->setBrush(path.bg);
+        painter->setPen  (path.fg);
+
+        setWindowLineStyle(painter, path.style);
+      }
+      else {
+        painter->setBrush(Qt::white);
+        painter->setPen  (Qt::red);
+
+        setPixelLineWidth(painter, 4);
+      }
+
+      painter->drawPath(path.path);
+    }
+
+    for (const auto &line : object->lines()) {
+      if (! inside) {
+        painter->setBrush(Qt::NoBrush);
+        painter->setPen  (line.fg);
+
+        setWindowLineStyle(painter, line.style);
+      }
+      else {
+        painter->setBrush(Qt::NoBrush);
+        painter->setPen  (Qt::red);
+
+        setPixelLineWidth(painter, 4);
+      }
+
+      // flatten small curves to line between end points
+      int ne = line.path.elementCount();
+
+      if (ne > 2) {
+        auto lrect = line.path.boundingRect();
+
+        if (std::max(lrect.width(), lrect.height())*scale_ < minCurvePixels_) {
+          painter->drawLine(QPointF(line.path.elementAt(0     )),
+                            QPointF(line.path.elementAt(ne - 1)));
+          continue;
+        }
+      }
+
+      painter->drawPath(line.path);
+    }
+
+    painter->setTransform(saveTransform);
+  }
+  else {
+    if (! isEdge) {
+      auto op = windowToPixel(object->pos());
+
+      double ow = windowToPixelWidth (object->width ());
+      double oh = windowToPixelHeight(object->height());
+
+      auto rect = QRectF(op.x() - ow/2.0, op.y() - oh/2.0, ow, oh);
+
+      painter->setBrush(Qt::white);
+      painter->setPen  (inside ? Qt::red : Qt::black);
+
+      painter->drawRect(rect);
+    }
+    else {
+      auto *fromObj = app_->findObject(object->headId());
+      auto *toObj   = app_->findObject(object->tailId());
+      if (! fromObj || ! toObj) return;
+
+      auto p1 = windowToPixel(fromObj->pos());
+      auto p2 = windowToPixel(toObj  ->pos());
+
+      painter->setPen(inside ? Qt::red : Qt::black);
+
+      painter->drawLine(p1, p2);
+    }
+  }
+}
+
+void
+Renderer::
+drawObjectText(QPainter *painter, const Object *object)
+{
+  bool inside = (highlight_ && object->isInside());
+
+  if (! object->texts().empty()) {
+    for (const auto &text : object->texts()) {
+      // skip unreadable text
+      if (text.size*scale_ < minTextPixels_)
+        continue;
+
+      auto pp = windowToPixel(text.pos);
+
+      double pw = windowToPixelWidth (text.width);
+      double ph = windowToPixelHeight(text.size );
+
+      QRectF rect;
+
+      if      (text.align & Qt::AlignLeft)
+        rect = QRectF(pp.x()         , pp.y() - ph, pw, ph);
+      else if (text.align & Qt::AlignRight)
+        rect = QRectF(pp.x() - pw    , pp.y() - ph, pw, ph);
+      else
+        rect = QRectF(pp.x() - pw/2.0, pp.y() - ph, pw, ph);
+
+      auto fitFont = fitFontToRect(rect.size(), text.text);
+
+      painter->setFont(fitFont.font);
+
+      if (! inside)
+        painter->setPen(text.fg);
+      else
+        painter->setPen(Qt::red);
+
+      double tx = rect.left();
+      double ty = rect.center().y() + fitFont.dy;
+
+      painter->drawText(int(tx), int(ty), text.text);
+    }
+  }
+  else {
+    // skip label if object too small to show it
+    if (object != app_->root().get() &&
+        app_->objectRect(object).height()*scale_ < minTextPixels_)
+      return;
+
+    auto label = object->label();
+
+    if (label == "")
+      label = object->name();
+
+    QFontMetricsF fm(font_);
+
+    auto pp = windowToPixel(object->pos());
+
+    auto tx = pp.x() - fm.horizontalAdvance(label)/2.0;
+    auto ty = pp.y() + (fm.ascent() - fm.descent())/2.0;
+
+    painter->setFont(font_);
+    painter->setPen (inside ? Qt::red : Qt::black);
+
+    painter->drawText(int(tx), int(ty), label);
+  }
+}
+
+FitFontCache::FitFont
+Renderer::
+fitFontToRect(const QSizeF &size, const QString &text)
+{
+  // shared cache is keyed by base font so holds fonts for renderers with other fonts
+  if (sharedFitFonts_)
+    return sharedFitFonts_->fitFont(font_, size, text);
+
+  return fitFonts_.fitFont(size, text);
+}
+
+void
+Renderer::
+setWindowLineStyle(QPainter *painter, const StyleData &style) const
+{
+  auto pen = painter->pen();
+
+  pen.setCosmetic(false);
+  pen.setWidthF(style.lineWidth > 0 ? style.lineWidth : 1);
+
+  if      (style.lineStyle == LineStyle::DOTTED)
+    pen.setStyle(Qt::DotLine);
+  else if (style.lineStyle == LineStyle::DASHED)
+    pen.setStyle(Qt::DashLine);
+
+  painter->setPen(pen);
+}
+
+void
+Renderer::
+setPixelLineWidth(QPainter *painter, double pw) const
+{
+  auto pen = painter->pen();
+
+  pen.setCosmetic(true);
+  pen.setWidthF(pw);
+
+  painter->setPen(pen);
+}
+
+QPointF
+Renderer::
+windowToPixel(const QPointF &p) const
+{
+  return transform_.map(p);
+}
+
+QRectF
+Renderer::
+windowToPixel(const QRectF &r) const
+{
+  return QRectF(transform_.map(r.topLeft()), transform_.map(r.bottomRight()));
+}
+
+double
+Renderer::
+windowToPixelWidth(double w) const
+{
+  return std::abs(w*transform_.m11());
+}
+
+double
+Renderer::
+windowToPixelHeight(double h) const
+{
+  return std::abs(h*transform_.m22());
+}
+
+QTransform
+Renderer::
+fitTransform(const QRectF &rect, const QSizeF &size, double margin)
+{
+  double w = std::max(size.width () - 2*margin, 1.0);
+  double h = std::max(size.height() - 2*margin, 1.0);
+
+  double rw = std::max(rect.width (), 1E-6);
+  double rh = std::max(rect.height(), 1E-6);
+
+  double s = std::min(w/rw, h/rh);
+
+  // flip y (window y is up)
+  double dx = size.width ()/2.0 - s*rect.center().x();
+  double dy = size.height()/2.0 + s*rect.center().y();
+
+  return QTransform(s, 0.0, 0.0, -s, dx, dy);
+}
+
+}
@@ -0,0 +1,762 @@
+#include <CQGraphVizSceneCache.h>
+#include <CQGraphViz.h>
+
+#include <QFile>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
+#include <QCryptographicHash>
+
+#include <vector>
+#include <cstring>
+
+namespace CQGraphViz {
+
+namespace {
+
+// file layout : Header, then sections (8 byte aligned arrays of records).
+// All values are native byte order (byteOrder marker checked on load).
+
+const char     cacheMagic[8] = { 'C', 'Q', 'G', 'V', 'S', 'C', 'N', 'E' };
+const uint32_t cacheVersion  = 1;
+const uint32_t byteOrderMark = 0x01020304;
+
+const uint32_t noIndex = 0xFFFFFFFF;
+
+enum Section {
+  OBJECTS,      // ObjectRecord (root, objects, edges)
+  PATHS,        // PathRecord (all object paths then lines)
+  ELEMENTS,     // ElementRecord (path elements)
+  TEXTS,        // TextRecord
+  ADJACENCY,    // uint32_t edge index (per object src edges then dest edges)
+  STRINGS,      // StringRecord (offset/length into STRING_DATA)
+  STRING_DATA,  // UTF-8 bytes
+  NUM_SECTIONS
+};
+
+struct SectionRecord {
+  uint64_t offset { 0 };
+  uint64_t count  { 0 };
+};
+
+struct Header {
+  char          magic[8];
+  uint32_t      version      { 0 };
+  uint32_t      byteOrder    { 0 };
+  uint64_t      sourceSize   { 0 };
+  int64_t       sourceMTime  { 0 };       // msecs since epoch
+  uint32_t      sourcePath   { noIndex }; // string index
+  uint32_t      sourceFormat { 0 };
+  double        bbox[4]      { 0, 0, 0, 0 };
+  double        fontSize     { -1 };
+  uint32_t      directed     { 0 };
+  uint32_t      numObjects   { 0 };       // objects after root (edges follow)
+  SectionRecord sections[NUM_SECTIONS];
+};
+
+struct ObjectRecord {
+  double   pos[2]       { 0, 0 };
+  double   width        { -1 };
+  double   height       { -1 };
+  double   rect[4]      { 0, 0, 0, 0 };
+  int32_t  id           { -1 };
+  int32_t  headId       { -1 };
+  int32_t  tailId       { -1 };
+  uint32_t type         { 0 };
+  uint32_t name         { noIndex };
+  uint32_t label        { noIndex };
+  uint32_t shape        { noIndex };
+  uint32_t firstPath    { 0 };
+  uint32_t numPaths     { 0 };
+  uint32_t numLines     { 0 };         // lines follow paths
+  uint32_t firstText    { 0 };
+  uint32_t numTexts     { 0 };
+  uint32_t firstAdj     { 0 };
+  uint32_t numSrcEdges  { 0 };
+  uint32_t numDestEdges { 0 };         // dest edges follow src edges
+  uint32_t pad          { 0 };
+};
+
+enum ColorFlags {
+  BG_VALID = (1<<0),
+  FG_VALID = (1<<1),
+  CLOSED   = (1<<2)
+};
+
+struct PathRecord {
+  uint32_t firstElement { 0 };
+  uint32_t numElements  { 0 };
+  uint32_t bg           { 0 };         // QRgb
+  uint32_t fg           { 0 };         // QRgb
+  uint32_t flags        { 0 };
+  int32_t  lineStyle    { 0 };
+  int32_t  lineWidth    { -1 };
+  uint32_t pad          { 0 };
+};
+
+struct ElementRecord {
+  double  x    { 0 };
+  double  y    { 0 };
+  int32_t type { 0 };                  // QPainterPath::ElementType
+  int32_t pad  { 0 };
+};
+
+struct TextRecord {
+  double   size   { 0 };
+  double   pos[2] { 0, 0 };
+  double   width  { 0 };
+  uint32_t face   { noIndex };
+  uint32_t text   { noIndex };
+  uint32_t fg     { 0 };               // QRgb
+  uint32_t flags  { 0 };
+  int32_t  align  { 0 };
+  uint32_t pad    { 0 };
+};
+
+struct StringRecord {
+  uint32_t offset { 0 };
+  uint32_t length { 0 };
+};
+
+//---
+
+// source file key (absolute path, size and modification time)
+struct SourceKey {
+  QString path;
+  int64_t size  { 0 };
+  int64_t mtime { 0 };
+};
+
+bool getSourceKey(const std::string &filename, SourceKey &key)
+{
+  QFileInfo fi(QString::fromStdString(filename));
+
+  if (! fi.exists())
+    return false;
+
+  key.path  = fi.absoluteFilePath();
+  key.size  = fi.size();
+  key.mtime = fi.lastModified().toMSecsSinceEpoch();
+
+  return true;
+}
+
+//---
+
+class Writer {
+ public:
+  Writer() {
+    data_.resize(sizeof(Header));
+  }
+
+  //! file data (with current header)
+  const std::vector<char> &data() {
+    memcpy(data_.data(), &header_, sizeof(Header));
+
+    return data_;
+  }
+
+  Header &header() { return header_; }
+
+  uint32_t addString(const QString &str) {
+    auto p = stringIds_.find(str);
+
+    if (p != stringIds_.end())
+      return p.value();
+
+    auto utf8 = str.toUtf8();
+
+    StringRecord rec;
+
+    rec.offset = uint32_t(stringData_.size());
+    rec.length = uint32_t(utf8.size());
+
+    stringData_.insert(stringData_.end(), utf8.begin(), utf8.end());
+
+    auto id = uint32_t(strings_.size());
+
+    strings_.push_back(rec);
+
+    stringIds_.insert(str, id);
+
+    return id;
+  }
+
+  template<typename T>
+  void addSection(Section section, const std::vector<T> &records) {
+    // align to 8 bytes
+    data_.resize((data_.size() + 7) & ~size_t(7));
+
+    SectionRecord rec;
+
+    rec.offset = data_.size();
+    rec.count  = records.size();
+
+    auto n = records.size()*sizeof(T);
+
+    data_.resize(data_.size() + n);
+
+    if (n)
+      memcpy(data_.data() + rec.offset, records.data(), n);
+
+    header_.sections[section] = rec;
+  }
+
+  void addStrings() {
+    addSection(STRINGS    , strings_);
+    addSection(STRING_DATA, stringData_);
+  }
+
+ private:
+  using StringIds = QHash<QString, uint32_t>;
+
+  Header                    header_;
+  std::vector<char>         data_;
+  std::vector<StringRecord> strings_;
+  std::vector<char>         stringData_;
+  StringIds                 stringIds_;
+};
+
+//---
+
+class Reader {
+ public:
+  Reader(const uchar *data, size_t size) :
+   data_(data), size_(size) {
+  }
+
+  bool readHeader(Header &header) {
+    if (size_ < sizeof(Header))
+      return false;
+
+    memcpy(&header, data_, sizeof(Header));
+
+    if (memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 ||
+        header.version != cacheVersion || header.byteOrder != byteOrderMark)
+      return false;
+
+    // check sections in bounds
+    for (int i = 0; i < NUM_SECTIONS; ++i)
+      sections_[i] = header.sections[i];
+
+    for (int i = 0; i < NUM_SECTIONS; ++i) {
+      const auto &s = sections_[i];
+
+      if (s.offset > size_ || s.offset % 8 != 0)
+        return false;
+    }
+
+    return (checkSection<ObjectRecord >(OBJECTS    ) &&
+            checkSection<PathRecord   >(PATHS      ) &&
+            checkSection<ElementRecord>(ELEMENTS   ) &&
+            checkSection<TextRecord   >(TEXTS      ) &&
+            checkSection<uint32_t     >(ADJACENCY  ) &&
+            checkSection<StringRecord >(STRINGS    ) &&
+            checkSection<char         >(STRING_DATA));
+  }
+
+  uint64_t count(Section section) const { return sections_[section].count; }
+
+  template<typename T>
+  bool record(Section section, uint64_t i, T &rec) const {
+    if (i >= sections_[section].count)
+      return false;
+
+    memcpy(&rec, data_ + sections_[section].offset + i*sizeof(T), sizeof(T));
+
+    return true;
+  }
+
+  bool string(uint32_t id, QString &str) const {
+    if (id == noIndex) {
+      str = QString();
+      return true;
+    }
+
+    StringRecord rec;
+
+    if (! record(STRINGS, id, rec))
+      return false;
+
+    if (uint64_t(rec.offset) + rec.length > sections_[STRING_DATA].count)
+      return false;
+
+    auto *chars = reinterpret_cast<const char *>(data_ + sections_[STRING_DATA].offset);
+
+    str = QString::fromUtf8(chars + rec.offset, int(rec.length));
+
+    return true;
+  }
+
+ private:
+  template<typename T>
+  bool checkSection(Section section) const {
+    const auto &s = sections_[section];
+
+    return (s.count <= (size_ - s.offset)/sizeof(T));
+  }
+
+ private:
+  const uchar*  data_ { nullptr };
+  size_t        size_ { 0 };
+  SectionRecord sections_[NUM_SECTIONS];
+};
+
+//---
+
+uint32_t colorRgb(const QColor &c) {
+  return (c.isValid() ? c.rgba() : 0);
+}
+
+QColor rgbColor(uint32_t rgb, bool valid) {
+  return (valid ? QColor::fromRgba(rgb) : QColor());
+}
+
+}
+
+//---
+
+SceneCache::
+SceneCache(App *app) :
+ app_(app)
+{
+}
+
+std::string
+SceneCache::
+cacheFilename(const std::string &dir, const std::string &filename)
+{
+  auto path = QFileInfo(QString::fromStdString(filename)).absoluteFilePath();
+
+  auto hash = QCryptographicHash::hash(path.toUtf8(), QCryptographicHash::Sha1).toHex();
+
+  auto base = QFileInfo(path).completeBaseName();
+
+  return QDir(QString::fromStdString(dir)).
+           filePath(base + "." + QString(hash.left(16)) + ".cqgvc").toStdString();
+}
+
+bool
+SceneCache::
+load(const std::string &cacheFile, const std::string &filename, Format format)
+{
+  errorMsg_.clear();
+
+  SourceKey key;
+
+  if (! getSourceKey(filename, key))
+    return false;
+
+  QFile file(QString::fromStdString(cacheFile));
+
+  if (! file.open(QIODevice::ReadOnly))
+    return false;
+
+  auto size = size_t(file.size());
+
+  // map file (read all if mapping not supported)
+  QByteArray bytes;
+
+  const uchar *data = file.map(0, file.size());
+
+  if (! data) {
+    bytes = file.readAll();
+
+    data = reinterpret_cast<const uchar *>(bytes.constData());
+    size = size_t(bytes.size());
+  }
+
+  Reader reader(data, size);
+
+  //---
+
+  // check header and source key (stale cache is not an error)
+  Header header;
+
+  if (! reader.readHeader(header))
+    return error("Invalid scene cache '" + cacheFile + "'");
+
+  QString sourcePath;
+
+  if (! reader.string(header.sourcePath, sourcePath))
+    return error("Invalid scene cache '" + cacheFile + "'");
+
+  if (sourcePath != key.path || int64_t(header.sourceSize) != key.size ||
+      header.sourceMTime != key.mtime || header.sourceFormat != uint32_t(format))
+    return false;
+
+  auto numRecords = reader.count(OBJECTS);
+
+  if (numRecords < 1 || header.numObjects > numRecords - 1)
+    return error("Invalid scene cache '" + cacheFile + "'");
+
+  //---
+
+  // create objects (root, objects then edges) with paths and texts (not added to
+  // App until all read)
+  std::vector<ObjectP> objects;
+
+  objects.reserve(numRecords);
+
+  std::vector<ObjectRecord> records(numRecords);
+
+  auto invalid = [&]() {
+    return error("Invalid scene cache '" + cacheFile + "'");
+  };
+
+  auto readPath = [&](uint32_t i, PathData &pathData) {
+    PathRecord rec;
+
+    if (! reader.record(PATHS, i, rec))
+      return false;
+
+    if (uint64_t(rec.firstElement) + rec.numElements > reader.count(ELEMENTS))
+      return false;
+
+    pathData.closed = (rec.flags & CLOSED);
+    pathData.bg     = rgbColor(rec.bg, rec.flags & BG_VALID);
+    pathData.fg     = rgbColor(rec.fg, rec.flags & FG_VALID);
+
+    pathData.style.lineStyle = LineStyle(rec.lineStyle);
+    pathData.style.lineWidth = rec.lineWidth;
+
+    auto &path = pathData.path;
+
+    uint32_t ie = rec.firstElement;
+    uint32_t ne = rec.firstElement + rec.numElements;
+
+    ElementRecord e, e1, e2;
+
+    while (ie < ne) {
+      (void) reader.record(ELEMENTS, ie++, e);
+
+      if      (e.type == QPainterPath::MoveToElement)
+        path.moveTo(e.x, e.y);
+      else if (e.type == QPainterPath::LineToElement)
+        path.lineTo(e.x, e.y);
+      else if (e.type == QPainterPath::CurveToElement) {
+        // curve to (control point 1) followed by curve data (control point 2, end)
+        if (ie + 2 > ne)
+          return false;
+
+        (void) reader.record(ELEMENTS, ie++, e1);
+        (void) reader.record(ELEMENTS, ie++, e2);
+
+        path.cubicTo(e.x, e.y, e1.x, e1.y, e2.x, e2.y);
+      }
+      else
+        return false;
+    }
+
+    return true;
+  };
+
+  for (uint64_t i = 0; i < numRecords; ++i) {
+    auto &rec = records[i];
+
+    (void) reader.record(OBJECTS, i, rec);
+
+    auto object = std::make_shared<Object>();
+
+    object->setType  (Object::Type(rec.type));
+    object->setId    (rec.id);
+    object->setHeadId(rec.headId);
+    object->setTailId(rec.tailId);
+
+    QString name, label, shape;
+
+    if (! reader.string(rec.name, name) || ! reader.string(rec.label, label) ||
+        ! reader.string(rec.shape, shape))
+      return invalid();
+
+    object->setName (name);
+    object->setLabel(label);
+    object->setShape(shape);
+
+    object->setPos   (QPointF(rec.pos[0], rec.pos[1]));
+    object->setWidth (rec.width);
+    object->setHeight(rec.height);
+    object->setRect  (QRectF(rec.rect[0], rec.rect[1], rec.rect[2], rec.rect[3]));
+
+    for (uint32_t j = 0; j < rec.numPaths + rec.numLines; ++j) {
+      PathData pathData;
+
+      if (! readPath(rec.firstPath + j, pathData))
+        return invalid();
+
+      if (j < rec.numPaths)
+        object->addPath(pathData);
+      else
+        object->addLine(pathData);
+    }
+
+    for (uint32_t j = 0; j < rec.numTexts; ++j) {
+      TextRecord trec;
+
+      if (! reader.record(TEXTS, uint64_t(rec.firstText) + j, trec))
+        return invalid();
+
+      TextData textData;
+
+      textData.size  = trec.size;
+      textData.pos   = QPointF(trec.pos[0], trec.pos[1]);
+      textData.align = Qt::Alignment(trec.align);
+      textData.width = trec.width;
+      textData.fg    = rgbColor(trec.fg, trec.flags & FG_VALID);
+
+      if (! reader.string(trec.face, textData.face) || ! reader.string(trec.text, textData.text))
+        return invalid();
+
+      object->addText(textData);
+    }
+
+    objects.push_back(object);
+  }
+
+  //---
+
+  // edge adjacency (edge indices are relative to first edge)
+  auto firstEdge = uint64_t(header.numObjects) + 1;
+
+  for (uint64_t i = 0; i < numRecords; ++i) {
+    const auto &rec = records[i];
+
+    for (uint32_t j = 0; j < rec.numSrcEdges + rec.numDestEdges; ++j) {
+      uint32_t ind;
+
+      if (! reader.record(ADJACENCY, uint64_t(rec.firstAdj) + j, ind) ||
+          firstEdge + ind >= numRecords)
+        return invalid();
+
+      auto *edge = objects[firstEdge + ind].get();
+
+      if (j < rec.numSrcEdges)
+        objects[i]->addSrcEdge(edge);
+      else
+        objects[i]->addDestEdge(edge);
+    }
+  }
+
+  //---
+
+  // only change App when whole cache is read
+  app_->root_ = objects[0];
+
+  app_->setBBox(QRectF(header.bbox[0], header.bbox[1], header.bbox[2], header.bbox[3]));
+
+  app_->setFontSize(header.fontSize);
+
+  app_->directed_ = header.directed;
+
+  for (uint64_t i = 1; i < firstEdge; ++i)
+    app_->addObject(objects[i]);
+
+  for (uint64_t i = firstEdge; i < numRecords; ++i)
+    app_->edges_.push_back(objects[i]);
+
+  app_->buildSpatialIndex();
+
+  return true;
+}
+
+bool
+SceneCache::
+save(const std::string &cacheFile, const std::string &filename, Format format) const
+{
+  errorMsg_.clear();
+
+  SourceKey key;
+
+  if (! getSourceKey(filename, key))
+    return error("No source file '" + filename + "'");
+
+  Writer writer;
+
+  std::vector<ObjectRecord>  objectRecs;
+  std::vector<PathRecord>    pathRecs;
+  std::vector<ElementRecord> elementRecs;
+  std::vector<TextRecord>    textRecs;
+  std::vector<uint32_t>      adjacency;
+
+  // root, objects then edges
+  std::vector<const Object *> objects;
+
+  objects.push_back(app_->root().get());
+
+  for (const auto &object : app_->objects())
+    objects.push_back(object.get());
+
+  for (const auto &edge : app_->edges())
+    objects.push_back(edge.get());
+
+  // edge index lookup for adjacency
+  QHash<const Object *, uint32_t> edgeInd;
+
+  uint32_t ind = 0;
+
+  for (const auto &edge : app_->edges())
+    edgeInd.insert(edge.get(), ind++);
+
+  auto addPath = [&](const PathData &pathData) {
+    PathRecord rec;
+
+    rec.firstElement = uint32_t(elementRecs.size());
+    rec.numElements  = uint32_t(pathData.path.elementCount());
+    rec.bg           = colorRgb(pathData.bg);
+    rec.fg           = colorRgb(pathData.fg);
+    rec.flags        = (pathData.closed       ? CLOSED   : 0) |
+                       (pathData.bg.isValid() ? BG_VALID : 0) |
+                       (pathData.fg.isValid() ? FG_VALID : 0);
+    rec.lineStyle    = int32_t(pathData.style.lineStyle);
+    rec.lineWidth    = pathData.style.lineWidth;
+
+    for (int i = 0; i < pathData.path.elementCount(); ++i) {
+      const auto &e = pathData.path.elementAt(i);
+
+      ElementRecord erec;
+
+      erec.x    = e.x;
+      erec.y    = e.y;
+      erec.type = int32_t(e.type);
+
+      elementRecs.push_back(erec);
+    }
+
+    pathRecs.push_back(rec);
+  };
+
+  for (const auto *object : objects) {
+    ObjectRecord rec;
+
+    rec.pos[0] = object->pos().x();
+    rec.pos[1] = object->pos().y();
+    rec.width  = object->width ();
+    rec.height = object->height();
+
+    const auto &rect = object->rect();
+
+    rec.rect[0] = rect.x     ();
+    rec.rect[1] = rect.y     ();
+    rec.rect[2] = rect.width ();
+    rec.rect[3] = rect.height();
+
+    rec.id     = object->id();
+    rec.headId = object->headId();
+    rec.tailId = object->tailId();
+    rec.type   = uint32_t(object->type());
+
+    rec.name  = writer.addString(object->name ());
+    rec.label = writer.addString(object->label());
+    rec.shape = writer.addString(object->shape());
+
+    rec.firstPath = uint32_t(pathRecs.size());
+    rec.numPaths  = uint32_t(object->paths().size());
+    rec.numLines  = uint32_t(object->lines().size());
+
+    for (const auto &path : object->paths())
+      addPath(path);
+
+    for (const auto &line : object->lines())
+      addPath(line);
+
+    rec.firstText = uint32_t(textRecs.size());
+    rec.numTexts  = uint32_t(object->texts().size());
+
+    for (const auto &text : object->texts()) {
+      TextRecord trec;
+
+      trec.size   = text.size;
+      trec.pos[0] = text.pos.x();
+      trec.pos[1] = text.pos.y();
+      trec.width  = text.width;
+      trec.face   = writer.addString(text.face);
+      trec.text   = writer.addString(text.text);
+      trec.fg     = colorRgb(text.fg);
+      trec.flags  = (text.fg.isValid() ? FG_VALID : 0);
+      trec.align  = int32_t(text.align);
+
+      textRecs.push_back(trec);
+    }
+
+    rec.firstAdj = uint32_t(adjacency.size());
+
+    auto addEdges = [&](const ObjectSet &edges, uint32_t &n) {
+      for (auto *edge : edges) {
+        auto p = edgeInd.find(edge);
+        if (p == edgeInd.end()) continue;
+
+        adjacency.push_back(p.value());
+
+        ++n;
+      }
+    };
+
+    addEdges(object->srcEdges (), rec.numSrcEdges );
+    addEdges(object->destEdges(), rec.numDestEdges);
+
+    objectRecs.push_back(rec);
+  }
+
+  //---
+
+  auto sourcePath = writer.addString(key.path);
+
+  writer.addSection(OBJECTS  , objectRecs );
+  writer.addSection(PATHS    , pathRecs   );
+  writer.addSection(ELEMENTS , elementRecs);
+  writer.addSection(TEXTS    , textRecs   );
+  writer.addSection(ADJACENCY, adjacency  );
+
+  writer.addStrings();
+
+  auto &header = writer.header();
+
+  memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+
+  header.version      = cacheVersion;
+  header.byteOrder    = byteOrderMark;
+  header.sourceSize   = uint64_t(key.size);
+  header.sourceMTime  = key.mtime;
+  header.sourcePath   = sourcePath;
+  header.sourceFormat = uint32_t(format);
+
+  const auto &bbox = app_->bbox();
+
+  header.bbox[0] = bbox.x     ();
+  header.bbox[1] = bbox.y     ();
+  header.bbox[2] = bbox.width ();
+  header.bbox[3] = bbox.height();
+
+  header.fontSize   = app_->fontSize();
+  header.directed   = app_->isDirected();
+  header.numObjects = uint32_t(app_->objects().size());
+
+  //---
+
+  // write to temporary and rename so readers never see partial file
+  QDir().mkpath(QFileInfo(QString::fromStdString(cacheFile)).absolutePath());
+
+  QSaveFile file(QString::fromStdString(cacheFile));
+
+  if (! file.open(QIODevice::WriteOnly))
+    return error("Failed to write scene cache '" + cacheFile + "'");
+
+  const auto &data = writer.data();
+
+  if (file.write(data.data(), qint64(data.size())) != qint64(data.size()) || ! file.commit())
+    return error("Failed to write scene cache '" + cacheFile + "'");
+
+  return true;
+}
+
+bool
+SceneCache::
+error(const std::string &msg) const
+{
+  errorMsg_ = msg;
+
+  return false;
+}
+
+}
@@ -0,0 +1,272 @@
+#include <CQGraphVizSpatialIndex.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace CQGraphViz {
+
+namespace {
+
+// inclusive tests (rects may have zero width/height)
+bool rectContains(const QRectF &r, const QPointF &p)
+{
+  return (p.x() >= r.left() && p.x() <= r.right() && p.y() >= r.top() && p.y() <= r.bottom());
+}
+
+bool rectOverlaps(const QRectF &r1, const QRectF &r2)
+{
+  return (r1.left() <= r2.right() && r2.left() <= r1.right() &&
+          r1.top () <= r2.bottom() && r2.top () <= r1.bottom());
+}
+
+// clamp fractional cell position to [0, n) (before int conversion)
+int clampCell(double f, int n)
+{
+  if (! (f > 0.0)) return 0;
+  if (f >= n     ) return n - 1;
+
+  return int(f);
+}
+
+}
+
+void
+SpatialIndex::
+clear()
+{
+  items_.clear();
+
+  bbox_ = QRectF();
+
+  levels_.clear();
+}
+
+void
+SpatialIndex::
+add(Object *object, const QRectF &rect)
+{
+  Item item;
+
+  item.object = object;
+  item.rect   = rect.normalized();
+
+  items_.push_back(item);
+}
+
+void
+SpatialIndex::
+build()
+{
+  levels_.clear();
+
+  auto n = items_.size();
+
+  if (n == 0)
+    return;
+
+  //---
+
+  // bounding box (QRectF::united ignores zero size rects)
+  double xmin = items_[0].rect.left(), xmax = items_[0].rect.right ();
+  double ymin = items_[0].rect.top (), ymax = items_[0].rect.bottom();
+
+  for (const auto &item : items_) {
+    xmin = std::min(xmin, item.rect.left  ());
+    xmax = std::max(xmax, item.rect.right ());
+    ymin = std::min(ymin, item.rect.top   ());
+    ymax = std::max(ymax, item.rect.bottom());
+  }
+
+  bbox_ = QRectF(xmin, ymin, xmax - xmin, ymax - ymin);
+
+  //---
+
+  // finest level has about one cell per object with cells matching bbox aspect, each
+  // coarser level halves cell counts until single cell
+  double w = std::max(bbox_.width (), 1E-6);
+  double h = std::max(bbox_.height(), 1E-6);
+
+  const int maxCells = 1024;
+
+  int nx = std::clamp(int(std::ceil(std::sqrt(double(n)*w/h))), 1, maxCells);
+  int ny = std::clamp(int(std::ceil(double(n)/nx)), 1, maxCells);
+
+  while (true) {
+    Level level;
+
+    level.nx         = nx;
+    level.ny         = ny;
+    level.cellWidth  = w/nx;
+    level.cellHeight = h/ny;
+
+    levels_.push_back(std::move(level));
+
+    if (nx == 1 && ny == 1)
+      break;
+
+    nx = (nx + 1)/2;
+    ny = (ny + 1)/2;
+  }
+
+  //---
+
+  // level of each item : finest where rect spans at most 2x2 cells
+  int numLevels = int(levels_.size());
+
+  std::vector<uint8_t> itemLevel(n);
+
+  int ix1, iy1, ix2, iy2;
+
+  for (uint32_t i = 0; i < n; ++i) {
+    int l = 0;
+
+    for ( ; l < numLevels - 1; ++l) {
+      (void) cellRange(levels_[l], items_[i].rect, ix1, iy1, ix2, iy2);
+
+      if (ix2 - ix1 < 2 && iy2 - iy1 < 2)
+        break;
+    }
+
+    itemLevel[i] = uint8_t(l);
+  }
+
+  //---
+
+  // per level count items per cell then fill (items added in order so cells are sorted)
+  for (int l = 0; l < numLevels; ++l) {
+    auto &level = levels_[l];
+
+    level.cellOffsets.assign(size_t(level.nx)*level.ny + 1, 0);
+
+    for (uint32_t i = 0; i < n; ++i) {
+      if (itemLevel[i] != l) continue;
+
+      (void) cellRange(level, items_[i].rect, ix1, iy1, ix2, iy2);
+
+      for (int iy = iy1; iy <= iy2; ++iy)
+        for (int ix = ix1; ix <= ix2; ++ix)
+          ++level.cellOffsets[size_t(iy)*level.nx + ix + 1];
+    }
+
+    for (size_t c = 1; c < level.cellOffsets.size(); ++c)
+      level.cellOffsets[c] += level.cellOffsets[c - 1];
+
+    level.cellItems.resize(level.cellOffsets.back());
+
+    Indices pos(level.cellOffsets.begin(), level.cellOffsets.end() - 1);
+
+    for (uint32_t i = 0; i < n; ++i) {
+      if (itemLevel[i] != l) continue;
+
+      (void) cellRange(level, items_[i].rect, ix1, iy1, ix2, iy2);
+
+      for (int iy = iy1; iy <= iy2; ++iy)
+        for (int ix = ix1; ix <= ix2; ++ix)
+          level.cellItems[pos[size_t(iy)*level.nx + ix]++] = i;
+    }
+  }
+}
+
+void
+SpatialIndex::
+objectsAt(const QPointF &p, ObjectArray &objects) const
+{
+  objects.clear();
+
+  if (levels_.empty() || ! rectContains(bbox_, p))
+    return;
+
+  // one cell per level (each item is in one level so no duplicates)
+  Indices inds;
+
+  for (const auto &level : levels_) {
+    auto cell = size_t(cellY(level, p.y()))*level.nx + cellX(level, p.x());
+
+    for (auto i = level.cellOffsets[cell]; i < level.cellOffsets[cell + 1]; ++i) {
+      auto ind = level.cellItems[i];
+
+      if (rectContains(items_[ind].rect, p))
+        inds.push_back(ind);
+    }
+  }
+
+  std::sort(inds.begin(), inds.end());
+
+  objects.reserve(inds.size());
+
+  for (auto ind : inds)
+    objects.push_back(items_[ind].object);
+}
+
+void
+SpatialIndex::
+objectsIn(const QRectF &rect, ObjectArray &objects) const
+{
+  objects.clear();
+
+  if (levels_.empty())
+    return;
+
+  auto rect1 = rect.normalized();
+
+  // items spanning several cells are found more than once so sort and remove
+  // duplicates (no shared query state so queries can run from several threads)
+  Indices inds;
+
+  int ix1, iy1, ix2, iy2;
+
+  for (const auto &level : levels_) {
+    if (! cellRange(level, rect1, ix1, iy1, ix2, iy2))
+      return;
+
+    for (int iy = iy1; iy <= iy2; ++iy) {
+      for (int ix = ix1; ix <= ix2; ++ix) {
+        auto cell = size_t(iy)*level.nx + ix;
+
+        for (auto i = level.cellOffsets[cell]; i < level.cellOffsets[cell + 1]; ++i) {
+          auto ind = level.cellItems[i];
+
+          if (rectOverlaps(items_[ind].rect, rect1))
+            inds.push_back(ind);
+        }
+      }
+    }
+  }
+
+  std::sort(inds.begin(), inds.end());
+
+  inds.erase(std::unique(inds.begin(), inds.end()), inds.end());
+
+  objects.reserve(inds.size());
+
+  for (auto ind : inds)
+    objects.push_back(items_[ind].object);
+}
+
+bool
+SpatialIndex::
+cellRange(const Level &level, const QRectF &rect, int &ix1, int &iy1, int &ix2, int &iy2) const
+{
+  ix1 = cellX(level, rect.left  ());
+  ix2 = cellX(level, rect.right ());
+  iy1 = cellY(level, rect.top   ());
+  iy2 = cellY(level, rect.bottom());
+
+  return rectOverlaps(rect, bbox_);
+}
+
+int
+SpatialIndex::
+cellX(const Level &level, double x) const
+{
+  return clampCell((x - bbox_.left())/level.cellWidth, level.nx);
+}
+
+int
+SpatialIndex::
+cellY(const Level &level, double y) const
+{
+  return clampCell((y - bbox_.top())/level.cellHeight, level.ny);
+}
+
+}
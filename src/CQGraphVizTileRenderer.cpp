@@ -0,0 +1,303 @@
+#include <CQGraphVizTileRenderer.h>
+#include <CQGraphViz.h>
+
+#include <QRunnable>
+#include <QPainter>
+
+#include <cmath>
+
+namespace CQGraphViz {
+
+namespace {
+
+// background color outside scene bbox
+const QColor bgColor(200, 200, 200);
+
+// pixel margin around scene bbox for pen widths and labels
+const double sceneMargin = 16.0;
+
+}
+
+//---
+
+// render one tile into an image and pass it back to the renderer's thread
+class TileRenderer::TileJob : public QRunnable {
+ public:
+  TileJob(TileRenderer *renderer, int generation, const TileKey &key,
+          const QTransform &transform, const QFont &font, int size) :
+   renderer_(renderer), generation_(generation), key_(key),
+   transform_(transform), font_(font), size_(size) {
+  }
+
+  void run() override {
+    QImage image(size_, size_, QImage::Format_ARGB32_Premultiplied);
+
+    image.fill(bgColor);
+
+    QPainter painter(&image);
+
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+
+    // highlight reads object inside state which is changed by the GUI thread
+    Renderer drawer(renderer_->app_);
+
+    drawer.setTransform     (transform_);
+    drawer.setFont          (font_);
+    drawer.setSharedFitFonts(&renderer_->fitFonts_);
+    drawer.setHighlight     (false);
+
+    drawer.draw(&painter, QRectF(0, 0, size_, size_));
+
+    painter.end();
+
+    //---
+
+    auto *renderer   = renderer_;
+    auto  generation = generation_;
+    auto  key        = key_;
+
+    QMetaObject::invokeMethod(renderer, [renderer, generation, key, image]() {
+      renderer->tileDone(generation, key, image);
+    }, Qt::QueuedConnection);
+  }
+
+ private:
+  TileRenderer* renderer_   { nullptr };
+  int           generation_ { 0 };
+  TileKey       key_;
+  QTransform    transform_;
+  QFont         font_;
+  int           size_       { 0 };
+};
+
+//---
+
+TileRenderer::
+TileRenderer(const App *app, QObject *parent) :
+ QObject(parent), app_(app)
+{
+}
+
+TileRenderer::
+~TileRenderer()
+{
+  pool_.clear();
+  pool_.waitForDone();
+}
+
+void
+TileRenderer::
+setTileSize(int i)
+{
+  i = std::max(i, 16);
+
+  if (i == tileSize_)
+    return;
+
+  // tile keys depend on size so previous tiles can't be used as fallback
+  clear();
+
+  tileSize_ = i;
+}
+
+void
+TileRenderer::
+setFont(const QFont &f)
+{
+  if (f == font_)
+    return;
+
+  font_ = f;
+
+  fitFonts_.setFont(f);
+
+  // re-render at same scale (current tiles kept as fallback)
+  if (scaleSet_)
+    setScale(scale_);
+}
+
+void
+TileRenderer::
+clear()
+{
+  pool_.clear();
+  pool_.waitForDone();
+
+  tiles_   .clear();
+  oldTiles_.clear();
+  pending_ .clear();
+
+  scaleSet_ = false;
+
+  ++generation_;
+}
+
+void
+TileRenderer::
+draw(QPainter *painter, const QTransform &transform, const QRect &pixelRect)
+{
+  // split transform into scale (tile grid) and translate (pan)
+  auto scale = QTransform(transform.m11(), transform.m12(), transform.m21(), transform.m22(),
+                          0.0, 0.0);
+
+  if (! scaleSet_ || scale != scale_)
+    setScale(scale);
+
+  double dx = transform.dx();
+  double dy = transform.dy();
+
+  ++used_;
+
+  //---
+
+  painter->fillRect(pixelRect, bgColor);
+
+  // tile range for pixel rect (in scaled pixel coordinates)
+  auto rect = QRectF(pixelRect).translated(-dx, -dy).intersected(sceneRect());
+
+  if (! rect.isValid())
+    return;
+
+  int ix1 = int(std::floor(rect.left  ()/tileSize_));
+  int ix2 = int(std::floor(rect.right ()/tileSize_));
+  int iy1 = int(std::floor(rect.top   ()/tileSize_));
+  int iy2 = int(std::floor(rect.bottom()/tileSize_));
+
+  bool missing = false;
+
+  for (int iy = iy1; iy <= iy2; ++iy) {
+    for (int ix = ix1; ix <= ix2; ++ix) {
+      auto key = TileKey(ix, iy);
+
+      if (! tiles_.contains(key)) {
+        queueTile(key);
+
+        missing = true;
+      }
+    }
+  }
+
+  // draw previous scale tiles (scaled) under missing tiles
+  if (missing && ! oldTiles_.empty()) {
+    painter->save();
+
+    painter->setClipRect(pixelRect);
+
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+
+    painter->setTransform(oldScale_.inverted()*scale_*QTransform::fromTranslate(dx, dy),
+                          /*combine*/true);
+
+    for (auto p = oldTiles_.begin(); p != oldTiles_.end(); ++p)
+      painter->drawImage(QPointF(p.key().ix*tileSize_, p.key().iy*tileSize_), p.value().image);
+
+    painter->restore();
+  }
+
+  // draw current tiles
+  for (int iy = iy1; iy <= iy2; ++iy) {
+    for (int ix = ix1; ix <= ix2; ++ix) {
+      auto p = tiles_.find(TileKey(ix, iy));
+
+      if (p == tiles_.end())
+        continue;
+
+      p.value().used = used_;
+
+      painter->drawImage(QPointF(ix*tileSize_ + dx, iy*tileSize_ + dy), p.value().image);
+    }
+  }
+}
+
+void
+TileRenderer::
+setScale(const QTransform &scale)
+{
+  // running tiles finish but are ignored (generation mismatch), queued ones are dropped
+  pool_.clear();
+
+  ++generation_;
+
+  // keep current tiles as fallback until new ones are rendered
+  if (! tiles_.empty()) {
+    oldTiles_ = tiles_;
+    oldScale_ = scale_;
+  }
+
+  tiles_  .clear();
+  pending_.clear();
+
+  // fitted fonts are keyed by pixel size so still valid but drop to bound size
+  fitFonts_.clear();
+
+  scale_    = scale;
+  scaleSet_ = true;
+}
+
+void
+TileRenderer::
+queueTile(const TileKey &key)
+{
+  if (pending_.find(key) != pending_.end())
+    return;
+
+  pending_.insert(key);
+
+  auto transform = scale_*QTransform::fromTranslate(-key.ix*tileSize_, -key.iy*tileSize_);
+
+  pool_.start(new TileJob(this, generation_, key, transform, font_, tileSize_));
+}
+
+void
+TileRenderer::
+tileDone(int generation, const TileKey &key, const QImage &image)
+{
+  if (generation != generation_)
+    return;
+
+  pending_.erase(key);
+
+  Tile tile;
+
+  tile.image = image;
+  tile.used  = used_;
+
+  tiles_[key] = tile;
+
+  evictTiles();
+
+  // fallback no longer needed when all requested tiles are done
+  if (pending_.empty())
+    oldTiles_.clear();
+
+  emit tilesReady();
+}
+
+void
+TileRenderer::
+evictTiles()
+{
+  // drop least recently drawn tiles
+  while (tiles_.size() > maxTiles_) {
+    auto pmin = tiles_.begin();
+
+    for (auto p = tiles_.begin(); p != tiles_.end(); ++p) {
+      if (p.value().used < pmin.value().used)
+        pmin = p;
+    }
+
+    tiles_.erase(pmin);
+  }
+}
+
+QRectF
+TileRenderer::
+sceneRect() const
+{
+  auto rect = app_->bbox().united(app_->spatialIndex().bbox());
+
+  return scale_.mapRect(rect).adjusted(-sceneMargin, -sceneMargin, sceneMargin, sceneMargin);
+}
+
+}
@@ -2,6 +2,7 @@
 #define CQDisplayRange2D_H
 
 #include <CMathRound.h>
+#include <QTransform>
 #include <cmath>
 
 // Class to represent a 2D mapping from window to pixel coordinates
@@ -249,25 +250,15 @@ class CQDisplayRange2D {
 
     //------
 
-#if 0
-    Matrix matrix1, matrix2, matrix3;
-
-    if (getEqualScale()) {
-      matrix1.setTranslation(pixel_.xmin + pdx_, pixel_.ymin + pdy_);
-      matrix2.setScale      (factor_x1_, factor_y1_);
-      matrix3.setTranslation(-window1_.xmin, -window1_.ymax);
-    }
-    else {
-      matrix1.setTranslation(pixel_.xmin, pixel_.ymin);
-      matrix2.setScale      (factor_x_, factor_y_);
-      matrix3.setTranslation(-window1_.xmin, -window1_.ymax);
-    }
-
-    matrix_ = matrix1*matrix2*matrix3;
-
-    // TODO: check invertable
-    imatrix_ = matrix_.inverse();
-#endif
+    // equivalent affine transform (see windowToPixel)
+    if (getEqualScale())
+      transform_ = QTransform(factor_x1_, 0.0, 0.0, factor_y1_,
+                              pixel_.xmin + pdx_ - window1_.xmin*factor_x1_,
+                              pixel_.ymax + pdy_ - window1_.ymin*factor_y1_);
+    else
+      transform_ = QTransform(factor_x_, 0.0, 0.0, factor_y_,
+                              pixel_.xmin - window1_.xmin*factor_x_,
+                              pixel_.ymax - window1_.ymin*factor_y_);
   }
 
   void windowToPixel(const Point &window, Point &pixel) const {
@@ -371,8 +362,8 @@ class CQDisplayRange2D {
     return (x >= pixel_.xmin && x <= pixel_.xmin && y >= pixel_.ymin && y <= pixel_.ymin);
   }
 
-  //const Matrix &getMatrix () const { return matrix_ ; }
-  //const Matrix &getIMatrix() const { return imatrix_; }
+  //! window to pixel transform (updated by recalc)
+  const QTransform &getTransform() const { return transform_; }
 
  private:
   Range pixel_;
@@ -402,8 +393,7 @@ class CQDisplayRange2D {
   bool flip_x_ { false };
   bool flip_y_ { false };
 
-  //Matrix matrix_;
-  //Matrix imatrix_;
+  QTransform transform_;
 };
 
 #endif
@@ -1,13 +1,14 @@
 #include <CQGraphVizTest.h>
 #include <CQGraphViz.h>
-
-#include <CQPathVisitor.h>
+#include <CQGraphVizRenderer.h>
+#include <CQGraphVizTileRenderer.h>
 
 #include <QApplication>
 #include <QPainter>
 #include <QMouseEvent>
 #include <QToolTip>
 
+#include <algorithm>
 #include <iostream>
 
 int
@@ -24,6 +25,8 @@ main(int argc, char **argv)
   auto format = CQGraphVizTest::Format::JSON;
   auto debug  = false;
 
+  std::string cacheDir;
+
   for (int i = 1; i < argc; ++i) {
     if (argv[i][0] == '-') {
       auto arg = std::string(&argv[i][1]);
@@ -36,6 +39,12 @@ main(int argc, char **argv)
         format = CQGraphVizTest::Format::XDOT;
       else if (arg == "debug")
         debug = true;
+      else if (arg == "cache") {
+        if (i + 1 < argc)
+          cacheDir = argv[++i];
+        else
+          std::cerr << "Missing value for '" << arg << "'\n";
+      }
       else
         std::cerr << "Invalid options '" << arg << "'\n";
     }
@@ -46,6 +55,7 @@ main(int argc, char **argv)
   auto *dot = new CQGraphVizTest;
 
   dot->setDebug(debug);
+  dot->setCacheDir(cacheDir);
 
   for (const auto &file : files)
     dot->processFile(file, format);
@@ -63,6 +73,12 @@ CQGraphVizTest()
   setMouseTracking(true);
 
   dot_ = new CQGraphViz::App;
+
+  renderer_ = new CQGraphViz::Renderer(dot_);
+
+  tiles_ = new CQGraphViz::TileRenderer(dot_, this);
+
+  connect(tiles_, &CQGraphViz::TileRenderer::tilesReady, this, [this]() { update(); });
 }
 
 bool
@@ -79,12 +95,22 @@ setDebug(bool b)
   dot_->setDebug(b);
 }
 
+void
+CQGraphVizTest::
+setCacheDir(const std::string &dir)
+{
+  dot_->setCacheDir(dir);
+}
+
 bool
 CQGraphVizTest::
 processFile(const std::string &filename, Format format)
 {
   setWindowTitle(QString("CQGraphVizTest %1").arg(filename.c_str()));
 
+  // wait for tile renders of current scene
+  tiles_->clear();
+
   if      (format == Format::JSON)
     return dot_->processJson(filename);
   else if (format == Format::DOT || format == Format::XDOT)
@@ -97,16 +123,30 @@ CQGraphViz::Object *
 CQGraphVizTest::
 findObjectAt(const QPointF &p)
 {
-  for (auto &object : dot_->objects())
-    if (object->isInside(p))
-      return object.get();
+  ObjectArray objects;
+
+  objectsAt(p, objects);
 
-  return nullptr;
+  return (! objects.empty() ? objects[0] : nullptr);
 }
 
 void
 CQGraphVizTest::
-paintEvent(QPaintEvent *)
+objectsAt(const QPointF &p, ObjectArray &objects) const
+{
+  // spatial index also contains edges
+  dot_->spatialIndex().objectsAt(p, objects);
+
+  // (index uses draw rect so check shape rect)
+  objects.erase(std::remove_if(objects.begin(), objects.end(),
+    [&](const CQGraphViz::Object *object) {
+      return (object->type() != CQGraphViz::Object::Type::OBJECT || ! object->isInside(p));
+    }), objects.end());
+}
+
+void
+CQGraphVizTest::
+paintEvent(QPaintEvent *e)
 {
   QPainter painter(this);
 
@@ -125,229 +165,36 @@ paintEvent(QPaintEvent *)
 
   //---
 
-  painter.fillRect(rect(), QBrush(QColor(200, 200, 200)));
-
-  //---
-
-  auto bbox = windowToPixel(dot_->bbox());
+  // compose cached tiles (missing tiles are rendered in background and trigger update)
+  tiles_->setFont(font());
 
-  painter.fillRect(bbox, QBrush(QColor(255, 255, 255)));
+  tiles_->draw(&painter, range_.getTransform(), e->rect());
 
   //---
 
-  auto setPixelLineWidth = [&](double pw) {
-    auto pen = painter.pen();
+  // draw objects under mouse (and their edges) highlighted over tiles
+  if (! insideObjects_.empty()) {
+    renderer_->setTransform(range_.getTransform());
+    renderer_->setFont     (font());
 
-    pen.setWidthF(pw);
-
-    painter.setPen(pen);
-  };
-
-  auto setLineDotted = [&]() {
-    auto pen = painter.pen();
-
-    pen.setStyle(Qt::DotLine);
-
-    painter.setPen(pen);
-  };
-
-  auto setLineDashed = [&]() {
-    auto pen = painter.pen();
-
-    pen.setStyle(Qt::DashLine);
-
-    painter.setPen(pen);
-  };
-
-  auto setWindowLineWidth = [&](double lw) {
-    setPixelLineWidth(windowToPixelWidth(lw > 0 ? lw : 1));
-  };
-
-  auto setWindowLineStyle = [&](const CQGraphViz::StyleData &style) {
-    setWindowLineWidth(style.lineWidth);
-
-    if      (style.lineStyle == CQGraphViz::LineStyle::DOTTED)
-      setLineDotted();
-    else if (style.lineStyle == CQGraphViz::LineStyle::DASHED)
-      setLineDashed();
-  };
-
-  auto drawObject = [&](const CQGraphViz::ObjectP &object, bool isEdge) {
-    if (! object->paths().empty() || ! object->lines().empty()) {
-      for (auto &path : object->paths()) {
-        path.closePath();
-
-        auto path1 = windowToPixel(path.path);
-
-        if (! object->isInside()) {
-          painter.setBrush(path.bg);
-          painter.setPen  (path.fg);
-
-          setWindowLineStyle(path.style);
-        }
-        else {
-          painter.setBrush(Qt::white);
-          painter.setPen  (Qt::red);
-
-          setPixelLineWidth(4);
-        }
-
-        painter.drawPath(path1);
-      }
+    ObjectArray highlightObjects;
 
-      for (const auto &line : object->lines()) {
-        auto line1 = windowToPixel(line.path);
+    for (auto *object : insideObjects_) {
+      highlightObjects.push_back(object);
 
-        if (! object->isInside()) {
-          painter.setBrush(Qt::NoBrush);
-          painter.setPen  (line.fg);
-
-          setWindowLineStyle(line.style);
-        }
-        else {
-          painter.setBrush(Qt::NoBrush);
-          painter.setPen  (Qt::red);
-
-          setPixelLineWidth(4);
-        }
-
-        painter.drawPath(line1);
-      }
-    }
-    else {
-      if (! isEdge) {
-        auto op = windowToPixel(object->pos());
-
-        double ow = windowToPixelWidth (object->width ());
-        double oh = windowToPixelHeight(object->height());
-
-        auto rect = QRectF(op.x() - ow/2.0, op.y() - oh/2.0, ow, oh);
-
-        painter.setBrush(Qt::white);
-        painter.setPen  (Qt::black);
-
-        painter.drawRect(rect);
-      }
-      else {
-        auto *fromObj = dot_->findObject(object->headId());
-        auto *toObj   = dot_->findObject(object->tailId());
-        if (! fromObj || ! toObj) return;
-
-        auto p1 = windowToPixel(fromObj->pos());
-        auto p2 = windowToPixel(toObj  ->pos());
-
-        painter.setPen(Qt::black);
-
-        painter.drawLine(p1, p2);
-      }
-    }
-  };
-
-  drawObject(dot_->root(), /*isEdge*/false);
-
-  for (auto &object : dot_->objects())
-    drawObject(object, /*isEdge*/false);
-
-  for (auto &edge : dot_->edges())
-    drawObject(edge, /*isEdge*/true);
-
-  auto scaleFontToRect = [&](const QRectF &r, const QString &text) {
-    auto f = font();
-
-    double w = r.width ();
-    double h = r.height();
-
-    for (int i = 0; i < 8; ++i) {
-      QFontMetricsF fm(f);
-
-      auto tw = fm.width(text);
-      auto th = fm.height();
-
-      auto s = std::min(w/tw, h/th);
-
-      f.setPointSizeF(s*f.pointSizeF());
-    }
-
-    return f;
-  };
-
-  auto drawObjectText = [&](const CQGraphViz::ObjectP &object, bool outlineText=false) {
-    if (! object->texts().empty()) {
-      for (const auto &text : object->texts()) {
-        auto pp = windowToPixel(text.pos);
-
-        double pw = windowToPixelWidth (text.width);
-        double ph = windowToPixelHeight(text.size );
-
-        QRectF rect;
-
-        if      (text.align & Qt::AlignLeft)
-          rect = QRectF(pp.x()         , pp.y() - ph, pw, ph);
-        else if (text.align & Qt::AlignRight)
-          rect = QRectF(pp.x() - pw    , pp.y() - ph, pw, ph);
-        else
-          rect = QRectF(pp.x() - pw/2.0, pp.y() - ph, pw, ph);
-
-        auto f = scaleFontToRect(rect, text.text);
-
-        painter.setFont(f);
-
-        if (! object->isInside())
-          painter.setPen(text.fg);
-        else
-          painter.setPen(Qt::red);
-
-        //painter.drawText(rect, Qt::AlignCenter, text.text);
-
-        QFontMetricsF fm(painter.font());
-
-        double tx = rect.left();
-        double ty = rect.center().y() + (fm.ascent() - fm.descent())/2.0;
-
-        painter.drawText(int(tx), int(ty), text.text);
-
-        //painter.setPen(Qt::red);
-        //painter.setBrush(Qt::NoBrush);
-        //painter.drawRect(rect);
-      }
-    }
-    else {
-      auto label = object->label();
-
-      if (label == "")
-        label = object->name();
-
-      auto pp = windowToPixel(object->pos());
-
-      QFontMetrics fm(font());
-
-      auto tx = pp.x() - fm.horizontalAdvance(label)/2.0;
-      auto ty = pp.y() + (fm.ascent() - fm.descent())/2.0;
-
-      painter.drawText(int(tx), int(ty), label);
-    }
-
-    if (outlineText) {
-      auto op = windowToPixel(object->pos());
-
-      double ow = windowToPixelWidth (object->width ());
-      double oh = windowToPixelHeight(object->height());
-
-      auto rect = QRectF(op.x() - ow/2.0, op.y() - oh/2.0, ow, oh);
+      for (auto *obj : object->srcEdges())
+        highlightObjects.push_back(obj);
 
-      painter.setPen(Qt::red);
-      painter.setBrush(Qt::NoBrush);
-      painter.drawRect(rect);
+      for (auto *obj : object->destEdges())
+        highlightObjects.push_back(obj);
     }
-  };
-
-  drawObjectText(dot_->root());
 
-  for (auto &object : dot_->objects())
-    drawObjectText(object);
+    for (auto *object : highlightObjects)
+      renderer_->drawObject(&painter, object);
 
-  for (auto &edge : dot_->edges())
-    drawObjectText(edge);
+    for (auto *object : highlightObjects)
+      renderer_->drawObjectText(&painter, object);
+  }
 
   //---
 
@@ -382,27 +229,68 @@ mouseMoveEvent(QMouseEvent *e)
 {
   mousePos_ = pixelToWindow(e->pos());
 
-  for (auto &object : dot_->objects()) {
-    object->setInside(object->isInside(mousePos_));
+  QRegion region(mousePosRect());
 
-    for (auto *obj : object->srcEdges())
-      obj->setInside(false);
+  //---
 
-    for (auto *obj : object->destEdges())
-      obj->setInside(false);
-  }
+  // update inside state (object and its edges) only if objects under mouse change
+  ObjectArray insideObjects;
 
-  for (auto &object : dot_->objects()) {
-    if (object->isInside()) {
-      for (auto *obj : object->srcEdges())
-        obj->setInside(true);
+  objectsAt(mousePos_, insideObjects);
 
-      for (auto *obj : object->destEdges())
-        obj->setInside(true);
-    }
+  if (insideObjects != insideObjects_) {
+    auto setInside = [&](CQGraphViz::Object *object, bool inside) {
+      object->setInside(inside);
+
+      region += objectPixelRect(object);
+
+      for (auto *obj : object->srcEdges()) {
+        obj->setInside(inside);
+
+        region += objectPixelRect(obj);
+      }
+
+      for (auto *obj : object->destEdges()) {
+        obj->setInside(inside);
+
+        region += objectPixelRect(obj);
+      }
+    };
+
+    for (auto *object : insideObjects_)
+      setInside(object, false);
+
+    for (auto *object : insideObjects)
+      setInside(object, true);
+
+    insideObjects_ = insideObjects;
   }
 
-  update();
+  update(region);
+}
+
+QRect
+CQGraphVizTest::
+objectPixelRect(const CQGraphViz::Object *object) const
+{
+  auto rect = dot_->objectDrawRect(object);
+
+  // margin for highlight pen
+  int m = 4;
+
+  return windowToPixel(rect).normalized().toAlignedRect().adjusted(-m, -m, m, m);
+}
+
+QRect
+CQGraphVizTest::
+mousePosRect() const
+{
+  QFontMetricsF fm(font());
+
+  double tx = width () - fm.width("XXX.XXX XXX.XXX") - 1;
+  double th = fm.height() + 2;
+
+  return QRect(int(tx) - 1, int(height() - th), int(width() - tx) + 1, int(th));
 }
 
 void
@@ -496,77 +384,6 @@ event(QEvent *e)
   return QWidget::event(e);
 }
 
-QPainterPath
-CQGraphVizTest::
-windowToPixel(const QPainterPath &path) const
-{
-  class PathVisitor : public CQPathVisitor::Base {
-   public:
-    PathVisitor(const CQGraphVizTest *dot) :
-     dot_(dot) {
-    }
-
-    void moveTo(const QPointF &p) override {
-      auto pp = dot_->windowToPixel(p);
-
-      path_.moveTo(pp);
-    }
-
-    void lineTo(const QPointF &p) override {
-      auto pp = dot_->windowToPixel(p);
-
-      path_.lineTo(pp);
-    }
-
-    void quadTo(const QPointF &p1, const QPointF &p2) override {
-      auto pp1 = dot_->windowToPixel(p1);
-      auto pp2 = dot_->windowToPixel(p2);
-
-      path_.quadTo(pp1, pp2);
-    }
-
-    void curveTo(const QPointF &p1, const QPointF &p2, const QPointF &p3) override {
-      auto pp1 = dot_->windowToPixel(p1);
-      auto pp2 = dot_->windowToPixel(p2);
-      auto pp3 = dot_->windowToPixel(p3);
-
-      path_.cubicTo(pp1, pp2, pp3);
-    }
-
-    const QPainterPath &path() const { return path_; }
-
-   private:
-    const CQGraphVizTest* dot_ { nullptr };
-    QPainterPath     path_;
-  };
-
-  PathVisitor visitor(this);
-
-  CQPathVisitor::visitPath(path, visitor);
-
-  return visitor.path();
-}
-
-double
-CQGraphVizTest::
-windowToPixelWidth(double w) const
-{
-  auto p1 = windowToPixel(QPointF(0, 0));
-  auto p2 = windowToPixel(QPointF(w, 0));
-
-  return std::abs(p2.x() - p1.x());
-}
-
-double
-CQGraphVizTest::
-windowToPixelHeight(double h) const
-{
-  auto p1 = windowToPixel(QPointF(0, 0));
-  auto p2 = windowToPixel(QPointF(0, h));
-
-  return std::abs(p2.y() - p1.y());
-}
-
 QRectF
 CQGraphVizTest::
 windowToPixel(const QRectF &r) const
@@ -579,17 +396,6 @@ windowToPixel(const QRectF &r) const
   return QRectF(x1, y1, x2 - x1, y2 - y1);
 }
 
-QPointF
-CQGraphVizTest::
-windowToPixel(const QPointF &p) const
-{
-  double x, y;
-
-  range_.windowToPixel(p.x(), p.y(), &x, &y);
-
-  return QPointF(x, y);
-}
-
 QPointF
 CQGraphVizTest::
 pixelToWindow(const QPointF &p) const
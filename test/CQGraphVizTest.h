@@ -2,11 +2,14 @@
 #define CQGraphVizTest_H
 
 #include <QWidget>
+#include <vector>
 #include <CQDisplayRange2D.h>
 
 namespace CQGraphViz {
 class App;
 class Object;
+class Renderer;
+class TileRenderer;
 }
 
 class CQGraphVizTest : public QWidget {
@@ -25,6 +28,9 @@ class CQGraphVizTest : public QWidget {
   bool isDebug() const;
   void setDebug(bool b);
 
+  //! directory for binary scene cache (empty for none)
+  void setCacheDir(const std::string &dir);
+
  private:
   void resizeEvent(QResizeEvent *) override;
 
@@ -39,20 +45,29 @@ class CQGraphVizTest : public QWidget {
   QSize sizeHint() const override;
 
  private:
-  QPainterPath windowToPixel(const QPainterPath &p) const;
-  QPointF      windowToPixel(const QPointF &p) const;
-  QRectF       windowToPixel(const QRectF &r) const;
-  QPointF      pixelToWindow(const QPointF &p) const;
+  QRectF  windowToPixel(const QRectF &r) const;
+  QPointF pixelToWindow(const QPointF &p) const;
 
-  double windowToPixelWidth (double w) const;
-  double windowToPixelHeight(double h) const;
+  using ObjectArray = std::vector<CQGraphViz::Object *>;
 
   CQGraphViz::Object *findObjectAt(const QPointF &p);
 
+  //! get (non-edge) objects at window point
+  void objectsAt(const QPointF &p, ObjectArray &objects) const;
+
+  //! pixel rect to repaint for object highlight change
+  QRect objectPixelRect(const CQGraphViz::Object *object) const;
+
+  //! pixel rect of mouse position text
+  QRect mousePosRect() const;
+
  private:
-  CQGraphViz::App* dot_ { nullptr };
-  CQDisplayRange2D range_;
-  QPointF          mousePos_;
+  CQGraphViz::App*          dot_      { nullptr };
+  CQGraphViz::Renderer*     renderer_ { nullptr }; // highlight overlay
+  CQGraphViz::TileRenderer* tiles_    { nullptr };
+  CQDisplayRange2D          range_;
+  QPointF                   mousePos_;
+  ObjectArray               insideObjects_;
 };
 
 #endif
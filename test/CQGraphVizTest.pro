@@ -36,11 +36,10 @@ unix:LIBS += \
 -L$$LIB_DIR \
 -L../../CQGraphViz/lib \
 -L../../CQDot/graphviz/lib \
--L../../CJson/lib \
 -L../../CUtil/lib \
 -L../../CFile/lib \
 -L../../CStrUtil/lib \
 -L../../COS/lib \
 \
--lCQGraphViz -lCGraphViz -lCJson \
+-lCQGraphViz -lCGraphViz \
 -lCFile -lCUtil -lCStrUtil -lCOS